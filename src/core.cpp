@@ -40,6 +40,11 @@ core::core()
 
     _metdata= nullptr;
 
+    _concurrent_modules = false;
+
+    _point_output_format = point_output::format::csv;
+    _point_flush_interval = 100;
+
     clean_exit = true;
 
 }
@@ -59,6 +64,8 @@ core::~core()
         itr.first.reset();
     }
 
+    // _mpi_env is destroyed before _mesh, so release the mesh here while MPI is still alive to free its halo requests
+    _mesh.reset();
 }
 
 void core::config_options( pt::ptree &value)
@@ -165,6 +172,12 @@ void core::config_options( pt::ptree &value)
         _notification_script = *notify_sh;
     }
 
+    _concurrent_modules = value.get("concurrent_modules", false);
+    if(_concurrent_modules)
+    {
+        SPDLOG_DEBUG("Independent module chunks will be run concurrently");
+    }
+
     auto radius = value.get_optional<double>("station_search_radius");
     auto N = value.get_optional<double>("station_N_nearest");
 
@@ -371,6 +384,27 @@ void core::config_checkpoint( pt::ptree& value)
             CHM_THROW_EXCEPTION(config_error, "Missing checkpoint options");
         }
 
+        auto format = value.get("format", "per_rank");
+        if (format == "shared")
+        {
+            _checkpoint_opts.shared_file = true;
+
+            int nranks = 1;
+#ifdef USE_MPI
+            nranks = _comm_world.size();
+#endif
+            if (nranks > 1 && !netcdf::has_parallel())
+            {
+                CHM_THROW_EXCEPTION(config_error, "Checkpoint format shared requires netCDF built with parallel "
+                                                  "netCDF-4 support when running with more than one MPI rank");
+            }
+            SPDLOG_DEBUG("Checkpointing to a single file shared by all ranks");
+        }
+        else if (format != "per_rank")
+        {
+            CHM_THROW_EXCEPTION(config_error, "Unknown checkpoint format " + format + ". Expected per_rank or shared");
+        }
+
 
     }
 
@@ -450,10 +484,13 @@ void core::config_checkpoint( pt::ptree& value)
             rank = _comm_world.rank();
         #endif
 
-        if( csz != chkp.get<size_t>("ranks") )
+        // a shared file is keyed by global id so every rank reads from the one file, irrespective of how many ranks wrote it
+        _checkpoint_opts.load_shared_file = chkp.get("format", "per_rank") == "shared";
+        if( !_checkpoint_opts.load_shared_file && csz != chkp.get<size_t>("ranks") )
         {
             CHM_THROW_EXCEPTION(config_error, "Checkpoint file was saved with a different number of ranks");
         }
+        size_t file_idx = _checkpoint_opts.load_shared_file ? 0 : rank;
 
         boost::filesystem::path ckpt_nc_path;
         try
@@ -462,7 +499,7 @@ void core::config_checkpoint( pt::ptree& value)
 
             for(auto &itr : chkp.get_child("files"))
             {
-                if( i == rank)
+                if( i == file_idx)
                 {
                     ckpt_nc_path = itr.second.data();
                     break;
@@ -478,7 +515,11 @@ void core::config_checkpoint( pt::ptree& value)
 
         ckpt_nc_path =  ckpt_path.parent_path() / ckpt_nc_path;
         SPDLOG_DEBUG("Rank {} using checkpoint restore file {}", rank, ckpt_nc_path.string());
-        _checkpoint_opts.in_savestate.open(ckpt_nc_path.string());
+
+        if (_checkpoint_opts.load_shared_file)
+            _checkpoint_opts.in_savestate.open_shared(ckpt_nc_path.string());
+        else
+            _checkpoint_opts.in_savestate.open(ckpt_nc_path.string());
     }
 
 
@@ -486,11 +527,33 @@ void core::config_checkpoint( pt::ptree& value)
 
 
 }
+
+size_t core::_checkpoint_offset()
+{
+    auto& ids = _mesh->get_global_IDs();
+    if (ids.empty())
+        return 0;
+
+    // the local faces must be one block of global ids for this rank to read and write a single hyperslab
+    if (static_cast<size_t>(ids.back() - ids.front() + 1) != ids.size() ||
+        !std::is_sorted(ids.begin(), ids.end()))
+    {
+        CHM_THROW_EXCEPTION(chm_error, "Local faces are not a contiguous range of global ids, cannot use a shared checkpoint");
+    }
+
+    return ids.front();
+}
+
 void core::config_forcing(pt::ptree &value)
 {
     SPDLOG_DEBUG("Found forcing section");
     SPDLOG_DEBUG("Reading meta data from config");
 
+    // Options that can appear in the forcing section alongside the ascii stations. Any other key is taken to be a
+    // station, so a new option must be added here as well as parsed below
+    static const std::set<std::string> forcing_options = {"UTC_offset", "use_netcdf", "prefetch_depth",
+                                                          "ascii_cache", "ascii_spill_directory"};
+
     //positive offset going west. So the normal UTC-6 would be UTC_offset:6
     _global->_utc_offset = value.get("UTC_offset",0);
     SPDLOG_DEBUG("Applying UTC offset to ALL forcing files. UTC+{}", std::to_string(_global->_utc_offset));
@@ -500,6 +563,27 @@ void core::config_forcing(pt::ptree &value)
     //need to determine if we have been given a netcdf file
     _use_netcdf = value.get("use_netcdf",false);
 
+    // number of NetCDF timesteps to read ahead on a background thread while the modules run. 0 reads synchronously
+    auto prefetch_depth = value.get_optional<size_t>("prefetch_depth");
+    if(prefetch_depth)
+    {
+        _metdata->set_prefetch_depth(*prefetch_depth);
+        SPDLOG_DEBUG("Forcing prefetch depth set to {}", *prefetch_depth);
+    }
+
+    // reuse a binary cache of each ascii forcing file (<file>.chmcache) as long as the file is unchanged
+    bool ascii_cache = value.get("ascii_cache", true);
+    _metdata->set_ascii_cache(ascii_cache);
+    SPDLOG_DEBUG("ASCII forcing cache is {}", ascii_cache ? "enabled" : "disabled");
+
+    // where ascii forcing too large to keep in memory is spilled to a memory mapped file
+    auto ascii_spill_directory = value.get_optional<std::string>("ascii_spill_directory");
+    if(ascii_spill_directory)
+    {
+        _metdata->set_ascii_spill_directory(*ascii_spill_directory);
+        SPDLOG_DEBUG("ASCII forcing spill directory set to {}", *ascii_spill_directory);
+    }
+
 
     timer c;
     c.tic();
@@ -537,7 +621,7 @@ void core::config_forcing(pt::ptree &value)
 
         for (auto &itr : value)
         {
-            if(itr.first != "UTC_offset")
+            if(forcing_options.find(itr.first) == forcing_options.end())
             {
                 metdata::ascii_metdata data;
 
@@ -922,11 +1006,28 @@ void core::config_output(pt::ptree &value)
 
     _find_and_insert_subjson(value);
 
+    // number of mesh outputs that may be queued for the output writer thread. 0 writes synchronously
+    _output_writer.set_depth(value.get<size_t>("async_depth", 2));
+    SPDLOG_DEBUG("Output writer queue depth set to {}", _output_writer.depth());
+
+    // timeseries outputs are streamed to disk every point_flush_interval timesteps
+    auto point_format = value.get<std::string>("point_format", "csv");
+    if (point_format == "csv")
+        _point_output_format = point_output::format::csv;
+    else if (point_format == "netcdf")
+        _point_output_format = point_output::format::netcdf;
+    else
+        CHM_THROW_EXCEPTION(config_error, "Unknown point_format " + point_format);
+
+    _point_flush_interval = value.get<size_t>("point_flush_interval", 100);
+    _point_output_path = pts_path;
+
     for (auto &itr : value)
     {
         output_info out;
         std::string out_type = itr.first.data();
-        if (out_type == "output_dir") //skip this
+        if (out_type == "output_dir" || out_type == "async_depth" ||
+            out_type == "point_format" || out_type == "point_flush_interval") //skip these
         {
             continue;
         }
@@ -936,6 +1037,7 @@ void core::config_output(pt::ptree &value)
             out.type = output_info::time_series;
             out.name = out_type;
 
+            // all the points go in one file with netcdf output
             std::string fname = "";
             try
             {
@@ -943,7 +1045,8 @@ void core::config_output(pt::ptree &value)
             }
             catch(const pt::ptree_error &e)
             {
-                CHM_THROW_EXCEPTION(forcing_error,"Missing output filename for " + out.name);
+                if (_point_output_format == point_output::format::csv)
+                    CHM_THROW_EXCEPTION(forcing_error,"Missing output filename for " + out.name);
             }
             auto f = pts_path / fname;
             out.fname = f.string();
@@ -1027,7 +1130,8 @@ void core::config_output(pt::ptree &value)
             boost::filesystem::create_directories(f.parent_path());
             out.fname = f.string();
 
-            _mesh->write_param_to_vtu( itr.second.get("write_parameters",true) ) ;
+            out.write_parameters = itr.second.get("write_parameters",true);
+            _mesh->write_param_to_vtu( out.write_parameters ) ;
 
 	    // Set option for writing ghost neighbor data, defaults to not
             _mesh->write_ghost_neighbors_to_vtu( itr.second.get("write_ghost_neighbors",false) ) ;
@@ -1055,7 +1159,33 @@ void core::config_output(pt::ptree &value)
                 SPDLOG_WARN("Only only_last_n output option will be used");
             }
 
-            out.mesh_output_formats.push_back(output_info::mesh_outputs::vtu);
+            // format is either a single format or a list of formats, defaults to vtu
+            std::vector<std::string> formats;
+            auto fmt = itr.second.get_child_optional("format");
+            if (fmt)
+            {
+                if (fmt->empty())
+                    formats.push_back(fmt->data());
+
+                for (auto &jtr : *fmt)
+                    formats.push_back(jtr.second.data());
+            }
+            else
+            {
+                formats.push_back("vtu");
+            }
+
+            for (auto &f : formats)
+            {
+                if (f == "vtu")
+                    out.mesh_output_formats.push_back(output_info::mesh_outputs::vtu);
+                else if (f == "h5")
+                    out.mesh_output_formats.push_back(output_info::mesh_outputs::h5);
+                else
+                    CHM_THROW_EXCEPTION(config_error, "Unknown mesh output format " + f);
+            }
+
+            out.compression = itr.second.get("compression", 4);
 
         } else
         {
@@ -1564,15 +1694,29 @@ void core::init(int argc, char **argv)
 
 
     //setup output timeseries sinks
-
+    std::vector<point_output::point> points;
     for (auto &itr : _outputs)
     {
         if (itr.type == output_info::output_type::time_series)
         {
-            itr.ts.init(_provided_var_module, _metdata->start_time(), _metdata->end_time(), _metdata->dt());
+            points.push_back({itr.name, itr.fname, itr.longitude, itr.latitude});
         }
     }
 
+    if (!points.empty())
+    {
+        size_t rank = 0;
+#ifdef USE_MPI
+        rank = _comm_world.rank();
+#endif
+        auto nc_file = _point_output_path / ("points_" + std::to_string(rank) + ".nc");
+
+        _point_output = std::make_unique<point_output>(_point_output_format, points,
+                                                       std::vector<std::string>(_provided_var_module.begin(),
+                                                                                _provided_var_module.end()),
+                                                       nc_file.string(), _point_flush_interval);
+    }
+
     if(point_mode.enable)
     {
         for(auto itr:_chunked_modules)
@@ -1618,6 +1762,13 @@ void core::init(int argc, char **argv)
 
     _mesh->init_face_data(_provided_var_module, _provided_var_vector, module_list);
 
+    // resolve the timeseries output variables once so that each timestep is a direct column access
+    if (_point_output)
+    {
+        for (auto& v : _point_output->variables())
+            _point_output_handles.push_back(_mesh->handle(v));
+    }
+
     timer c;
     SPDLOG_DEBUG("Running init() for each module");
     c.tic();
@@ -1643,6 +1794,44 @@ void core::init(int argc, char **argv)
         _global->_from_checkpoint = true;
         SPDLOG_DEBUG("Loading from checkpoint");
         c.tic();
+
+        if (_checkpoint_opts.load_shared_file)
+        {
+            auto& in = _checkpoint_opts.in_savestate;
+            in.set_offset1D(_checkpoint_offset());
+
+            // Faces are located by their global id. The global ids come from the mesh permutation, which differs
+            // between meshes permuted or partitioned for a different number of ranks, so check the stored centroids
+            // to confirm each row is the same triangle rather than comparing the global ids against themselves
+            std::vector<double> saved_x(_mesh->size_faces());
+            std::vector<double> saved_y(_mesh->size_faces());
+            in.get_var1D("face_x", saved_x);
+            in.get_var1D("face_y", saved_y);
+
+            size_t mismatch = 0;
+            #pragma omp parallel for reduction(+:mismatch)
+            for (size_t i = 0; i < _mesh->size_faces(); i++)
+            {
+                auto face = _mesh->face(i);
+                double x = face->get_x();
+                double y = face->get_y();
+                if (std::fabs(saved_x[i] - x) > 1e-6 * std::max(1.0, std::fabs(x)) ||
+                    std::fabs(saved_y[i] - y) > 1e-6 * std::max(1.0, std::fabs(y)))
+                    mismatch++;
+            }
+
+#ifdef USE_MPI
+            mismatch = boost::mpi::all_reduce(_comm_world, mismatch, std::plus<size_t>());
+#endif
+            if (mismatch > 0)
+            {
+                CHM_THROW_EXCEPTION(config_error, "Shared checkpoint does not match the mesh: " + std::to_string(mismatch) +
+                                                  " triangles are at a different global_id. A shared checkpoint must be "
+                                                  "loaded with the same mesh file, or a partition of it with the same "
+                                                  "face permutation, as it was written from.");
+            }
+        }
+
         for (auto &itr : _chunked_modules)
         {
             //module calls
@@ -1723,7 +1912,9 @@ void core::_determine_module_dep()
                    m1->conflicts()->end(),
                    m2->ID) != m1->conflicts()->end())
            {
-               CHM_THROW_EXCEPTION(module_error,  "Module " + m1->ID + " explicitly conflicts with " + m2->ID);
+               auto reason = m1->conflict_reason(m2->ID);
+               CHM_THROW_EXCEPTION(module_error,  "Module " + m1->ID + " explicitly conflicts with " + m2->ID +
+                                                  (reason.empty() ? "" : ". " + reason));
            }
 
 
@@ -2012,6 +2203,32 @@ void core::_determine_module_dep()
     std::string s = ss.str();
     SPDLOG_DEBUG("Build order: {}",s.substr(0, s.length() - 2));
 
+    // keep the predecessors of each module so that _schedule_modules can determine which modules are independent
+    _module_predecessors.assign(size, std::set<size_t>());
+    Graph::edge_iterator ei, ei_end;
+    for (boost::tie(ei, ei_end) = boost::edges(g); ei != ei_end; ++ei)
+    {
+        _module_predecessors.at(boost::target(*ei, g)).insert(boost::source(*ei, g));
+    }
+
+    // an override removes an edge to break a cycle, but the pair of modules still share variables.
+    // Keep them ordered as per the build order so they are never run concurrently
+    for (auto& o : _overrides)
+    {
+        auto a = std::find_if(_modules.begin(), _modules.end(),
+                              [&](const std::pair<module, size_t>& m){ return m.first->ID == o.first; });
+        auto b = std::find_if(_modules.begin(), _modules.end(),
+                              [&](const std::pair<module, size_t>& m){ return m.first->ID == o.second; });
+
+        if (a == _modules.end() || b == _modules.end())
+            continue;
+
+        if (a->second < b->second)
+            _module_predecessors.at(b->first->IDnum).insert(a->first->IDnum);
+        else
+            _module_predecessors.at(a->first->IDnum).insert(b->first->IDnum);
+    }
+
 
     //sort ascending based on make order number
     std::sort(_modules.begin(), _modules.end(),
@@ -2058,36 +2275,118 @@ void core::_determine_module_dep()
 
 void core::_schedule_modules()
 {
-    //organize modules into sorted parallel data/domain chunks
-    size_t chunks = 1; //will be 1 behind actual number as we are using this for an index
-    size_t chunk_itr = 0;
-    for (auto &itr : _modules)
+    _chunked_modules.clear();
+    _chunk_stage.clear();
+
+#ifdef USE_MPI
+    // modules exchange ghost halos inside run(), which must be called in the same order on every rank. With a single
+    // rank the modules that exchange halos are barriers, so they are still never run concurrently
+    if (_concurrent_modules && _comm_world.size() > 1)
     {
-        SPDLOG_DEBUG( "Chunking module: {}", itr.first->ID);
-        //first case, empty list
-        if (_chunked_modules.size() == 0)
-        {
-            _chunked_modules.resize(chunks);
-            _chunked_modules.at(0).push_back(itr.first);
-        } else
+        SPDLOG_WARN("concurrent_modules is not supported with more than one MPI rank. Running module chunks sequentially");
+        _concurrent_modules = false;
+    }
+#endif
+
+    if (!_concurrent_modules)
+    {
+        //organize modules into sorted parallel data/domain chunks
+        size_t chunks = 1; //will be 1 behind actual number as we are using this for an index
+        size_t chunk_itr = 0;
+        for (auto &itr : _modules)
         {
-            if (_chunked_modules.at(chunk_itr).at(0)->parallel_type() == itr.first->parallel_type())
+            SPDLOG_DEBUG( "Chunking module: {}", itr.first->ID);
+            //first case, empty list
+            if (_chunked_modules.size() == 0)
             {
-                _chunked_modules.at(chunk_itr).push_back(itr.first);
+                _chunked_modules.resize(chunks);
+                _chunked_modules.at(0).push_back(itr.first);
             } else
             {
-                chunk_itr++;
-                chunks++;
-                _chunked_modules.resize(chunks);
-                _chunked_modules.at(chunk_itr).push_back(itr.first);
+                if (_chunked_modules.at(chunk_itr).at(0)->parallel_type() == itr.first->parallel_type())
+                {
+                    _chunked_modules.at(chunk_itr).push_back(itr.first);
+                } else
+                {
+                    chunk_itr++;
+                    chunks++;
+                    _chunked_modules.resize(chunks);
+                    _chunked_modules.at(chunk_itr).push_back(itr.first);
+                }
+            }
+        }
+
+        // every chunk is its own stage
+        for (size_t i = 0; i < _chunked_modules.size(); i++)
+            _chunk_stage.push_back(i);
+    }
+    else
+    {
+        // Assign each module to the earliest stage its dependencies allow. A data parallel module can share a stage with
+        // a data parallel predecessor as they are fused into the same face loop, run in build order. Anything else
+        // needs its predecessor to be complete over the entire mesh, so it goes in a later stage.
+        std::vector<bool> is_data(_module_predecessors.size(), false);
+        for (auto &itr : _modules)
+            is_data.at(itr.first->IDnum) = itr.first->parallel_type() == module_base::parallel::data;
+
+        // A barrier module changes mesh-wide state, so it goes after every stage so far and nothing that follows it
+        // in the build order may share or precede its stage.
+        std::vector<size_t> stage(_module_predecessors.size(), 0);
+        size_t nstages = 0;
+        size_t first_stage = 0; // earliest stage available after the last barrier
+        for (auto &itr : _modules) // in build order, so all predecessors have been staged
+        {
+            size_t m = itr.first->IDnum;
+            size_t s = first_stage;
+            for (auto p : _module_predecessors.at(m))
+            {
+                s = std::max(s, stage.at(p) + ((is_data.at(m) && is_data.at(p)) ? 0 : 1));
+            }
+
+            if (itr.first->is_barrier())
+            {
+                s = std::max(s, nstages);
+                first_stage = s + 1;
+            }
+
+            stage.at(m) = s;
+            nstages = std::max(nstages, s + 1);
+        }
+
+        // Each stage is one fused data parallel chunk plus one chunk per domain parallel module
+        for (size_t s = 0; s < nstages; s++)
+        {
+            std::vector<module> data;
+            std::vector<module> domain;
+            for (auto &itr : _modules)
+            {
+                if (stage.at(itr.first->IDnum) != s)
+                    continue;
+
+                if (is_data.at(itr.first->IDnum))
+                    data.push_back(itr.first);
+                else
+                    domain.push_back(itr.first);
+            }
+
+            if (!data.empty())
+            {
+                _chunked_modules.push_back(data);
+                _chunk_stage.push_back(s);
+            }
+
+            for (auto &itr : domain)
+            {
+                _chunked_modules.push_back({itr});
+                _chunk_stage.push_back(s);
             }
         }
     }
 
-    chunks = 0;
+    size_t chunks = 0;
     for (auto &itr : _chunked_modules)
     {
-        SPDLOG_DEBUG("Chunk {} {}: ", (itr.at(0)->parallel_type() == module_base::parallel::data ? "data" : "domain"),  chunks);
+        SPDLOG_DEBUG("Chunk {} {} (stage {}): ", (itr.at(0)->parallel_type() == module_base::parallel::data ? "data" : "domain"),  chunks, _chunk_stage.at(chunks));
         for (auto &jtr : itr)
         {
             SPDLOG_DEBUG(jtr->ID);
@@ -2125,6 +2424,7 @@ void core::run()
     size_t max_ts = _metdata->n_timestep();
     bool done = false;
 
+    _chunk_schedulers.resize(_chunked_modules.size());
 
 
         while (!done)
@@ -2139,23 +2439,27 @@ void core::run()
             ss << _global->posix_time();
 
             c.tic();
-            size_t chunks = 0;
             try
             {
-                for (auto &itr : _chunked_modules)
+                auto run_chunk = [&](size_t chunk)
                 {
+                    auto& itr = _chunked_modules.at(chunk);
 
                     if (itr.at(0)->parallel_type() == module_base::parallel::data)
                     {
 #ifdef OMP_SAFE_EXCEPTION
                         ompException e;
 #endif
-                        #pragma omp parallel for
-                        for (size_t i = 0; i < _mesh->size_faces(); i++)
+                        // faces are handed out in blocks balanced on the cost measured in previous timesteps
+                        auto& scheduler = _chunk_schedulers.at(chunk);
+                        if (scheduler.size() != _mesh->size_faces())
+                            scheduler.init(_mesh->size_faces());
+
+                        scheduler.run([&](size_t i)
                         {
                             auto face = _mesh->face(i);
                             if (point_mode.enable && face->_debug_name != _outputs[0].name)
-                                continue;
+                                return;
 
                              //module calls
                              for (auto &jtr : itr)
@@ -2170,10 +2474,11 @@ void core::run()
                                      });
 #endif
                              }
-                        }
+                        });
 #ifdef OMP_SAFE_EXCEPTION
                         e.Rethrow();
 #endif
+                        SPDLOG_DEBUG("Chunk {} load imbalance {:.1f}%", chunk, scheduler.imbalance() * 100.);
 
                     } else
                     {
@@ -2183,9 +2488,32 @@ void core::run()
                           jtr->run(_mesh);
                         }
                     }
+                };
 
-                    chunks++;
+                // chunks of the same stage are independent of each other
+                size_t chunk = 0;
+                while (chunk < _chunked_modules.size())
+                {
+                    size_t end = chunk;
+                    while (end < _chunked_modules.size() && _chunk_stage.at(end) == _chunk_stage.at(chunk))
+                        end++;
+
+                    if (_concurrent_modules && end - chunk > 1)
+                    {
+                        tbb::task_group tasks;
+                        for (size_t i = chunk; i < end; i++)
+                        {
+                            tasks.run([&run_chunk, i] { run_chunk(i); });
+                        }
+                        tasks.wait(); // rethrows any exception from a module
+                    }
+                    else
+                    {
+                        for (size_t i = chunk; i < end; i++)
+                            run_chunk(i);
+                    }
 
+                    chunk = end;
                 }
             }
             catch (exception_base &e)
@@ -2207,10 +2535,12 @@ void core::run()
                 SPDLOG_ERROR(e.what());
             }
 
-            //check that we actually need a mesh output.
+            //check that we actually need a vtu mesh output.
             for (auto &itr : _outputs)
             {
-                if(itr.type == output_info::output_type::mesh)
+                if(itr.type == output_info::output_type::mesh &&
+                   std::find(itr.mesh_output_formats.begin(), itr.mesh_output_formats.end(),
+                             output_info::mesh_outputs::vtu) != itr.mesh_output_formats.end())
                 {
                     std::vector<std::string> output;
                     output.assign(itr.variables.begin(),itr.variables.end()); //convert to list to match internal lists
@@ -2228,6 +2558,16 @@ void core::run()
             {
                 SPDLOG_DEBUG("Checkpointing...");
 
+                // the netCDF library is not thread safe, so the forcing reader waits while we write the checkpoint
+                std::lock_guard<std::mutex> nc_lock(netcdf::library_mutex());
+
+                // nor can the output writer as h5 outputs also go through HDF5
+                _output_writer.flush();
+
+                // timeseries output on disk should be up to date with the checkpoint
+                if (_point_output)
+                    _point_output->flush();
+
                 netcdf savestate; //file to save to when checkpointing.
 
                 auto timestamp = _global->posix_time() + boost::posix_time::seconds(_global->_dt);
@@ -2246,11 +2586,16 @@ void core::run()
                 boost::filesystem::create_directories(dirpath);
 
                 //this parses both the input and the output paths for the checkpoint.
-                auto fname = ("chkp"+timestr + "_" + std::to_string(rank) + ".nc");
+                auto fname = _checkpoint_opts.shared_file ? ("chkp" + timestr + ".nc")
+                                                          : ("chkp"+timestr + "_" + std::to_string(rank) + ".nc");
                 auto f = dirpath / fname;
-                savestate.create( f.string());
 
                 c.tic();
+                if (_checkpoint_opts.shared_file)
+                    savestate.create_shared(f.string(), _mesh->size_global_faces(), _checkpoint_offset());
+                else
+                    savestate.create( f.string());
+
                 for (auto &itr : _chunked_modules)
                 {
                     //module calls
@@ -2263,13 +2608,39 @@ void core::run()
                 auto& ids = _mesh->get_global_IDs();
                 savestate.create_variable1D("global_id",ids.size());
 
-                for (size_t i = 0; i < ids.size(); i++)
+                std::vector<double> id_values(ids.begin(), ids.end());
+                savestate.put_var1D("global_id", id_values);
+
+                // the global id of a triangle depends on the mesh permutation, so also store the centroids to validate a restore
+                if (_checkpoint_opts.shared_file)
                 {
-                    savestate.put_var1D("global_id", i, ids[i]);
+                    std::vector<double> x(_mesh->size_faces());
+                    std::vector<double> y(_mesh->size_faces());
+                    #pragma omp parallel for
+                    for (size_t i = 0; i < _mesh->size_faces(); i++)
+                    {
+                        auto face = _mesh->face(i);
+                        x[i] = face->get_x();
+                        y[i] = face->get_y();
+                    }
+
+                    savestate.create_variable1D("face_x", x.size());
+                    savestate.put_var1D("face_x", x);
+                    savestate.create_variable1D("face_y", y.size());
+                    savestate.put_var1D("face_y", y);
                 }
 
                 savestate.get_ncfile().putAtt("restart_time",boost::posix_time::to_simple_string(timestamp));
                 savestate.get_ncfile().putAtt("restart_time_sec", netCDF::ncUint64,ts_sec);
+                savestate.close();
+
+                // total over all ranks
+                uintmax_t bytes = 0;
+                if (!_checkpoint_opts.shared_file || rank == 0)
+                    bytes = boost::filesystem::file_size(f);
+#ifdef USE_MPI
+                bytes = boost::mpi::all_reduce(_comm_world, bytes, std::plus<uintmax_t>());
+#endif
 
                 pt::ptree tree;
 
@@ -2281,17 +2652,28 @@ void core::run()
                 tree.put("ranks", nranks);
                 tree.put("restart_time_sec", ts_sec);
                 tree.put("startdate", timestr);
+                tree.put("format", _checkpoint_opts.shared_file ? "shared" : "per_rank");
 
                 pt::ptree files;
 
                 pt::ptree tmp_files;
-                for (size_t i = 0; i < nranks; ++i)
+                if (_checkpoint_opts.shared_file)
                 {
                     pt::ptree s;
 
-                    s.put("", timestr +"/" + "chkp"+timestr + "_" + std::to_string(i) + ".nc");
+                    s.put("", timestr + "/" + fname);
                     tmp_files.push_back(std::make_pair("", s));
                 }
+                else
+                {
+                    for (size_t i = 0; i < nranks; ++i)
+                    {
+                        pt::ptree s;
+
+                        s.put("", timestr +"/" + "chkp"+timestr + "_" + std::to_string(i) + ".nc");
+                        tmp_files.push_back(std::make_pair("", s));
+                    }
+                }
                 tree.add_child("files", tmp_files);
 
 
@@ -2302,7 +2684,7 @@ void core::run()
                         tree);
                 }
 
-                SPDLOG_DEBUG("Done checkpoint [ {} s]", c.toc<s>());
+                SPDLOG_DEBUG("Done checkpoint [ {} s, {:.1f} MB ]", c.toc<s>(), bytes / (1024. * 1024.));
 
                 // if we checkpointed because we are out of time, we need to stop the simulation
                 if(_checkpoint_opts.checkpoint_request_terminate)
@@ -2337,52 +2719,70 @@ void core::run()
 
                     if(should_output)
                     {
+                        std::string base_name = itr.fname + std::to_string(_global->posix_time_int());
+                        boost::filesystem::path p(base_name);
 
-                        #pragma omp parallel
+                        // Each format takes a snapshot of this timestep's values and hands it to the output writer
+                        // thread, so the model can carry on while it is written
+                        for (auto jtr : itr.mesh_output_formats)
                         {
-                            #pragma omp single
+                            if (jtr == output_info::mesh_outputs::vtu)
                             {
-                                for (auto jtr : itr.mesh_output_formats)
+                                // this really only works if we let rank0 handle the io.
+                                // If we let each process do it, they walk all over each other's output
+#ifdef USE_MPI
+                                if(_comm_world.rank() == 0)
                                 {
-                                    #pragma omp task
+                                    for(int rank = 0; rank < _comm_world.size(); rank++)
                                     {
-                                        std::string base_name = itr.fname + std::to_string(_global->posix_time_int());
-                                        boost::filesystem::path p(base_name);
-
-                                        if (jtr == output_info::mesh_outputs::vtu  )
-                                        {
-
-                                            // this really only works if we let rank0 handle the io.
-                                            // If we let each process do it, they walk all over each other's output
-#ifdef USE_MPI
-                                            if(_comm_world.rank() == 0)
-                                            {
-                                                for(int rank = 0; rank < _comm_world.size(); rank++)
-                                                {
 #else
-                                                    int rank = 0;
+                                        int rank = 0;
 #endif
-                                                    pt::ptree &dataset = pvd.add("VTKFile.Collection.DataSet", "");
-                                                    dataset.add("<xmlattr>.timestep", _global->posix_time_int());
-                                                    dataset.add("<xmlattr>.group", "");
-                                                    dataset.add("<xmlattr>.part", rank);
-                                                    dataset.add("<xmlattr>.file", p.filename().string()+"_"+std::to_string(rank) + ".vtu");
+                                        pt::ptree &dataset = pvd.add("VTKFile.Collection.DataSet", "");
+                                        dataset.add("<xmlattr>.timestep", _global->posix_time_int());
+                                        dataset.add("<xmlattr>.group", "");
+                                        dataset.add("<xmlattr>.part", rank);
+                                        dataset.add("<xmlattr>.file", p.filename().string()+"_"+std::to_string(rank) + ".vtu");
 #ifdef USE_MPI
-                                                }
-                                            }
+                                    }
+                                }
 #endif
 
-                                            //because a full path can be provided for the base_name, we need to strip this off
-                                            //to make it a relative path in the xml file.
-
+                                //because a full path can be provided for the base_name, we need to strip this off
+                                //to make it a relative path in the xml file.
+                                size_t rank_id = 0;
 #ifdef USE_MPI
-                                            _mesh->write_vtu(base_name + "_"+std::to_string(_comm_world.rank() )+ ".vtu");
-#else
-                                            _mesh->write_vtu(base_name + "_"+std::to_string(rank)+ ".vtu");
+                                rank_id = _comm_world.rank();
 #endif
+                                auto fname = base_name + "_" + std::to_string(rank_id) + ".vtu";
+                                auto grid = _mesh->vtu_snapshot();
+                                _output_writer.submit([grid, fname] { triangulation::write_vtu(grid, fname); });
+                            }
+                            else if (jtr == output_info::mesh_outputs::h5)
+                            {
+                                if (!itr.h5_writer)
+                                {
+                                    // HDF5 calls can't overlap the netCDF forcing reads unless HDF5 is thread safe
+                                    std::lock_guard<std::mutex> nc_lock(netcdf::library_mutex());
 
-                                        }
-                                    }
+                                    std::vector<std::string> output(itr.variables.begin(), itr.variables.end());
+                                    itr.h5_writer = std::make_shared<mesh_h5_writer>(_mesh.get(), itr.fname, output,
+                                                                                     itr.write_parameters, itr.compression);
+                                }
+
+                                auto writer = itr.h5_writer;
+                                auto snap = writer->take_snapshot(_global->posix_time_int());
+
+                                // h5 writes are collective over the ranks and call into HDF5, so they can only be
+                                // moved to the writer thread if both MPI and HDF5 allow it
+                                if (writer->thread_safe())
+                                {
+                                    _output_writer.submit([writer, snap] { writer->write(snap); });
+                                }
+                                else
+                                {
+                                    std::lock_guard<std::mutex> nc_lock(netcdf::library_mutex());
+                                    writer->write(snap);
                                 }
                             }
                         }
@@ -2392,17 +2792,33 @@ void core::run()
 
             //If we are output a timeseries at specific triangles, we do that here
             //Each output knows what face it corresponds to
-            for (auto &itr : _outputs)
+            if (_point_output)
             {
-                //only update the full timeseries
-                if (itr.type == output_info::output_type::time_series)
+                _point_output->begin_row(_global->posix_time());
+
+                size_t point = 0;
+                for (auto &itr : _outputs)
                 {
-                    for (auto v : _provided_var_module)
+                    if (itr.type == output_info::output_type::time_series)
                     {
-                        auto data = (*itr.face)[v];
-                        itr.ts.at(v, current_ts) = data;
+                        double* row = _point_output->row(point);
+                        for (size_t v = 0; v < _point_output_handles.size(); v++)
+                        {
+                            row[v] = itr.face->get(_point_output_handles[v]);
+                        }
+                        point++;
                     }
                 }
+
+                if (_point_output->end_row())
+                {
+                    // the netCDF library is not thread safe, so the forcing reader waits during the write
+                    std::unique_lock<std::mutex> nc_lock(netcdf::library_mutex(), std::defer_lock);
+                    if (_point_output->uses_netcdf())
+                        nc_lock.lock();
+
+                    _point_output->flush();
+                }
             }
 
             if(!_metdata->next())
@@ -2439,8 +2855,19 @@ void core::run()
 
 
         }
+        // wait for the last outputs to be written
+        _output_writer.flush();
+
         double elapsed = c.toc<s>();
         SPDLOG_DEBUG("Total runtime was {}s", elapsed);
+        SPDLOG_DEBUG("Time spent waiting on forcing I/O was {}s", _metdata->prefetch_stall_time());
+        SPDLOG_DEBUG("Time spent waiting on output I/O was {}s", _output_writer.stall_time());
+
+        for (size_t i = 0; i < _chunk_schedulers.size(); i++)
+        {
+            if (_chunked_modules.at(i).at(0)->parallel_type() == module_base::parallel::data)
+                SPDLOG_DEBUG("Chunk {} mean load imbalance {:.1f}%", i, _chunk_schedulers.at(i).mean_imbalance() * 100.);
+        }
 
 
 
@@ -2469,14 +2896,14 @@ void core::run()
         }
     }
 
-    for (auto &itr : _outputs)
+    // write the remaining timeseries rows. If there was an exception, rows stop at the last completed timestep
+    if (_point_output)
     {
-        //save the full timeseries
-        if (itr.type == output_info::output_type::time_series)
-        {
-            itr.ts.subset(*_start_ts,*_end_ts); // in the event of an exception, _end_ts will be reset to have the esception timestep so-as to no write massive amounts of nan values
-            itr.ts.to_file(itr.fname);
-        }
+        std::unique_lock<std::mutex> nc_lock(netcdf::library_mutex(), std::defer_lock);
+        if (_point_output->uses_netcdf())
+            nc_lock.lock();
+
+        _point_output->flush();
     }
 
 
@@ -2489,6 +2916,23 @@ void core::run()
 
 void core::end(const bool abort)
 {
+    // make sure any output still queued is written, even if the run failed
+    try
+    {
+        _output_writer.flush();
+
+        // rewrite the XDMF sidecars once with the final number of timesteps
+        for (auto& itr : _outputs)
+        {
+            if (itr.h5_writer)
+                itr.h5_writer->end();
+        }
+    }
+    catch(std::exception& e)
+    {
+        SPDLOG_ERROR("Failed to write output: {}", e.what());
+    }
+
 #ifdef USE_MPI
     if(abort)
     {
@@ -2575,23 +3019,66 @@ void core::populate_face_station_lists()
 
     SPDLOG_DEBUG("Populating each face's station list");
 
-    for (size_t i = 0; i < _mesh->size_faces(); i++)
+    timer c;
+    c.tic();
+
+    auto& sets = _mesh->station_sets();
+
+    // the station queries are run concurrently
+    _metdata->build_search_tree();
+
+    // Sort each face's stations into the metdata order so that faces that find the same stations, which a knn search
+    // returns in distance order, share one set
+    std::unordered_map<const station*, size_t> order;
+    for (size_t i = 0; i < _metdata->stations().size(); i++)
+    {
+        order[_metdata->stations()[i].get()] = i;
+    }
+
+    auto rank = [&order](const std::shared_ptr<station>& s)
+    {
+        auto itr = order.find(s.get());
+        return itr == order.end() ? order.size() : itr->second;
+    };
+
+    // Query the faces in parallel a block at a time and intern the block's sets serially. The block bounds the number of
+    // temporary station lists held at once
+    const size_t block = 65536;
+    std::vector< std::vector< std::shared_ptr<station> > > stations(block);
+    std::vector< std::shared_ptr<station> > nearest(block);
+
+    for (size_t start = 0; start < _mesh->size_faces(); start += block)
     {
-        auto f = _mesh->face(i);
+        size_t end = std::min(start + block, _mesh->size_faces());
 
-        if ( f->stations().size() == 0 )
+        #pragma omp parallel for
+        for (size_t i = start; i < end; i++)
         {
-            auto stations = _metdata->get_stations(f->get_x(), f->get_y());
-            f->stations().insert(std::end(f->stations()), std::begin(stations), std::end(stations));
+            auto f = _mesh->face(i);
+            auto& s = stations[i - start];
 
-            f->nearest_station() = _metdata->nearest_station(f->get_x(), f->get_y()).at(0);
+            s = _metdata->get_stations(f->get_x(), f->get_y());
+            std::stable_sort(s.begin(), s.end(),
+                             [&](const auto& a, const auto& b) { return rank(a) < rank(b); });
 
-        }  else
+            nearest[i - start] = _metdata->nearest_station(f->get_x(), f->get_y()).at(0);
+        }
+
+        for (size_t i = start; i < end; i++)
         {
-            CHM_THROW_EXCEPTION(mesh_error, "Face station list already populated.");
+            auto f = _mesh->face(i);
+
+            if ( f->station_set() != station_set_table::npos )
+            {
+                CHM_THROW_EXCEPTION(mesh_error, "Face station list already populated.");
+            }
+
+            f->set_station_set(sets.insert(stations[i - start], nearest[i - start]));
         }
     }
 
+    SPDLOG_DEBUG("{} faces share {} unique station sets ({} stations total). Took {} s",
+                 _mesh->size_faces(), sets.size(), sets.members(), c.toc<s>());
 }
 
 void core::populate_distributed_station_lists()
@@ -73,6 +73,7 @@ namespace po = boost::program_options;
 
 // tbb
 #include <tbb/concurrent_vector.h>
+#include <tbb/task_group.h>
 
 //osgeo
 #include <ogr_spatialref.h>
@@ -93,8 +94,12 @@ namespace po = boost::program_options;
 #include "station.hpp"
 #include "str_format.h"
 #include "timer.hpp"
+#include "face_scheduler.hpp"
+#include "async_writer.hpp"
 #include "timeseries/netcdf.hpp"
+#include "timeseries/point_output.hpp"
 #include "triangulation.hpp"
+#include "mesh_h5_writer.hpp"
 #include "version.h"
 
 #ifdef USE_MPI
@@ -197,6 +202,13 @@ public:
     void config_global( pt::ptree& value);
     void config_checkpoint( pt::ptree& value);
 
+    /**
+     * Offset of this rank's faces in a checkpoint file shared by all ranks. Faces are keyed by cell_global_id, which
+     * a partition assigns to each rank as one contiguous block.
+     * @return
+     */
+    size_t _checkpoint_offset();
+
     /**
      * Determines what the start end times should be, and ensures consistency from a check pointed file
      */
@@ -292,6 +304,20 @@ protected:
     //pair as we also need to store the make order
     std::vector< std::pair<module,size_t> > _modules;
     std::vector< std::vector < module> > _chunked_modules;
+
+    // cost-aware face scheduling for each data parallel chunk, indexed the same as _chunked_modules
+    std::vector< face_scheduler > _chunk_schedulers;
+
+    // the stage each chunk in _chunked_modules belongs to. Chunks in the same stage have no dependencies
+    // between them and may be run concurrently if _concurrent_modules is set
+    std::vector< size_t > _chunk_stage;
+
+    // modules each module depends on, indexed by IDnum. Built from the dependency graph
+    std::vector< std::set<size_t> > _module_predecessors;
+
+    // run independent chunks of the same stage as concurrent tasks
+    bool _concurrent_modules;
+
     std::vector< std::pair<std::string,std::string> > _overrides;
     boost::shared_ptr<global> _global;
 
@@ -337,7 +363,9 @@ protected:
                       latitude{0}, longitude{0},
                       name{""},
                       x{0}, y{0},
-                      only_last_n{SIZE_MAX}
+                      only_last_n{SIZE_MAX},
+                      write_parameters{true},
+                      compression{4}
         {
             face = nullptr;
         }
@@ -350,7 +378,8 @@ protected:
         {
             vtp,
             vtu,
-            ascii
+            ascii,
+            h5
         };
 
         output_type type; // the type of output
@@ -369,16 +398,30 @@ protected:
 
         std::set<std::string> variables;
         mesh_elem face;
-        timeseries ts;
         size_t frequency;
 
         //Only output the last n timesteps. -1 = all
         size_t only_last_n;
 
+        // h5 mesh output. The writer is created on the first output, once the face variables exist
+        bool write_parameters;
+        int compression;
+        std::shared_ptr<mesh_h5_writer> h5_writer;
+
     };
 
     std::vector<output_info> _outputs;
 
+    // writes mesh outputs in the background
+    async_writer _output_writer;
+
+    // streams the timeseries outputs to disk
+    std::unique_ptr<point_output> _point_output;
+    point_output::format _point_output_format;
+    size_t _point_flush_interval;
+    boost::filesystem::path _point_output_path;
+    std::vector<var_handle> _point_output_handles;
+
 
     // Detects various information about the HPC scheduler we might be run der
     class hpc_scheduler_info
@@ -452,6 +495,8 @@ protected:
                     do_checkpoint{false},
                     load_from_checkpoint{false},
                     on_last{false},
+                    shared_file{false},
+                    load_shared_file{false},
                     checkpoint_request_terminate{false}
         {
             abort_when_wallclock_left = boost::posix_time::minutes(2);
@@ -467,6 +512,11 @@ protected:
         boost::optional<bool> on_last; //only checkpoint on the last timestep
         boost::optional<size_t> frequency; // frequency of checkpoints
 
+        // write one file shared by all ranks, keyed by cell_global_id, instead of one file per rank
+        bool shared_file;
+        // the checkpoint being loaded is a shared file, so can be loaded with any number of ranks
+        bool load_shared_file;
+
 
         // used to stop the simulation when we checkpoint when we are outta time
         bool checkpoint_request_terminate;
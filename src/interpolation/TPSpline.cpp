@@ -30,6 +30,10 @@
 #include "TPSBasis.hpp"
 #include <boost/predef.h>
 
+#include <map>
+#include <mutex>
+#include <limits>
+
 // Build FunC lookup table for -(log(x)+gamma+gsl_sf_expint_E1(x))
 
 // hardcoded error of 1e-8
@@ -53,124 +57,169 @@ static func::FailureProofTable<func::NonUniformEqSpaceInterpTable<3,double>,doub
 //} counter;
 
 
+namespace
+{
+    // LU decompositions shared between all the spline instances, keyed on the weight followed by the sample point locations.
+    // Most faces use an identical set of stations, so this avoids factoring the same matrix once per face.
+    std::mutex tps_lu_mutex;
+    std::map< std::vector<double>, std::shared_ptr<const Eigen::FullPivLU< Eigen::Matrix<double,Eigen::Dynamic, Eigen::Dynamic> > > > tps_lu_cache;
+
+    // Bound the memory used if the station sets keep changing, e.g., from varying NaN masks.
+    // In-use decompositions are held by the instances, so they survive the cache being cleared
+    const size_t tps_lu_cache_max = 8192;
+}
+
+double thin_plate_spline::basis(double xdiff, double ydiff)
+{
+    double dij = sqrt(xdiff * xdiff + ydiff * ydiff); //distance between this set of observation points
+
+    //none of the books and papers, despite citing Helena Mitášová, Lubos Mitáš seem to agree on the exact formula
+    //so I am following http://link.springer.com/article/10.1007/BF00893171#page-1
+    // eqn 10
+
+    dij = (dij * weight / 2.0) * (dij * weight / 2.0);
+
+    //Chang 4th edition 2008 uses bessel_k0
+    //gsl_sf_bessel_K0
+    // and has a -0.5 weight out fron
+
+    //And Hengl and Evans in geomorphometry p.52 do not, but have some undefined omega_0/omega_1 weights
+    //it is all rather confusing. But this follows Mitášová exactly, and produces essentially the same answer
+    //as the worked example in box 16.2 in Chang
+//    return TPSBasis_LUT(dij);
+    return -(log(dij) + c + gsl_sf_expint_E1(dij));
+}
+
+std::shared_ptr<const thin_plate_spline::LU> thin_plate_spline::factorize(const std::vector<double>& coords)
+{
+    std::vector<double> key;
+    if(reuse_LU)
+    {
+        key.reserve(coords.size() + 1);
+        key.push_back(weight);
+        key.insert(key.end(), coords.begin(), coords.end());
+
+        std::lock_guard<std::mutex> lock(tps_lu_mutex);
+        auto itr = tps_lu_cache.find(key);
+        if(itr != tps_lu_cache.end())
+            return itr->second;
+    }
+
+    size_t n = coords.size() / 2;
+    size_t sz = n + 1; // need to make room for the physics
+
+    MatrixXXd A = MatrixXXd::Zero(sz, sz);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double sxi = coords[2 * i]; //x
+        double syi = coords[2 * i + 1]; //y
+
+        for (size_t j = i + 1; j < n; j++)
+        {
+            double sxj = coords[2 * j]; //x
+            double syj = coords[2 * j + 1]; //y
+
+            double xdiff = (sxi - sxj);
+            double ydiff = (syi - syj);
+
+            //don't add in a duplicate point, otherwise we get nan
+            if (xdiff == 0. && ydiff == 0.)
+                continue;
+
+            double Rd = basis(xdiff, ydiff);
+
+            A(i, j + 1) = Rd;
+            A(j, i + 1) = Rd;
+        }
+    }
+
+    //set physics
+    for (size_t i = 0; i < sz; i++)
+    {
+        A(i, 0) = 1;
+        A(sz - 1, i) = 1;
+    }
+    A(sz - 1, 0) = 0;
+
+    auto lu = std::make_shared<const LU>(A);
+
+    if(reuse_LU)
+    {
+        std::lock_guard<std::mutex> lock(tps_lu_mutex);
+        if(tps_lu_cache.size() >= tps_lu_cache_max)
+            tps_lu_cache.clear();
+        tps_lu_cache.emplace(std::move(key), lu);
+    }
+
+    return lu;
+}
+
 double thin_plate_spline::operator()(std::vector< boost::tuple<double,double,double> >& sample_points, boost::tuple<double,double,double>& query_point)
 {
-    //func::Timer t;
-    //see if we can reuse our
-    if(sample_points.size() + 1 != size)
+    size_t n = sample_points.size();
+
+    if(n + 1 != size)
     {
-        size = sample_points.size();
+        size = n;
         size++; // need to make room for the physics
-        A = MatrixXXd::Zero(size,size);
         b = VectorXd::Zero(size);
         x = VectorXd::Zero(size);
     }
 
-    if(uninit_lu_decomp)
+    double ex = query_point.get<0>();
+    double ey = query_point.get<1>();
+
+    // A only depends on where the sample points are, not their values. So the decomposition can be used until
+    // the sample locations change, e.g., a station drops out because it is NaN this timestep
+    bool same_points = reuse_LU && _lu && _coords.size() == 2 * n;
+    for (size_t i = 0; same_points && i < n; i++)
+    {
+        same_points = _coords[2 * i] == sample_points[i].get<0>() &&
+                      _coords[2 * i + 1] == sample_points[i].get<1>();
+    }
+
+    if(!same_points)
     {
-        //build the LU decomp
-        for (unsigned int i = 0; i < size - 1; i++)
+        _coords.resize(2 * n);
+        for (size_t i = 0; i < n; i++)
         {
-            double sxi = sample_points.at(i).get<0>(); //x
-            double syi = sample_points.at(i).get<1>(); //y
-
-            for (unsigned int j = i; j < size - 1; j++)
-            {
-                double sxj = sample_points.at(j).get<0>(); //x
-                double syj = sample_points.at(j).get<1>(); //y
-
-                double xdiff = (sxi - sxj);
-                double ydiff = (syi - syj);
-
-                //don't add in a duplicate point, otherwise we get nan
-                if (xdiff == 0. && ydiff == 0.)
-                    continue;
-
-                double Rd = 0.;
-                if (j == i) // diagonal
-                {
-                    Rd = 0.0;
-                } else
-                {
-                    double dij = sqrt(xdiff * xdiff + ydiff * ydiff); //distance between this set of observation points
-
-                    //none of the books and papers, despite citing Helena Mitášová, Lubos Mitáš seem to agree on the exact formula
-                    //so I am following http://link.springer.com/article/10.1007/BF00893171#page-1
-                    // eqn 10
-
-                    dij = (dij * weight / 2.0) * (dij * weight / 2.0);
-
-                    //Chang 4th edition 2008 uses bessel_k0
-                    //gsl_sf_bessel_K0
-                    // and has a -0.5 weight out fron
-//                     Rd = -0.5/(pi*weight*weight)*( log(dij*weight/2.0) + c + gsl_sf_bessel_K0(dij*weight));
-
-                    //And Hengl and Evans in geomorphometry p.52 do not, but have some undefined omega_0/omega_1 weights
-                    //it is all rather confusing. But this follows Mitášová exactly, and produces essentially the same answer
-                    //as the worked example in box 16.2 in Chang
-                      Rd = -(log(dij) + c + gsl_sf_expint_E1(dij));
-//                    Rd = TPSBasis_LUT(dij);
-                }
-
-                A(i, j + 1) = Rd;
-                A(j, i + 1) = Rd;
-
-            }
+            _coords[2 * i] = sample_points[i].get<0>();
+            _coords[2 * i + 1] = sample_points[i].get<1>();
         }
 
+        _lu = factorize(_coords);
+    }
 
-        //set physics and build b values
-        for (unsigned int i = 0; i < size; i++)
+    if(!same_points || ex != _query_x || ey != _query_y)
+    {
+        _query_basis.resize(n);
+        for (size_t i = 0; i < n; i++)
         {
-            A(i, 0) = 1;
-            A(size - 1, i) = 1;
+            _query_basis(i) = basis(_coords[2 * i] - ex, _coords[2 * i + 1] - ey);
         }
-        A(size - 1, 0) = 0;
-        lu.compute(A);
+        _query_x = ex;
+        _query_y = ey;
     }
 
-
-    //this will skip the above computation of the lu decomp next time this is called
-    if(reuse_LU)
-        uninit_lu_decomp = false;
-
     for(size_t i=0;i<size-1;i++)
     {
-        b(i) = sample_points.at(i).get<2>() ;
+        b(i) = sample_points[i].get<2>() ;
     }
 
     b(size-1) = 0.0; //constant
 
     //solve equation
-    int s				= 0;
-
-    x =  lu.solve(b) ; //ldlt.solve(b);
-
+    x = _lu->solve(b);
 
     double z0 = x(0);//little a
 
     //skip x[0] we already pulled off above
-    double ex = query_point.get<0>();
-    double ey =  query_point.get<1>();
-
     for (unsigned int i = 1; i < x.size() ;i++)
     {
-        double sx = sample_points.at(i-1).get<0>(); //x
-        double sy = sample_points.at(i-1).get<1>(); //y
-
-        double xdiff = (sx  - ex);
-        double ydiff = (sy  - ey);
-        double dij = sqrt(xdiff*xdiff + ydiff*ydiff);
-        dij = (dij * weight/2.0) * (dij * weight/2.0);
-        // set Rd equal to -(log(dij) + c + gsl_sf_expint_E1(dij))
-         
-//        double Rd = TPSBasis_LUT(dij);
-        double Rd = -(log(dij) + c + gsl_sf_expint_E1(dij));
-        z0 = z0 + x(i)*Rd;
+        z0 = z0 + x(i)*_query_basis(i-1);
     }
 
-    //t.stop();
-    //counter.total += t.duration();
     return z0;
 }
 
@@ -180,17 +229,14 @@ thin_plate_spline::thin_plate_spline(size_t sz, std::map<std::string,std::string
     size = sz;
     size++; // need to make room for the physics
 
-    A = MatrixXXd::Zero(size,size);
     b = VectorXd::Zero(size);
     x = VectorXd::Zero(size);
 
     auto itr = config.find("reuse_LU");
     if(itr != config.end())
     {
-        if(config["reuse_LU"] == "true")
-            reuse_LU = true;
+        reuse_LU = itr->second == "true";
     }
-    reuse_LU = false;
 }
 
 thin_plate_spline::thin_plate_spline()
@@ -200,8 +246,8 @@ thin_plate_spline::thin_plate_spline()
     weight      = 0.01;
     size        = 0;
 
-    reuse_LU    = false;
-    uninit_lu_decomp = true;
+    reuse_LU    = true;
+    _query_x = _query_y = std::numeric_limits<double>::quiet_NaN();
 }
 
 thin_plate_spline::~thin_plate_spline(){}
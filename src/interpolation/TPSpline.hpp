@@ -32,6 +32,8 @@
 #include <boost/throw_exception.hpp>
 #include <exception.hpp>
 #include <iostream>
+#include <vector>
+#include <memory>
 #include "interp_base.hpp"
 #include "logger.hpp"
 
@@ -60,19 +62,40 @@ public:
     */
     double operator()(std::vector< boost::tuple<double,double,double> >& sample_points, boost::tuple<double,double,double>& query_point);
 
+    /**
+     * If true (default), the LU decomposition is kept between calls and only rebuilt when the sample point locations change.
+     * Decompositions are also shared between all instances, so faces that use the same set of stations only factor once.
+     */
     bool reuse_LU;
 private:
     typedef Eigen::Matrix<double,Eigen::Dynamic,1> VectorXd;
     typedef Eigen::Matrix<double,Eigen::Dynamic, Eigen::Dynamic> MatrixXXd;
+    typedef Eigen::FullPivLU< MatrixXXd > LU;
+
+    /**
+     * Builds and factors the A matrix for the given sample point locations
+     * \param coords Sample point locations as x0,y0,x1,y1,...
+     */
+    std::shared_ptr<const LU> factorize(const std::vector<double>& coords);
+
+    /**
+     * Basis function for the distance between two points
+     */
+    double basis(double xdiff, double ydiff);
 
-    MatrixXXd A ;
     VectorXd b; // known values - constant value of 0 goes in b[size-1]
     VectorXd x;
 
-    Eigen::FullPivLU< Eigen::Matrix<double,Eigen::Dynamic, Eigen::Dynamic> > lu;
+    // sample point locations, x0,y0,x1,y1,..., that _lu and _query_basis were built for
+    std::vector<double> _coords;
+    std::shared_ptr<const LU> _lu;
+
+    // basis function between the query point and each sample point
+    VectorXd _query_basis;
+    double _query_x, _query_y;
+
     double pi;
     double c; //euler constant
     double weight;
-    bool uninit_lu_decomp;
     size_t size;
 };
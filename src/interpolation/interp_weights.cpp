@@ -0,0 +1,149 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "interp_weights.hpp"
+
+#include <unordered_map>
+#include <limits>
+#include <cmath>
+
+interp_weights::interp_weights()
+{
+
+}
+
+bool interp_weights::supports(interp_alg ia)
+{
+    return ia == interp_alg::idw || ia == interp_alg::nearest_sta;
+}
+
+void interp_weights::init(interp_alg ia, mesh& domain)
+{
+    if(!supports(ia))
+    {
+        CHM_THROW_EXCEPTION(interp_unknown_type, "Interpolation weights can only be precomputed for idw and nearest");
+    }
+
+    _row_ptr.assign(1, 0);
+    _col.clear();
+    _w.clear();
+    _stations.clear();
+
+    // station -> column
+    std::unordered_map<station*, size_t> columns;
+
+    auto column = [&](const std::shared_ptr<station>& s)
+    {
+        auto itr = columns.find(s.get());
+        if(itr != columns.end())
+            return itr->second;
+
+        size_t col = _stations.size();
+        columns[s.get()] = col;
+        _stations.push_back(s);
+        return col;
+    };
+
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto face = domain->face(i);
+
+        if(ia == interp_alg::nearest_sta)
+        {
+            // all of the weight goes to the nearest station
+            auto& s = face->nearest_station();
+            if(!s)
+            {
+                CHM_THROW_EXCEPTION(interpolation_error, "nearest requires the face's nearest station to be set");
+            }
+
+            _col.push_back(column(s));
+            _w.push_back(1.0);
+        }
+        else
+        {
+            for (auto& s : face->stations())
+            {
+                double xdiff = s->x() - face->get_x();
+                double ydiff = s->y() - face->get_y();
+                double di = xdiff * xdiff + ydiff * ydiff;
+
+                // a coincident station takes the value outright
+                double w = di == 0 ? std::numeric_limits<double>::infinity() : 1.0 / di;
+
+                _col.push_back(column(s));
+                _w.push_back(w);
+            }
+        }
+
+        _row_ptr.push_back(_col.size());
+    }
+
+    SPDLOG_DEBUG("Built interpolation weights for {} faces and {} stations, {} non-zeros", rows(), _stations.size(), _w.size());
+}
+
+const std::vector< std::shared_ptr<station> >& interp_weights::stations() const
+{
+    return _stations;
+}
+
+size_t interp_weights::rows() const
+{
+    return _row_ptr.size() - 1;
+}
+
+void interp_weights::apply(const std::vector<double>& values, std::vector<double>& out) const
+{
+    out.resize(rows());
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < rows(); i++)
+    {
+        double numerator = 0.0;
+        double denominator = 0.0;
+        bool exact = false;
+
+        for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; k++)
+        {
+            double v = values[_col[k]];
+
+            if(std::isnan(v))
+                continue;
+
+            if(std::isinf(_w[k]))
+            {
+                numerator = v;
+                exact = true;
+                break;
+            }
+
+            numerator += _w[k] * v;
+            denominator += _w[k];
+        }
+
+        if(exact)
+            out[i] = numerator;
+        else
+            out[i] = denominator > 0 ? numerator / denominator : std::numeric_limits<double>::quiet_NaN();
+    }
+}
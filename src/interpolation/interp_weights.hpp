@@ -0,0 +1,85 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include "triangulation.hpp"
+#include "interpolation.hpp"
+#include "station.hpp"
+
+#include <vector>
+#include <memory>
+
+/**
+* \class interp_weights
+*
+* For interpolants whose weights only depend on the face and station locations (idw, nearest), the weights for every
+* face are precomputed once as a sparse face x station matrix (CSR). Each timestep all the faces are then interpolated
+* with a single sparse matrix-vector product over the station values, instead of rebuilding the sample points and
+* distances per face.
+*
+* A NaN station value is masked out and the remaining weights of that row renormalised, giving the same result as
+* skipping the station when building the sample points.
+*/
+class interp_weights
+{
+public:
+    interp_weights();
+
+    /**
+     * True if the weights of this interpolant only depend on locations and can be precomputed
+     */
+    static bool supports(interp_alg ia);
+
+    /**
+     * Builds the weights for each local face of the domain from face->stations(). For nearest, the face's nearest station
+     * takes all of the weight.
+     * \param ia Interpolation algorithm, must be supported
+     * \param domain
+     */
+    void init(interp_alg ia, mesh& domain);
+
+    /**
+     * Stations referenced by any face, in column order. Values given to apply() must be in this order.
+     */
+    const std::vector< std::shared_ptr<station> >& stations() const;
+
+    /**
+     * Interpolates to all faces.
+     * \param values One value per station, in the order of stations(). May contain NaN
+     * \param out Interpolated value for face i of the domain. NaN if all of a face's stations are NaN
+     */
+    void apply(const std::vector<double>& values, std::vector<double>& out) const;
+
+    /**
+     * Number of rows (faces)
+     */
+    size_t rows() const;
+
+private:
+    std::vector<size_t> _row_ptr; // row i is [_row_ptr[i], _row_ptr[i+1])
+    std::vector<size_t> _col;     // column into _stations
+    std::vector<double> _w;       // weight, inf if the face and station are coincident
+
+    std::vector< std::shared_ptr<station> > _stations;
+};
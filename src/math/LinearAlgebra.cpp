@@ -28,8 +28,9 @@ namespace math
   namespace LinearAlgebra
   {
 
-    NearestNeighborProblem::NearestNeighborProblem(mesh& domain, int nLayer) :
-      m_domain(domain), m_nLayer(nLayer)
+    NearestNeighborProblem::NearestNeighborProblem(mesh& domain, int nLayer, const SolverOptions& options) :
+      m_domain(domain), m_nLayer(nLayer), m_options(options),
+      m_solves_since_compute(0), m_baseline_iters(0), m_last_iters(0), m_solved(false), m_assembling(false)
     {
 
       // TODO Accept a communicator on construction
@@ -153,6 +154,54 @@ namespace math
       // be in each row, so we use static profile for efficiency.)
       m_matrix = rcp (new crs_matrix_type (m_graph));
       m_matrix->fillComplete();
+
+      /*
+	Find where each row's stencil entries live in the local matrix values so
+	assembly can write them directly. The column map is only known after
+	fillComplete, and neighbors owned by other ranks are in it as well.
+      */
+      m_stencil_offsets.assign(ntri*nLayer, {m_no_entry, m_no_entry, m_no_entry, m_no_entry, m_no_entry, m_no_entry});
+      {
+	auto col_map = m_matrix->getColMap();
+	auto local_matrix = m_matrix->getLocalMatrixHost();
+	const auto& row_map = local_matrix.graph.row_map;
+	const auto& entries = local_matrix.graph.entries;
+
+	auto find_offset = [&](local_ordinal_type local_row, global_ordinal_type global_col) -> size_t
+	{
+	  local_ordinal_type local_col = col_map->getLocalElement(global_col);
+	  for (size_t k = row_map(local_row); k < row_map(local_row+1); ++k)
+	  {
+	    if (entries(k) == local_col)
+	      return k;
+	  }
+	  CHM_THROW_EXCEPTION(module_error, "Column " + std::to_string(global_col) + " is not in the graph of row " + std::to_string(local_row));
+	};
+
+#pragma omp parallel for
+	for (size_t i = 0; i < ntri; ++i)
+	{
+	  auto face = domain->face(i);
+	  for (int layer = 0; layer < nLayer; ++layer)
+	  {
+	    local_ordinal_type local_row = localRow(face, layer);
+	    auto& offsets = m_stencil_offsets.at(local_row);
+
+	    offsets[0] = find_offset(local_row, n_global_tri*layer + face->cell_global_id);
+	    for (int f = 0; f < 3; ++f)
+	    {
+	      auto neighbor = face->neighbor(f);
+	      if (neighbor != nullptr)
+		offsets[1+f] = find_offset(local_row, n_global_tri*layer + neighbor->cell_global_id);
+	    }
+	    if (layer < nLayer-1)
+	      offsets[4] = find_offset(local_row, n_global_tri*(layer+1) + face->cell_global_id);
+	    if (layer > 0)
+	      offsets[5] = find_offset(local_row, n_global_tri*(layer-1) + face->cell_global_id);
+	  }
+	}
+      }
+
       m_rhs = rcp(new MV(m_map, 1));
       m_solution = rcp(new MV(m_map, m_rhs->getNumVectors()));
 
@@ -175,16 +224,56 @@ namespace math
 	  CHM_THROW_EXCEPTION(module_error, "PBSM3D failed to create solver");
 	}
 
-      m_preconditioner = Ifpack2::Factory::create<row_matrix_type>("ILUT", m_matrix);
-      if (m_preconditioner.is_null())
+      /*
+	Ifpack2 preconditioner. The sparsity pattern never changes so initialize()
+	(symbolic setup) is only done here; compute() is done in Solve() as needed.
+      */
+      std::string prec = m_options.preconditioner;
+      std::transform(prec.begin(), prec.end(), prec.begin(), ::tolower);
+
+      if (m_options.preconditioner_reuse < 1)
 	{
-	  CHM_THROW_EXCEPTION(module_error, "PBSM3D failed to create preconditioner");
+	  CHM_THROW_EXCEPTION(module_error, "Preconditioner reuse must be >= 1");
 	}
-      ParameterList precondOptions;
-      precondOptions.set("fact: drop tolerance", 1e-4);
-      precondOptions.set("fact: ilut level-of-fill", 3.0); // Note this is different from num_entries_per_row: https://docs.trilinos.org/dev/packages/ifpack2/doc/html/classIfpack2_1_1ILUT.html#aee2011b313e3070ee43b2cfc2d183634
-      m_preconditioner->setParameters(precondOptions);
-      m_preconditioner->initialize();
+
+      if (prec != "none")
+      {
+	std::string prec_type;
+	ParameterList precondOptions;
+	if (prec == "ilut")
+	  {
+	    prec_type = "ILUT";
+	    precondOptions.set("fact: drop tolerance", 1e-4);
+	    precondOptions.set("fact: ilut level-of-fill", 3.0); // Note this is different from num_entries_per_row: https://docs.trilinos.org/dev/packages/ifpack2/doc/html/classIfpack2_1_1ILUT.html#aee2011b313e3070ee43b2cfc2d183634
+	  }
+	else if (prec == "riluk")
+	  {
+	    prec_type = "RILUK";
+	    precondOptions.set("fact: iluk level-of-fill", 1);
+	  }
+	else if (prec == "jacobi")
+	  {
+	    prec_type = "RELAXATION";
+	    precondOptions.set("relaxation: type", "Jacobi");
+	  }
+	else if (prec == "sgs")
+	  {
+	    prec_type = "RELAXATION";
+	    precondOptions.set("relaxation: type", "Symmetric Gauss-Seidel");
+	  }
+	else
+	  {
+	    CHM_THROW_EXCEPTION(module_error, "Unknown preconditioner " + m_options.preconditioner + ". Valid options are ilut, riluk, jacobi, sgs, none");
+	  }
+
+	m_preconditioner = Ifpack2::Factory::create<row_matrix_type>(prec_type, m_matrix);
+	if (m_preconditioner.is_null())
+	  {
+	    CHM_THROW_EXCEPTION(module_error, "PBSM3D failed to create preconditioner");
+	  }
+	m_preconditioner->setParameters(precondOptions);
+	m_preconditioner->initialize();
+      }
 
       // Specify the deposition problem
       m_problem = rcp (new problem_type (m_matrix, m_solution, m_rhs));
@@ -202,7 +291,51 @@ namespace math
       // Zero out suspension system
       m_matrix->setAllToScalar(0.0);
       m_rhs->putScalar(0.0);
-      m_solution->putScalar(0.0);
+      // a warm start keeps the last solution as the initial guess
+      if (!m_options.warm_start)
+	m_solution->putScalar(0.0);
+      m_solved = false;
+
+      m_local_matrix = m_matrix->getLocalMatrixHost();
+      m_local_rhs = m_rhs->getLocalViewHost(Tpetra::Access::ReadWrite);
+      m_assembling = true;
+    }
+
+    void NearestNeighborProblem::finishAssembly()
+    {
+      if (!m_assembling)
+	return;
+
+      m_local_matrix = crs_matrix_type::local_matrix_host_type();
+      m_local_rhs = MV::dual_view_type::t_host();
+      m_assembling = false;
+    }
+
+    local_ordinal_type NearestNeighborProblem::localRow(const mesh_elem& face, int layer) const
+    {
+      return m_domain->size_faces()*layer + face->cell_local_id;
+    }
+
+    void NearestNeighborProblem::matrixSumIntoLocalRow(local_ordinal_type local_row, const StencilRow& row)
+    {
+      const auto& offsets = m_stencil_offsets[local_row];
+      auto& values = m_local_matrix.values;
+
+      values(offsets[0]) += row.self;
+      for (int f = 0; f < 3; ++f)
+      {
+	if (offsets[1+f] != m_no_entry)
+	  values(offsets[1+f]) += row.neighbor[f];
+      }
+      if (offsets[4] != m_no_entry)
+	values(offsets[4]) += row.above;
+      if (offsets[5] != m_no_entry)
+	values(offsets[5]) += row.below;
+    }
+
+    void NearestNeighborProblem::rhsSumIntoLocalValue(local_ordinal_type local_row, double val)
+    {
+      m_local_rhs(local_row, 0) += val;
     }
 
     void NearestNeighborProblem::matrixReplaceGlobalValues(global_ordinal_type global_row_idx, global_ordinal_type global_col_idx, double val)
@@ -227,10 +360,35 @@ namespace math
 
     SolveConverge NearestNeighborProblem::Solve()
     {
+      finishAssembly();
       m_matrix->fillComplete();
-      m_preconditioner->compute();
+
+      SolveConverge tmp;
+      timer c;
+
+      /*
+	The coefficients change slowly between timesteps, so a factorization of an
+	earlier matrix is usually still a good preconditioner. Recompute it every
+	preconditioner_reuse solves, or sooner if the iteration count degrades.
+      */
+      c.tic();
+      tmp.recomputedPreconditioner = false;
+      if (!m_preconditioner.is_null())
+      {
+	bool degraded = m_last_iters > m_options.reuse_iteration_growth * std::max(m_baseline_iters, 1);
+	if (!m_preconditioner->isComputed() ||
+	    m_solves_since_compute >= m_options.preconditioner_reuse ||
+	    degraded)
+	{
+	  m_preconditioner->compute();
+	  m_solves_since_compute = 0;
+	  tmp.recomputedPreconditioner = true;
+	}
+      }
+      tmp.setupTime = c.toc<ns>() / 1e6;
 
       // Solve the linear system.
+      c.tic();
       m_solver->reset(Belos::Problem);
       {        Belos::ReturnType solveResult = m_solver->solve();
         if (solveResult != Belos::Converged)
@@ -243,10 +401,18 @@ namespace math
 	  }
       }
 
+      tmp.solveTime = c.toc<ns>() / 1e6;
+      m_solved = true;
+
       // Get (and return) convergence info
-      SolveConverge tmp;
       tmp.numIters = m_solver->getNumIters();
       tmp.residual = m_solver->achievedTol();
+
+      ++m_solves_since_compute;
+      m_last_iters = tmp.numIters;
+      if (tmp.recomputedPreconditioner)
+	m_baseline_iters = tmp.numIters;
+
       return tmp;
 
     }
@@ -263,6 +429,7 @@ namespace math
     // RHS's maximum value can be computed by InfNorm
     double NearestNeighborProblem::getRhsMax()
     {
+      finishAssembly();
       double tempStorage;
       Teuchos::ArrayView<double> max_value(&tempStorage,1);
       m_rhs->normInf(max_value);
@@ -271,11 +438,16 @@ namespace math
 
     ArrayRCP<const double> NearestNeighborProblem::getSolutionView()
     {
+      // with a warm start the solution still holds the last solve's result
+      if (!m_solved)
+	m_solution->putScalar(0.0);
+
       return m_solution->get1dView();
     }
 
     void NearestNeighborProblem::writeSystemMatrixMarket(std::string file_prefix)
     {
+      finishAssembly();
       std::string matrix_file = file_prefix + "_matrix.mm";
       std::string matrix_name = file_prefix + " system matrix";
     Tpetra::MatrixMarket::Writer<crs_matrix_type>::writeSparseFile( matrix_file, m_matrix, matrix_name, matrix_name );
@@ -33,7 +33,12 @@
 #include <Tpetra_Core.hpp>
 #include <Tpetra_CrsMatrix.hpp>
 
+#include <array>
+#include <limits>
+#include <vector>
+
 #include "triangulation.hpp"
+#include "timer.hpp"
 
 namespace math
 {
@@ -68,6 +73,21 @@ namespace math
       {
 	int numIters;
 	double residual;
+	bool recomputedPreconditioner; // false if the previous factorization was reused
+	double setupTime;              // preconditioner compute time (ms)
+	double solveTime;              // Krylov solve time (ms)
+      };
+
+      /*
+	Preconditioner and Krylov options. The defaults recompute an ILUT
+	factorization on every solve and start from a zero initial guess.
+      */
+      struct SolverOptions
+      {
+	std::string preconditioner = "ilut";  // ilut, riluk, jacobi, sgs, or none
+	int preconditioner_reuse = 1;         // recompute the preconditioner at least every this many solves
+	double reuse_iteration_growth = 2.0;  // ... or once iterations exceed this multiple of those right after the last compute
+	bool warm_start = false;              // use the previous solution as the initial guess
       };
 
       class NearestNeighborProblem
@@ -92,12 +112,56 @@ namespace math
 	RCP<prec_type> m_preconditioner;
 	RCP<problem_type> m_problem;
 
+	// Preconditioner reuse and warm start state
+	SolverOptions m_options;
+	int m_solves_since_compute;
+	int m_baseline_iters;
+	int m_last_iters;
+	bool m_solved; // false until Solve() after zeroSystem()
+
+	// Offsets into the local matrix values of each row's stencil entries, ordered
+	// self, lateral neighbors 0-2, above, below. Missing neighbors are m_no_entry.
+	// The graph is static so these are computed once on construction.
+	static constexpr size_t m_no_entry = std::numeric_limits<size_t>::max();
+	std::vector<std::array<size_t,6>> m_stencil_offsets;
+
+	// Host views of the matrix values and rhs held from zeroSystem() until the
+	// system is used, so rows can be written directly without going through Tpetra
+	crs_matrix_type::local_matrix_host_type m_local_matrix;
+	MV::dual_view_type::t_host m_local_rhs;
+	bool m_assembling;
+
+	// Releases the host views taken in zeroSystem()
+	void finishAssembly();
+
       public:
-	NearestNeighborProblem(mesh& domain, int nLayer=1);
+	/*
+	  Entries of one row of the nearest neighbor stencil. Contributions to a row are
+	  accumulated into this and then summed into the matrix with a single call.
+	  Entries for neighbors that do not exist are ignored.
+	*/
+	struct StencilRow
+	{
+	  double self = 0;
+	  double neighbor[3] = {0, 0, 0}; // lateral neighbors, in face->neighbor(i) order
+	  double above = 0;
+	  double below = 0;
+	};
+
+	NearestNeighborProblem(mesh& domain, int nLayer=1, const SolverOptions& options = SolverOptions());
 	~NearestNeighborProblem();
 
+	// Zeros the system and readies it for assembly
 	void zeroSystem();
 
+	// Local row of a face's element in the given layer
+	local_ordinal_type localRow(const mesh_elem& face, int layer=0) const;
+
+	// Sum a full stencil row into the matrix. Each row is owned by exactly one face, so
+	// concurrent calls for different rows need no locking.
+	void matrixSumIntoLocalRow(local_ordinal_type local_row, const StencilRow& row);
+	void rhsSumIntoLocalValue(local_ordinal_type local_row, double val);
+
 	void matrixReplaceGlobalValues(global_ordinal_type global_row_idx, global_ordinal_type global_col_idx, double val);
 	void matrixSumIntoGlobalValues(global_ordinal_type global_row_idx, global_ordinal_type global_col_idx, double val);
 
@@ -0,0 +1,555 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "mesh_h5_writer.hpp"
+#include "triangulation.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <unordered_map>
+
+namespace
+{
+    const char* xdmf_head = "<?xml version=\"1.0\" ?>\n"
+                            "<Xdmf Version=\"3.0\">\n"
+                            "<Domain>\n"
+                            "<Grid Name=\"mesh\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+
+    const char* xdmf_tail = "</Grid>\n"
+                            "</Domain>\n"
+                            "</Xdmf>\n";
+
+    // Writes this rank's block of a dataset. A rank with nothing to write still takes part in the collective call.
+    void write_block(hid_t dataset, hid_t dxpl, hid_t mem_type, int rank,
+                     const hsize_t* start, const hsize_t* count, const void* buf)
+    {
+        hid_t filespace = H5Dget_space(dataset);
+        hid_t memspace = H5Screate_simple(rank, count, nullptr);
+
+        hsize_t n = 1;
+        for (int i = 0; i < rank; i++)
+            n *= count[i];
+
+        if (n == 0)
+        {
+            H5Sselect_none(filespace);
+            H5Sselect_none(memspace);
+        }
+        else
+        {
+            H5Sselect_hyperslab(filespace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+        }
+
+        herr_t err = H5Dwrite(dataset, mem_type, memspace, filespace, dxpl, buf);
+
+        H5Sclose(memspace);
+        H5Sclose(filespace);
+
+        if (err < 0)
+        {
+            CHM_THROW_EXCEPTION(file_write_error, "Failed to write HDF5 dataset");
+        }
+    }
+
+    // Creates a chunked and optionally compressed dataset. If extendible, the first dimension starts at 0 and is unlimited
+    hid_t create_dataset(hid_t file, const std::string& name, hid_t type, int rank, const hsize_t* dims,
+                         bool extendible, int compression)
+    {
+        hsize_t cur[2], max[2], chunk[2];
+        for (int i = 0; i < rank; i++)
+        {
+            cur[i] = dims[i];
+            max[i] = dims[i];
+            chunk[i] = std::max<hsize_t>(1, std::min<hsize_t>(dims[i], 1 << 16));
+        }
+
+        if (extendible)
+        {
+            cur[0] = 0;
+            max[0] = H5S_UNLIMITED;
+            chunk[0] = 1;
+        }
+
+        hid_t space = H5Screate_simple(rank, cur, max);
+        hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+        H5Pset_chunk(dcpl, rank, chunk);
+        if (compression > 0)
+        {
+            H5Pset_shuffle(dcpl);
+            H5Pset_deflate(dcpl, compression);
+        }
+
+        hid_t lcpl = H5Pcreate(H5P_LINK_CREATE);
+        H5Pset_create_intermediate_group(lcpl, 1);
+
+        hid_t dataset = H5Dcreate2(file, name.c_str(), type, space, lcpl, dcpl, H5P_DEFAULT);
+
+        H5Pclose(lcpl);
+        H5Pclose(dcpl);
+        H5Sclose(space);
+
+        if (dataset < 0)
+        {
+            CHM_THROW_EXCEPTION(file_write_error, "Unable to create HDF5 dataset " + name);
+        }
+
+        return dataset;
+    }
+}
+
+mesh_h5_writer::mesh_h5_writer(triangulation* mesh,
+                               const std::string& base_name,
+                               std::vector<std::string> variables,
+                               bool write_parameters,
+                               int compression)
+    : _mesh(mesh),
+      _base_name(base_name),
+      _variables(variables),
+      _write_parameters(write_parameters),
+      _compression(compression),
+      _file(-1),
+      _dxpl(-1)
+{
+    if (_compression < 0 || _compression > 9)
+    {
+        CHM_THROW_EXCEPTION(config_error, "HDF5 mesh output compression must be in [0,9]");
+    }
+
+    if (_variables.empty())
+        _variables = _mesh->face_variables().variables();
+
+    for (auto& v : _variables)
+        _columns.push_back(_mesh->face_variables().column(v));
+
+    _nlocal = _mesh->size_faces();
+    _face_offset = 0;
+    _nfaces = _nlocal;
+    _is_root = true;
+
+#ifdef USE_MPI
+    _is_root = _comm_world.rank() == 0;
+#endif
+
+#if defined(USE_MPI) && defined(H5_HAVE_PARALLEL)
+    _shared_file = true;
+    _nfaces = boost::mpi::all_reduce(_comm_world, _nlocal, std::plus<hsize_t>());
+    _face_offset = boost::mpi::scan(_comm_world, _nlocal, std::plus<hsize_t>()) - _nlocal;
+#elif defined(USE_MPI)
+    _shared_file = _comm_world.size() == 1;
+    if (!_shared_file)
+    {
+        SPDLOG_WARN("HDF5 was not built with parallel support. Each rank will write its own HDF5 mesh output file");
+    }
+#else
+    _shared_file = true;
+#endif
+
+    create_file();
+    write_geometry();
+
+    for (auto& v : _variables)
+    {
+        hsize_t dims[2] = {0, _nfaces};
+        _datasets.push_back(create_dataset(_file, "/variables/" + v, H5T_IEEE_F32LE, 2, dims, true, _compression));
+    }
+
+    hsize_t tdims[1] = {0};
+    _datasets.push_back(create_dataset(_file, "/time", H5T_STD_U64LE, 1, tdims, true, 0));
+}
+
+mesh_h5_writer::~mesh_h5_writer()
+{
+    for (auto& d : _datasets)
+        H5Dclose(d);
+
+    if (_dxpl >= 0)
+        H5Pclose(_dxpl);
+
+    if (_file >= 0)
+        H5Fclose(_file);
+}
+
+void mesh_h5_writer::create_file()
+{
+    std::string fname = _base_name;
+#if defined(USE_MPI)
+    if (!_shared_file)
+        fname += "_" + std::to_string(_comm_world.rank());
+#endif
+    fname += ".h5";
+
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    _dxpl = H5Pcreate(H5P_DATASET_XFER);
+
+#if defined(USE_MPI) && defined(H5_HAVE_PARALLEL)
+    H5Pset_fapl_mpio(fapl, _comm_world, MPI_INFO_NULL);
+    H5Pset_dxpl_mpio(_dxpl, H5FD_MPIO_COLLECTIVE);
+#endif
+
+    _file = H5Fcreate(fname.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    H5Pclose(fapl);
+
+    if (_file < 0)
+    {
+        CHM_THROW_EXCEPTION(file_write_error, "Unable to create HDF5 mesh output " + fname);
+    }
+}
+
+void mesh_h5_writer::write_geometry()
+{
+    // Each rank writes the vertices of its own faces. Vertices on the partition boundaries are duplicated, which
+    // does not matter for visualization.
+    double scale = _mesh->is_geographic() ? 100000. : 1.;
+
+    std::unordered_map<int, int64_t> local_vertex;
+    std::vector<double> vertices;
+    std::vector<int64_t> elem(_nlocal * 3);
+    std::vector<int64_t> global_id(_nlocal);
+
+    for (size_t i = 0; i < _nlocal; i++)
+    {
+        auto f = _mesh->face(i);
+        global_id[i] = f->cell_global_id;
+
+        for (int j = 0; j < 3; j++)
+        {
+            auto v = f->vertex(j);
+            auto it = local_vertex.find(v->get_id());
+            if (it == local_vertex.end())
+            {
+                it = local_vertex.emplace(v->get_id(), local_vertex.size()).first;
+                vertices.push_back(v->point().x() * scale);
+                vertices.push_back(v->point().y() * scale);
+                vertices.push_back(v->point().z());
+            }
+            elem[i * 3 + j] = it->second;
+        }
+    }
+
+    hsize_t nvert_local = vertices.size() / 3;
+    hsize_t nvert = nvert_local;
+    hsize_t vert_offset = 0;
+
+#if defined(USE_MPI) && defined(H5_HAVE_PARALLEL)
+    nvert = boost::mpi::all_reduce(_comm_world, nvert_local, std::plus<hsize_t>());
+    vert_offset = boost::mpi::scan(_comm_world, nvert_local, std::plus<hsize_t>()) - nvert_local;
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < elem.size(); i++)
+        elem[i] += vert_offset;
+#endif
+
+    {
+        hsize_t dims[2] = {nvert, 3};
+        hid_t d = create_dataset(_file, "/geometry/vertex", H5T_IEEE_F64LE, 2, dims, false, _compression);
+        hsize_t start[2] = {vert_offset, 0};
+        hsize_t count[2] = {nvert_local, 3};
+        write_block(d, _dxpl, H5T_NATIVE_DOUBLE, 2, start, count, vertices.data());
+        H5Dclose(d);
+    }
+
+    {
+        hsize_t dims[2] = {_nfaces, 3};
+        hid_t d = create_dataset(_file, "/geometry/elem", H5T_STD_I64LE, 2, dims, false, _compression);
+        hsize_t start[2] = {_face_offset, 0};
+        hsize_t count[2] = {_nlocal, 3};
+        write_block(d, _dxpl, H5T_NATIVE_INT64, 2, start, count, elem.data());
+        H5Dclose(d);
+    }
+
+    {
+        hsize_t dims[1] = {_nfaces};
+        hid_t d = create_dataset(_file, "/geometry/global_id", H5T_STD_I64LE, 1, dims, false, _compression);
+        hsize_t start[1] = {_face_offset};
+        hsize_t count[1] = {_nlocal};
+        write_block(d, _dxpl, H5T_NATIVE_INT64, 1, start, count, global_id.data());
+        H5Dclose(d);
+    }
+
+    if (_write_parameters)
+    {
+        auto& g = _mesh->geometry();
+        std::vector<float> values(_nlocal);
+
+        auto to_float = [&](const std::vector<double>& src)
+        {
+            #pragma omp parallel for
+            for (size_t i = 0; i < _nlocal; i++)
+                values[i] = src[i];
+        };
+
+        to_float(g.z);      write_static("Elevation", values);
+        to_float(g.slope);  write_static("Slope", values);
+        to_float(g.aspect); write_static("Aspect", values);
+        to_float(g.area);   write_static("Area", values);
+
+        for (auto& p : _mesh->parameters())
+        {
+            #pragma omp parallel for
+            for (size_t i = 0; i < _nlocal; i++)
+            {
+                double d = _mesh->face(i)->parameter(p);
+                values[i] = d == -9999. ? std::nanf("") : static_cast<float>(d);
+            }
+            write_static(p, values);
+        }
+    }
+
+    // the sizes of every file are needed to build the XDMF on the root rank
+    std::string fname = boost::filesystem::path(_base_name).filename().string();
+    if (_shared_file)
+    {
+        _pieces.push_back({fname + ".h5", _nfaces, nvert});
+    }
+#ifdef USE_MPI
+    else
+    {
+        std::vector<hsize_t> nfaces, nverts;
+        boost::mpi::gather(_comm_world, _nlocal, nfaces, 0);
+        boost::mpi::gather(_comm_world, nvert_local, nverts, 0);
+
+        for (size_t r = 0; r < nfaces.size(); r++)
+            _pieces.push_back({fname + "_" + std::to_string(r) + ".h5", nfaces[r], nverts[r]});
+    }
+#endif
+}
+
+void mesh_h5_writer::write_static(const std::string& name, const std::vector<float>& values)
+{
+    hsize_t dims[1] = {_nfaces};
+    hid_t d = create_dataset(_file, "/static/" + name, H5T_IEEE_F32LE, 1, dims, false, _compression);
+    hsize_t start[1] = {_face_offset};
+    hsize_t count[1] = {_nlocal};
+    write_block(d, _dxpl, H5T_NATIVE_FLOAT, 1, start, count, values.data());
+    H5Dclose(d);
+
+    _static.push_back(name);
+}
+
+void mesh_h5_writer::write_timestep(uint64_t time)
+{
+    write(take_snapshot(time));
+}
+
+std::shared_ptr<mesh_h5_writer::snapshot> mesh_h5_writer::take_snapshot(uint64_t time)
+{
+    std::shared_ptr<snapshot> snap;
+    {
+        std::lock_guard<std::mutex> lock(_free_mutex);
+        if (!_free.empty())
+        {
+            snap = _free.back();
+            _free.pop_back();
+        }
+    }
+
+    if (!snap)
+    {
+        snap = std::make_shared<snapshot>();
+        snap->columns.resize(_variables.size(), std::vector<float>(_nlocal));
+    }
+
+    snap->time = time;
+
+    auto& store = _mesh->face_variables();
+    for (size_t k = 0; k < _variables.size(); k++)
+    {
+        const double* col = store.column_data(_columns[k]);
+        auto& out = snap->columns[k];
+
+        #pragma omp parallel for
+        for (size_t i = 0; i < _nlocal; i++)
+        {
+            double d = col[i];
+            out[i] = d == -9999. ? std::nanf("") : static_cast<float>(d);
+        }
+    }
+
+    return snap;
+}
+
+void mesh_h5_writer::write(const std::shared_ptr<snapshot>& snap)
+{
+    hsize_t t = _times.size();
+    _times.push_back(snap->time);
+
+    for (size_t k = 0; k < _variables.size(); k++)
+    {
+        hsize_t dims[2] = {t + 1, _nfaces};
+        H5Dset_extent(_datasets[k], dims);
+
+        hsize_t start[2] = {t, _face_offset};
+        hsize_t count[2] = {1, _nlocal};
+        write_block(_datasets[k], _dxpl, H5T_NATIVE_FLOAT, 2, start, count, snap->columns[k].data());
+    }
+
+    {
+        hid_t d = _datasets.back();
+        hsize_t dims[1] = {t + 1};
+        H5Dset_extent(d, dims);
+
+        // only one rank writes the time in a shared file
+        hsize_t start[1] = {t};
+        hsize_t count[1] = {(_is_root || !_shared_file) ? 1u : 0u};
+        write_block(d, _dxpl, H5T_NATIVE_UINT64, 1, start, count, &snap->time);
+    }
+
+    H5Fflush(_file, H5F_SCOPE_LOCAL);
+
+    if (_is_root)
+        append_xdmf(t);
+
+    std::lock_guard<std::mutex> lock(_free_mutex);
+    _free.push_back(snap);
+}
+
+bool mesh_h5_writer::thread_safe() const
+{
+    hbool_t ts = 0;
+    H5is_library_threadsafe(&ts);
+    if (!ts)
+        return false;
+
+#if defined(USE_MPI) && defined(H5_HAVE_PARALLEL)
+    if (_shared_file && boost::mpi::environment::thread_level() != boost::mpi::threading::multiple)
+        return false;
+#endif
+
+    return true;
+}
+
+size_t mesh_h5_writer::timesteps() const
+{
+    return _times.size();
+}
+
+void mesh_h5_writer::end()
+{
+    if (!_is_root)
+        return;
+
+    if (_xdmf.is_open())
+        _xdmf.close();
+
+    write_xdmf();
+}
+
+void mesh_h5_writer::append_xdmf(size_t t)
+{
+    // Only the new timestep and the closing tags are written so that the file is always valid if the run stops,
+    // without rewriting every earlier timestep each output
+    if (!_xdmf.is_open())
+    {
+        _xdmf.open(_base_name + ".xdmf", std::ios::trunc);
+        _xdmf << xdmf_head;
+        _xdmf_tail = _xdmf.tellp();
+    }
+
+    _xdmf.seekp(_xdmf_tail);
+    write_xdmf_step(_xdmf, t, t + 1);
+    _xdmf_tail = _xdmf.tellp();
+    _xdmf << xdmf_tail;
+    _xdmf.flush();
+
+    if (!_xdmf)
+    {
+        CHM_THROW_EXCEPTION(file_write_error, "Unable to write " + _base_name + ".xdmf");
+    }
+}
+
+void mesh_h5_writer::write_xdmf()
+{
+    std::ofstream out(_base_name + ".xdmf", std::ios::trunc);
+    if (!out)
+    {
+        CHM_THROW_EXCEPTION(file_write_error, "Unable to write " + _base_name + ".xdmf");
+    }
+
+    size_t nt = _times.size();
+
+    out << xdmf_head;
+    for (size_t t = 0; t < nt; t++)
+        write_xdmf_step(out, t, nt);
+    out << xdmf_tail;
+}
+
+void mesh_h5_writer::write_xdmf_step(std::ostream& out, size_t t, size_t nt)
+{
+    bool collection = _pieces.size() > 1;
+    if (collection)
+        out << "<Grid Name=\"step\" GridType=\"Collection\" CollectionType=\"Spatial\">\n"
+            << "<Time Value=\"" << _times[t] << "\"/>\n";
+
+    for (size_t p = 0; p < _pieces.size(); p++)
+    {
+        auto& piece = _pieces[p];
+        auto nf = std::to_string(piece.nfaces);
+
+        out << "<Grid Name=\"part" << p << "\" GridType=\"Uniform\">\n";
+        if (!collection)
+            out << "<Time Value=\"" << _times[t] << "\"/>\n";
+
+        out << "<Topology TopologyType=\"Triangle\" NumberOfElements=\"" << nf << "\">\n"
+            << "<DataItem Dimensions=\"" << nf << " 3\" NumberType=\"Int\" Precision=\"8\" Format=\"HDF\">"
+            << piece.file << ":/geometry/elem</DataItem>\n"
+            << "</Topology>\n"
+            << "<Geometry GeometryType=\"XYZ\">\n"
+            << "<DataItem Dimensions=\"" << piece.nvertices << " 3\" NumberType=\"Float\" Precision=\"8\" Format=\"HDF\">"
+            << piece.file << ":/geometry/vertex</DataItem>\n"
+            << "</Geometry>\n";
+
+        out << "<Attribute Name=\"global_id\" AttributeType=\"Scalar\" Center=\"Cell\">\n"
+            << "<DataItem Dimensions=\"" << nf << "\" NumberType=\"Int\" Precision=\"8\" Format=\"HDF\">"
+            << piece.file << ":/geometry/global_id</DataItem>\n"
+            << "</Attribute>\n";
+
+        for (auto& s : _static)
+        {
+            bool is_geom = s == "Elevation" || s == "Slope" || s == "Aspect" || s == "Area";
+            out << "<Attribute Name=\"" << (is_geom ? s : "[param] " + s) << "\" AttributeType=\"Scalar\" Center=\"Cell\">\n"
+                << "<DataItem Dimensions=\"" << nf << "\" NumberType=\"Float\" Precision=\"4\" Format=\"HDF\">"
+                << piece.file << ":/static/" << s << "</DataItem>\n"
+                << "</Attribute>\n";
+        }
+
+        for (auto& v : _variables)
+        {
+            out << "<Attribute Name=\"" << v << "\" AttributeType=\"Scalar\" Center=\"Cell\">\n"
+                << "<DataItem ItemType=\"HyperSlab\" Dimensions=\"1 " << nf << "\">\n"
+                << "<DataItem Dimensions=\"3 2\" Format=\"XML\">" << t << " 0 1 1 1 " << nf << "</DataItem>\n"
+                << "<DataItem Dimensions=\"" << nt << " " << nf << "\" NumberType=\"Float\" Precision=\"4\" Format=\"HDF\">"
+                << piece.file << ":/variables/" << v << "</DataItem>\n"
+                << "</DataItem>\n"
+                << "</Attribute>\n";
+        }
+
+        out << "</Grid>\n";
+    }
+
+    if (collection)
+        out << "</Grid>\n";
+}
@@ -0,0 +1,160 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include "H5Cpp.h"
+
+#ifdef USE_MPI
+#include <boost/mpi.hpp>
+#endif
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <fstream>
+
+class triangulation;
+
+/**
+ * Writes the mesh and its face variables to a single HDF5 file with an XDMF sidecar so that it can be opened
+ * in Paraview. This is an alternative to the per-timestep vtu files.
+ *
+ * The geometry (vertices, triangles, global ids and optionally the parameters) is written once. Each output
+ * variable is a 2D (timestep, face) dataset that grows by one row per output timestep. Rows are chunked and
+ * compressed.
+ *
+ * With MPI, if HDF5 was built with parallel support, all the ranks write their faces into the same file with
+ * collective MPI-IO writes. Otherwise each rank writes its own file and the XDMF sidecar stitches them together.
+ *
+ * The HDF5 C API is used here as the C++ API does not expose the MPI-IO file driver.
+ */
+class mesh_h5_writer
+{
+  public:
+    /// Creates the HDF5 file and writes the geometry
+    /// @param mesh
+    /// @param base_name Path and name without extension. base_name.h5 and base_name.xdmf are created
+    /// @param variables Face variables to write. If empty, all the face variables are written
+    /// @param write_parameters Write the parameters, elevation, slope, aspect and area once with the geometry
+    /// @param compression Deflate level [0-9], 0 disables compression
+    mesh_h5_writer(triangulation* mesh,
+                   const std::string& base_name,
+                   std::vector<std::string> variables,
+                   bool write_parameters,
+                   int compression = 4);
+    ~mesh_h5_writer();
+
+    /// A copy of the output variables at one timestep
+    struct snapshot
+    {
+        uint64_t time;
+        std::vector< std::vector<float> > columns;
+    };
+
+    /// Appends the current value of every output variable as a new timestep and appends it to the XDMF sidecar.
+    /// Collective over all ranks.
+    /// @param time Time of this timestep in seconds since epoch
+    void write_timestep(uint64_t time);
+
+    /// Copies the current value of every output variable so that it can be written later by write(),
+    /// e.g., from an async_writer. Snapshot buffers are reused once written.
+    /// @param time Time of this timestep in seconds since epoch
+    /// @return
+    std::shared_ptr<snapshot> take_snapshot(uint64_t time);
+
+    /// Appends a snapshot as a new timestep and appends it to the XDMF sidecar. Collective over all ranks.
+    /// Snapshots must be written in the order they were taken.
+    /// @param snap
+    void write(const std::shared_ptr<snapshot>& snap);
+
+    /// True if write() may be called from a thread other than the one running the model. This requires a
+    /// thread-safe HDF5 and, if MPI-IO is used, MPI initialized with MPI_THREAD_MULTIPLE.
+    /// @return
+    bool thread_safe() const;
+
+    /// Number of timesteps written so far
+    /// @return
+    size_t timesteps() const;
+
+    /// Rewrites the XDMF sidecar once with the final number of timesteps. During the run each timestep is only
+    /// appended to the sidecar, so its hyperslabs describe the variable datasets as they were when it was written.
+    /// Call once after the last write().
+    void end();
+
+  private:
+    void create_file();
+    void write_geometry();
+    void write_static(const std::string& name, const std::vector<float>& values);
+    void write_xdmf();
+    void append_xdmf(size_t t);
+    void write_xdmf_step(std::ostream& out, size_t t, size_t nt);
+
+    // a file holding a contiguous block of faces, used to build the XDMF
+    struct piece
+    {
+        std::string file;
+        uint64_t nfaces;
+        uint64_t nvertices;
+    };
+
+    triangulation* _mesh;
+    std::string _base_name;
+    std::vector<std::string> _variables;
+    std::vector<size_t> _columns;
+    std::vector<std::string> _static;
+    bool _write_parameters;
+    int _compression;
+
+    // all ranks write into one file
+    bool _shared_file;
+
+    hid_t _file;
+    hid_t _dxpl;
+    std::vector<hid_t> _datasets;
+
+    // this rank's faces are [_face_offset, _face_offset + _nlocal) of the _nfaces in the file
+    hsize_t _nlocal;
+    hsize_t _face_offset;
+    hsize_t _nfaces;
+
+    std::vector<piece> _pieces;
+    std::vector<uint64_t> _times;
+
+    // XDMF sidecar being appended to, and the offset of its closing tags
+    std::ofstream _xdmf;
+    std::streampos _xdmf_tail;
+
+    // written snapshots available for reuse
+    std::vector< std::shared_ptr<snapshot> > _free;
+    std::mutex _free_mutex;
+
+    bool _is_root;
+
+#ifdef USE_MPI
+    boost::mpi::communicator _comm_world;
+#endif
+};
@@ -16,6 +16,7 @@
 
 
 #include "triangulation.hpp"
+#include "timer.hpp"
 
 triangulation::triangulation()
 {
@@ -66,13 +67,33 @@ triangulation::triangulation()
     geographic_dims=1;
     partition_dims=1;
 
+#ifdef USE_MPI
+    _pending_exchange = nullptr;
+    _pending_to_ghosts = true;
+#endif
 }
 
 
 
 triangulation::~triangulation()
 {
+#ifdef USE_MPI
+    // Freeing a request after MPI_Finalize is undefined. core releases the mesh before then, but another owner could
+    // keep it alive past finalize, in which case MPI has already released the requests
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (finalized)
+        return;
 
+    for (auto& itr : _halo_exchanges)
+    {
+        for (auto& r : itr.second.requests)
+        {
+            if(r != MPI_REQUEST_NULL)
+                MPI_Request_free(&r);
+        }
+    }
+#endif
 }
 
 std::string triangulation::proj4()
@@ -495,19 +516,7 @@ void triangulation::from_json(pt::ptree &mesh)
 
     _build_dDtree();
 
-
-#pragma omp parallel for
-    for (size_t i = 0; i < _faces.size(); i++)
-    {
-        auto f = _faces.at(i); // ensure we access like this as json mode is generally non MPI unless we are partitioning
-        //init these
-        f->slope();
-        f->aspect();
-        f->center();
-        f->normal();
-    }
-
-
+    compute_face_geometry();
 }
 
 void triangulation::to_hdf5(std::string filename_base)
@@ -1226,6 +1235,8 @@ void triangulation::from_hdf5(const std::string& mesh_filename,
 
     _build_dDtree();
 
+    compute_face_geometry();
+
     // load param
     if(!delay_param_ic_load)
         load_hdf5_parameters(param_filenames);
@@ -1379,6 +1390,10 @@ void triangulation::load_hdf5_parameters( const std::vector<std::string>& param_
 
     } // end of param_filenames loop
 
+    // the area parameter takes precedence over the computed area
+    if(_parameters.find("area") != _parameters.end())
+        compute_face_geometry();
+
 }
 
 void triangulation::reorder_faces(std::vector<size_t> permutation)
@@ -1773,7 +1788,7 @@ void triangulation::determine_process_ghost_faces_nearest_neighbors()
 // - unique id for proc m communicating with proc p
 // - tags will be unique for up to 9999 MPI processes
 // - message between m and p must be completed before a new one started
-// - this is ensured with mpi::wait_all, as in ghost_neighbors_communicate_variable
+// - this is ensured with MPI_Waitall on both the sends and recvs, as in halo_communicate
 int generate_unique_send_tag(int my_rank, int partner_rank){
   return 10000*my_rank + partner_rank;
 }
@@ -1940,6 +1955,10 @@ void triangulation::setup_nearest_neighbor_communication()
   // _comm_world.barrier();
   // exit(0);
 
+  // single variable exchanges are by far the most common, so have them ready
+  get_halo_exchange(true, 1);
+  get_halo_exchange(false, 1);
+
 #endif // USE_MPI
 
 }
@@ -1975,216 +1994,257 @@ void triangulation::ghost_neighbors_communicate_variable(const std::string& var)
 
 void triangulation::ghost_neighbors_communicate_variable(const uint64_t& var)
 {
+    ghost_neighbors_communicate_variables(std::vector<uint64_t>{var});
+}
 
-// Function is meaningful only when using MPI
-#ifdef USE_MPI
+void triangulation::ghost_to_neighbors_communicate_variable(const std::string& var)
+{
+    // This supports the use case if _s no-oped to const char * via
+    uint64_t hash = xxh64::hash (var.c_str(), var.length());
+    ghost_to_neighbors_communicate_variable(hash);
+}
 
-  // For each communication partner:
-  // - pack vectors of the variable to send
-  // - send/recv it
-  // - unpack the recv'd vectors into mesh_elem->face_data (so it can be used exactly as local info)
+void triangulation::ghost_to_neighbors_communicate_variable(const uint64_t& var)
+{
+    ghost_to_neighbors_communicate_variables(std::vector<uint64_t>{var});
+}
 
-  std::vector<boost::mpi::request> reqs;
+void triangulation::ghost_neighbors_communicate_variables(const std::vector<std::string>& vars)
+{
+    std::vector<uint64_t> hashes;
+    for (auto& v : vars)
+        hashes.push_back(xxh64::hash (v.c_str(), v.length()));
 
-  for(auto it : local_faces_to_send) {
-    auto partner_id = it.first;
-    auto faces = it.second;
-    std::vector<double> send_buffer(faces.size());
-    std::transform(faces.begin(), faces.end(),
-		   send_buffer.begin(),
-		   [var](mesh_elem e){
-		     return (*e)[var]; });
-
-    for(int i=0; i < send_buffer.size(); ++i) {
-      double val = send_buffer[i];
-      if( isnan(val) )	{
-	  auto f = local_faces_to_send[partner_id][i];
-	  SPDLOG_DEBUG("-------------------------------------------------");
-	  SPDLOG_DEBUG("Detected SEND variable is NaN:");
-	  SPDLOG_DEBUG("\tmy rank:            {}",f->owner);
-	  SPDLOG_DEBUG("\tdestination rank:  {}",partner_id);
-	  SPDLOG_DEBUG("\tsend_buffer entry: {}",i);
-	  SPDLOG_DEBUG("\tcell_global_id:    {}",f->cell_global_id);
-	  SPDLOG_DEBUG("\tcell_local_id:      {}",f->cell_local_id);
-          SPDLOG_DEBUG("\tvalue:       {}",val);
-//	  _mpi_env.abort(-1);
-	}
-    }
+    ghost_neighbors_communicate_variables(hashes);
+}
 
+void triangulation::ghost_neighbors_communicate_variables(const std::vector<uint64_t>& vars)
+{
+#ifdef USE_MPI
+    halo_communicate(true, vars);
+#endif
+}
 
-    // Send variables
-    int send_tag = generate_unique_send_tag(_comm_world.rank(), partner_id);
-    _comm_world.isend(partner_id, send_tag, send_buffer);
+void triangulation::ghost_to_neighbors_communicate_variables(const std::vector<std::string>& vars)
+{
+    std::vector<uint64_t> hashes;
+    for (auto& v : vars)
+        hashes.push_back(xxh64::hash (v.c_str(), v.length()));
 
-  }
+    ghost_to_neighbors_communicate_variables(hashes);
+}
 
-  // map of received data from comm partners
-  std::map< int, std::vector<double>> recv_buffer;
-  for( auto it : ghost_faces_to_recv) {
-    auto partner_id = it.first;
-    auto faces = it.second;
-    recv_buffer[partner_id] = std::vector<double>(faces.size(),0.0);
-  }
+void triangulation::ghost_to_neighbors_communicate_variables(const std::vector<uint64_t>& vars)
+{
+#ifdef USE_MPI
+    halo_communicate(false, vars);
+#endif
+}
 
-  for(auto it : ghost_faces_to_recv) {
-    auto partner_id = it.first;
+void triangulation::begin_exchange(const std::vector<std::string>& vars)
+{
+    std::vector<uint64_t> hashes;
+    for (auto& v : vars)
+        hashes.push_back(xxh64::hash (v.c_str(), v.length()));
 
-    // Note only recv gets added to the list of requests to watch for
-    int recv_tag = generate_unique_recv_tag(_comm_world.rank(), partner_id);
-    reqs.push_back(_comm_world.irecv(partner_id, recv_tag, recv_buffer[partner_id] ));
-  }
+    begin_exchange(hashes);
+}
 
-  // Wait for all communication to me before proceeding
-  boost::mpi::wait_all(reqs.begin(), reqs.end());
+void triangulation::begin_exchange(const std::vector<uint64_t>& vars)
+{
+#ifdef USE_MPI
+    halo_begin(true, vars);
+#endif
+}
 
-  // Check for NaN entries in recv_buffer
-  for(auto it : recv_buffer) {
-    auto partner_id = it.first;
-    auto values = it.second;
-    for(int i=0; i < values.size(); ++i) {
-      double val = values[i];
-      if( isnan(val) )	{
-	auto f = ghost_faces_to_recv[partner_id][i];
-	  SPDLOG_DEBUG("-------------------------------------------------");
-	  SPDLOG_DEBUG("Detected RECV variable is NaN:");
-	  SPDLOG_DEBUG("\tmy rank:            {}",f->owner);
-	  SPDLOG_DEBUG("\tsent from rank:     {}",partner_id);
-	  SPDLOG_DEBUG("\trecv_buffer entry:  {}",i);
-	  SPDLOG_DEBUG("\tcell_global_id:     {}",f->cell_global_id);
-	  SPDLOG_DEBUG("\tcell_local_id:       {}",f->cell_local_id);
-          SPDLOG_DEBUG("\tvalue:       {}",val);
-//	  _mpi_env.abort(-1);
-	}
-    }
+void triangulation::end_exchange()
+{
+#ifdef USE_MPI
+    halo_end();
+#endif
+}
 
-  }
+void triangulation::determine_interior_faces()
+{
+    _interior_faces.clear();
+    _halo_faces.clear();
 
-  // Pack the data into the face pointers
-  for(auto it : ghost_faces_to_recv) {
-    auto partner_id = it.first;
-    auto faces = it.second;
+    for (size_t i = 0; i < size_faces(); i++)
+    {
+        auto f = face(i);
 
-    auto recv_it = recv_buffer[partner_id].begin();
-    for (auto f : faces ) {
+        bool has_ghost = false;
+        for (int j = 0; j < 3; j++)
+        {
+            auto neigh = f->neighbor(j);
+            if(neigh != nullptr && neigh->is_ghost)
+                has_ghost = true;
+        }
 
-      (*f)[var] = *recv_it;
-//      LOG_DEBUG << "Rank=" <<f->owner << " Var="<<var<<" *f="<<(*f)[var]<< " recv_it="<<*recv_it << " is_ghost="<<f->is_ghost;
-      ++recv_it;
+        if(has_ghost)
+            _halo_faces.push_back(i);
+        else
+            _interior_faces.push_back(i);
     }
+}
 
-  }
-
-#endif // USE_MPI
+const std::vector<size_t>& triangulation::interior_faces()
+{
+    if(_interior_faces.size() + _halo_faces.size() != size_faces())
+        determine_interior_faces();
 
+    return _interior_faces;
 }
 
-void triangulation::ghost_to_neighbors_communicate_variable(const std::string& var)
+const std::vector<size_t>& triangulation::halo_faces()
 {
-    // This supports the use case if _s no-oped to const char * via
-    uint64_t hash = xxh64::hash (var.c_str(), var.length());
-    ghost_to_neighbors_communicate_variable(hash);
+    if(_interior_faces.size() + _halo_faces.size() != size_faces())
+        determine_interior_faces();
+
+    return _halo_faces;
 }
 
-void triangulation::ghost_to_neighbors_communicate_variable(const uint64_t& var)
+#ifdef USE_MPI
+triangulation::halo_exchange& triangulation::get_halo_exchange(bool to_ghosts, size_t nvars)
 {
+    auto key = std::make_pair(to_ghosts, nvars);
+    auto itr = _halo_exchanges.find(key);
+    if(itr != _halo_exchanges.end())
+        return itr->second;
 
-// Function is meaningful only when using MPI
-#ifdef USE_MPI
+    auto& ex = _halo_exchanges[key];
 
-    // For each communication partner:
-    // - pack vectors of the variable to send
-    // - send/recv it
-    // - unpack the recv'd vectors into mesh_elem->face_data (so it can be used exactly as local info)
-
-    std::vector<boost::mpi::request> reqs;
-
-    for(auto it : ghost_faces_to_recv) {
-        auto partner_id = it.first;
-        auto faces = it.second;
-        std::vector<double> send_buffer(faces.size());
-        std::transform(faces.begin(), faces.end(),
-                       send_buffer.begin(),
-                       [var](mesh_elem e){
-                           return (*e)[var]; });
-
-        for(int i=0; i < send_buffer.size(); ++i) {
-            double val = send_buffer[i];
-            if( isnan(val) )	{
-                auto f = ghost_faces_to_recv[partner_id][i];
-                SPDLOG_DEBUG("-------------------------------------------------");
-                SPDLOG_DEBUG("Detected SEND variable is NaN:");
-                SPDLOG_DEBUG("\tmy rank:            {}",f->owner);
-                SPDLOG_DEBUG("\tdestination rank:  {}",partner_id);
-                SPDLOG_DEBUG("\tsend_buffer entry: {}",i);
-                SPDLOG_DEBUG("\tcell_global_id:    {}",f->cell_global_id);
-                SPDLOG_DEBUG("\tcell_local_id:      {}",f->cell_local_id);
-                //	  _mpi_env.abort(-1);
-            }
-        }
+    // owned faces are sent to the ghosts on the partner, or the reverse
+    auto& send_faces = to_ghosts ? local_faces_to_send : ghost_faces_to_recv;
+    auto& recv_faces = to_ghosts ? ghost_faces_to_recv : local_faces_to_send;
+
+    // the buffers are sized once here and never resized, as the persistent requests hold pointers into them
+    for (auto& it : send_faces)
+    {
+        ex.send_partners.push_back(it.first);
+        ex.send_buffers.emplace_back(it.second.size() * nvars, 0.0);
+    }
+    for (auto& it : recv_faces)
+    {
+        ex.recv_partners.push_back(it.first);
+        ex.recv_buffers.emplace_back(it.second.size() * nvars, 0.0);
+    }
 
+    MPI_Comm comm = _comm_world;
+    int rank = _comm_world.rank();
 
-        // Send variables
-        int send_tag = generate_unique_send_tag(_comm_world.rank(), partner_id);
-        _comm_world.isend(partner_id, send_tag, send_buffer);
+    ex.requests.resize(ex.send_partners.size() + ex.recv_partners.size(), MPI_REQUEST_NULL);
 
+    for (size_t p = 0; p < ex.send_partners.size(); p++)
+    {
+        int send_tag = generate_unique_send_tag(rank, ex.send_partners[p]);
+        MPI_Send_init(ex.send_buffers[p].data(), static_cast<int>(ex.send_buffers[p].size()), MPI_DOUBLE,
+                      ex.send_partners[p], send_tag, comm, &ex.requests[p]);
     }
 
-    // map of received data from comm partners
-    std::map< int, std::vector<double>> recv_buffer;
-    for( auto it : local_faces_to_send) {
-        auto partner_id = it.first;
-        auto faces = it.second;
-        recv_buffer[partner_id] = std::vector<double>(faces.size(),0.0);
+    for (size_t p = 0; p < ex.recv_partners.size(); p++)
+    {
+        // Note: opposite constants from send tags
+        int recv_tag = generate_unique_recv_tag(rank, ex.recv_partners[p]);
+        MPI_Recv_init(ex.recv_buffers[p].data(), static_cast<int>(ex.recv_buffers[p].size()), MPI_DOUBLE,
+                      ex.recv_partners[p], recv_tag, comm, &ex.requests[ex.send_partners.size() + p]);
     }
 
-    for(auto it : local_faces_to_send) {
-        auto partner_id = it.first;
+    SPDLOG_DEBUG("MPI Process {} created halo exchange for {} variable(s) {} the ghosts", rank, nvars,
+                 to_ghosts ? "to" : "from");
+
+    return ex;
+}
+
+void triangulation::halo_communicate(bool to_ghosts, const std::vector<uint64_t>& vars)
+{
+    halo_begin(to_ghosts, vars);
+    halo_end();
+}
 
-        // Note only recv gets added to the list of requests to watch for
-        int recv_tag = generate_unique_recv_tag(_comm_world.rank(), partner_id);
-        reqs.push_back(_comm_world.irecv(partner_id, recv_tag, recv_buffer[partner_id] ));
+void triangulation::halo_begin(bool to_ghosts, const std::vector<uint64_t>& vars)
+{
+    if(_pending_exchange)
+    {
+        CHM_THROW_EXCEPTION(mesh_error, "A halo exchange is already in progress");
     }
 
-    // Wait for all communication to me before proceeding
-    boost::mpi::wait_all(reqs.begin(), reqs.end());
+    if(vars.empty())
+        return;
 
-    // Check for NaN entries in recv_buffer
-    for(auto it : recv_buffer) {
-        auto partner_id = it.first;
-        auto values = it.second;
-        for(int i=0; i < values.size(); ++i) {
-            double val = values[i];
-            if( isnan(val) )	{
-                auto f = local_faces_to_send[partner_id][i];
-                SPDLOG_DEBUG("-------------------------------------------------");
-                SPDLOG_DEBUG("Detected RECV variable is NaN:");
-                SPDLOG_DEBUG("\tmy rank:            {}",f->owner);
-                SPDLOG_DEBUG("\tsent from rank:     {}",partner_id);
-                SPDLOG_DEBUG("\trecv_buffer entry:  {}",i);
-                SPDLOG_DEBUG("\tcell_global_id:     {}",f->cell_global_id);
-                SPDLOG_DEBUG("\tcell_local_id:       {}",f->cell_local_id);
-                //	  _mpi_env.abort(-1);
+    auto& send_faces = to_ghosts ? local_faces_to_send : ghost_faces_to_recv;
+
+    auto& ex = get_halo_exchange(to_ghosts, vars.size());
+
+    _pending_handles.resize(vars.size());
+    for (size_t v = 0; v < vars.size(); v++)
+        _pending_handles[v].column = _face_variables.column(vars[v]);
+
+    // pack the send buffers, variable by variable
+    for (size_t p = 0; p < ex.send_partners.size(); p++)
+    {
+        auto& faces = send_faces.at(ex.send_partners[p]);
+        auto& buffer = ex.send_buffers[p];
+        size_t n = faces.size();
+
+        for (size_t v = 0; v < _pending_handles.size(); v++)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                buffer[v * n + i] = faces[i]->get(_pending_handles[v]);
             }
         }
-
     }
 
-    // Pack the data into the face pointers
-    for(auto it : local_faces_to_send) {
-        auto partner_id = it.first;
-        auto faces = it.second;
+    MPI_Startall(static_cast<int>(ex.requests.size()), ex.requests.data());
 
-        auto recv_it = recv_buffer[partner_id].begin();
-        for (auto f : faces ) {
-            (*f)[var] = *recv_it;
-            ++recv_it;
-        }
+    _pending_exchange = &ex;
+    _pending_to_ghosts = to_ghosts;
+}
 
-    }
+void triangulation::halo_end()
+{
+    if(!_pending_exchange)
+        return;
 
-#endif // USE_MPI
+    auto& ex = *_pending_exchange;
+    auto& recv_faces = _pending_to_ghosts ? ghost_faces_to_recv : local_faces_to_send;
+
+    // Wait for all the sends and recvs so the buffers can be reused by the next exchange
+    MPI_Waitall(static_cast<int>(ex.requests.size()), ex.requests.data(), MPI_STATUSES_IGNORE);
+    _pending_exchange = nullptr;
 
+    // unpack into the faces so it can be used exactly as local info
+    for (size_t p = 0; p < ex.recv_partners.size(); p++)
+    {
+        auto& faces = recv_faces.at(ex.recv_partners[p]);
+        auto& buffer = ex.recv_buffers[p];
+        size_t n = faces.size();
+
+        for (size_t v = 0; v < _pending_handles.size(); v++)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                double val = buffer[v * n + i];
+#ifdef SAFE_CHECKS
+                if( std::isnan(val) )
+                {
+                    auto f = faces[i];
+                    SPDLOG_DEBUG("-------------------------------------------------");
+                    SPDLOG_DEBUG("Detected RECV variable is NaN:");
+                    SPDLOG_DEBUG("\tmy rank:            {}",f->owner);
+                    SPDLOG_DEBUG("\tsent from rank:     {}",ex.recv_partners[p]);
+                    SPDLOG_DEBUG("\trecv_buffer entry:  {}",v * n + i);
+                    SPDLOG_DEBUG("\tcell_global_id:     {}",f->cell_global_id);
+                    SPDLOG_DEBUG("\tcell_local_id:       {}",f->cell_local_id);
+                }
+#endif
+                faces[i]->get(_pending_handles[v]) = val;
+            }
+        }
+    }
 }
+#endif // USE_MPI
 
 void dfs_to_max_distance_aux(mesh_elem starting_face, double max_distance, mesh_elem face, std::unordered_set<mesh_elem> &visited)
 {
@@ -2486,13 +2546,304 @@ void triangulation::init_vtkUnstructured_Grid(std::vector<std::string> output_va
 
 void triangulation::init_timeseries(std::set< std::string > variables)
 {
+    size_t nlocal = size_faces();
+    _face_variables.init(variables, nlocal + _ghost_faces.size());
+
     #pragma omp parallel for
-    for (size_t it = 0; it < size_faces(); it++)
+    for (size_t it = 0; it < nlocal; it++)
     {
         auto face = this->face(it);
-        face->init_time_series(variables);
+        face->attach_time_series(&_face_variables, it);
     }
 
+    #pragma omp parallel for
+    for (size_t it = 0; it < _ghost_faces.size(); it++)
+    {
+        auto face = _ghost_faces.at(it);
+        face->attach_time_series(&_face_variables, nlocal + it);
+    }
+
+}
+
+columnstorage<double>& triangulation::face_variables()
+{
+    return _face_variables;
+}
+
+void triangulation::compute_face_geometry()
+{
+    size_t nlocal = size_faces();
+    _face_geometry.resize(nlocal + _ghost_faces.size());
+
+    #pragma omp parallel for
+    for (size_t it = 0; it < nlocal; it++)
+    {
+        this->face(it)->compute_geometry(_face_geometry, it);
+    }
+
+    #pragma omp parallel for
+    for (size_t it = 0; it < _ghost_faces.size(); it++)
+    {
+        _ghost_faces.at(it)->compute_geometry(_face_geometry, nlocal + it);
+    }
+}
+
+void triangulation::update_face_geometry()
+{
+    size_t nlocal = size_faces();
+    if (_face_geometry.size() != nlocal + _ghost_faces.size())
+    {
+        CHM_THROW_EXCEPTION(mesh_error, "Face geometry has not been computed for the current set of faces");
+    }
+
+    #pragma omp parallel for
+    for (size_t it = 0; it < nlocal; it++)
+    {
+        this->face(it)->compute_geometry(_face_geometry, it);
+    }
+
+    #pragma omp parallel for
+    for (size_t it = 0; it < _ghost_faces.size(); it++)
+    {
+        _ghost_faces.at(it)->compute_geometry(_face_geometry, nlocal + it);
+    }
+}
+
+const face_geometry& triangulation::geometry() const
+{
+    return _face_geometry;
+}
+
+station_set_table& triangulation::station_sets()
+{
+    return _station_sets;
+}
+
+const azimuth_table& triangulation::horizon(size_t bins, int steps, double max_distance)
+{
+    std::lock_guard<std::mutex> lock(_horizons_mutex);
+
+    auto& table = _horizons[std::make_tuple(bins, steps, max_distance)];
+    if (table)
+        return *table;
+
+    timer c;
+    c.tic();
+
+    table = std::make_unique<azimuth_table>();
+    table->init(size_faces(), bins);
+
+    double size_of_step = max_distance / steps;
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < size_faces(); i++)
+    {
+        auto face = this->face(i);
+        Point_3 me = face->center();
+
+        for (size_t k = 0; k < bins; k++)
+        {
+            double phi = 0.;
+
+            // search along each azimuth in j step increments to find horizon angle
+            for (int j = 1; j <= steps; ++j)
+            {
+                double distance = j * size_of_step;
+
+                auto f = find_closest_face(math::gis::point_from_bearing(me, table->bin_azimuth(k), distance));
+
+                double z_diff = (f->center().z() - me.z());
+                if (z_diff > 0)
+                {
+                    double dist = math::gis::distance(f->center(), me);
+                    phi = std::max(atan(z_diff / dist), phi);
+                }
+            }
+
+            (*table)(i, k) = phi;
+        }
+    }
+
+    SPDLOG_DEBUG("Computed terrain horizon for {} azimuths, {} steps to {} m in {} s", bins, steps, max_distance, c.toc<s>());
+
+    return *table;
+}
+
+void azimuth_table::init(size_t rows, size_t bins)
+{
+    _bins = bins;
+    _values.assign(rows * bins, 0.f);
+}
+
+double azimuth_table::at(size_t row, double azimuth) const
+{
+    double b = azimuth / 360. * _bins;
+    double lower = std::floor(b);
+    double t = b - lower;
+
+    // wrap into [0, bins), which also handles negative and >= 360 azimuths
+    long n = static_cast<long>(_bins);
+    size_t k0 = static_cast<size_t>(((static_cast<long>(lower) % n) + n) % n);
+    size_t k1 = (k0 + 1) % _bins;
+
+    const float* v = _values.data() + row * _bins;
+    return (1. - t) * v[k0] + t * v[k1];
+}
+
+double azimuth_table::bin_azimuth(size_t bin) const
+{
+    return bin * 360. / _bins;
+}
+
+size_t azimuth_table::bins() const
+{
+    return _bins;
+}
+
+size_t azimuth_table::rows() const
+{
+    return _bins == 0 ? 0 : _values.size() / _bins;
+}
+
+void direction_library::init(size_t rows, size_t directions, size_t components)
+{
+    _directions = directions;
+    _components = components;
+    _values.assign(rows * directions * components, 0.f);
+}
+
+void direction_library::load(triangulation& domain, const std::vector< std::vector<std::string> >& names)
+{
+    size_t components = names.empty() ? 0 : names.front().size();
+
+    // resolve the names once, all faces share the same set of parameters
+    std::vector<uint64_t> hashes;
+    hashes.reserve(names.size() * components);
+    for (auto& direction : names)
+    {
+        if (direction.size() != components)
+        {
+            CHM_THROW_EXCEPTION(mesh_error, "Each direction of a direction library needs the same number of components");
+        }
+
+        for (auto& name : direction)
+        {
+            if (domain.size_faces() > 0 && !domain.face(0)->has_parameter(name))
+            {
+                CHM_THROW_EXCEPTION(mesh_error, "Missing parameter: " + name);
+            }
+            hashes.push_back(xxh64::hash(name.c_str(), name.length()));
+        }
+    }
+
+    init(domain.size_faces(), names.size(), components);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain.size_faces(); i++)
+    {
+        auto face = domain.face(i);
+        float* row = _values.data() + i * hashes.size();
+
+        for (size_t j = 0; j < hashes.size(); j++)
+            row[j] = face->parameter(hashes[j]);
+    }
+
+    SPDLOG_DEBUG("Loaded a library of {} directions x {} components", _directions, _components);
+}
+
+size_t direction_library::rows() const
+{
+    return _values.empty() ? 0 : _values.size() / (_directions * _components);
+}
+
+size_t direction_library::directions() const
+{
+    return _directions;
+}
+
+size_t direction_library::components() const
+{
+    return _components;
+}
+
+station_set_table::set_id station_set_table::insert(const std::vector< std::shared_ptr<station> >& stations,
+                                                    const std::shared_ptr<station>& nearest)
+{
+    // hash the identity of the members, the nearest station is compared below
+    std::vector<const station*> key;
+    key.reserve(stations.size() + 1);
+    key.push_back(nearest.get());
+    for (auto& s : stations)
+        key.push_back(s.get());
+
+    uint64_t hash = xxh64::hash(reinterpret_cast<const char*>(key.data()), key.size() * sizeof(const station*));
+
+    auto range = _lookup.equal_range(hash);
+    for (auto itr = range.first; itr != range.second; ++itr)
+    {
+        auto id = itr->second;
+        auto members = this->stations(id);
+
+        if (_nearest[id] == nearest &&
+            std::equal(members.begin(), members.end(), stations.begin(), stations.end()))
+        {
+            return id;
+        }
+    }
+
+    if (size() >= npos)
+    {
+        CHM_THROW_EXCEPTION(mesh_error, "Too many unique station sets");
+    }
+
+    set_id id = size();
+    _members.insert(_members.end(), stations.begin(), stations.end());
+    _row_ptr.push_back(_members.size());
+    _nearest.push_back(nearest);
+    _lookup.emplace(hash, id);
+
+    return id;
+}
+
+std::span<const std::shared_ptr<station>> station_set_table::stations(set_id id) const
+{
+    if (id == npos)
+        return {};
+
+    return std::span<const std::shared_ptr<station>>(_members.data() + _row_ptr[id], _row_ptr[id + 1] - _row_ptr[id]);
+}
+
+const std::shared_ptr<station>& station_set_table::nearest(set_id id) const
+{
+    if (id == npos)
+        return _null;
+
+    return _nearest[id];
+}
+
+size_t station_set_table::size() const
+{
+    return _nearest.size();
+}
+
+size_t station_set_table::members() const
+{
+    return _members.size();
+}
+
+void station_set_table::clear()
+{
+    _row_ptr.assign(1, 0);
+    _members.clear();
+    _nearest.clear();
+    _lookup.clear();
+}
+
+var_handle triangulation::handle(const std::string& variable)
+{
+    var_handle h;
+    h.column = _face_variables.column(variable);
+    return h;
 }
 
 void triangulation::init_vectors(std::set<std::string>& variables)
@@ -2524,24 +2875,44 @@ void triangulation::prune_faces(std::vector<Face_handle>& faces)
     }
 #endif
 
+    // The dropped faces are still returned by find_closest_face, so they must compute their geometry on demand rather
+    // than read rows of the geometry table that no longer belong to them
+    #pragma omp parallel for
+    for (size_t i = 0; i < _faces.size(); i++)
+    {
+        _faces[i]->_geometry = nullptr;
+    }
+
     _faces.clear();
     _faces  = faces;
 
+    // keep face(i)->cell_local_id == i, which the per-face tables (e.g., horizon) are indexed by
+    for (size_t i = 0; i < _faces.size(); i++)
+    {
+        _faces[i]->cell_local_id = i;
+    }
+
     _local_faces.clear();
     _local_faces = _faces;
 
     _num_faces = _num_global_faces = _faces.size(); //number of global faces
 
+    _interior_faces.clear();
+    _halo_faces.clear();
+
+    compute_face_geometry();
 }
 void triangulation::init_face_data(std::set< std::string >& timeseries,
                     std::set< std::string >& vectors,
                     std::set< std::string >& module_data)
 {
+    // variables for local and ghost faces live in the single mesh-wide column store
+    init_timeseries(timeseries);
+
     #pragma omp parallel for
         for (size_t it = 0; it < size_faces(); it++)
         {
             auto face = this->face(it);
-            face->init_time_series(timeseries);
             face->init_module_data(module_data);
             face->init_vectors(vectors);
         }
@@ -2554,7 +2925,6 @@ void triangulation::init_face_data(std::set< std::string >& timeseries,
         {
             auto face = _ghost_faces.at(it);
             face->init_module_data(module_data);
-            face->init_time_series(timeseries);
             face->init_vectors(vectors);
         }
 }
@@ -2728,17 +3098,33 @@ void triangulation::write_vtu(std::string file_name)
     //this now needs to be called from outside these functions
 //    update_vtk_data();
 
+    write_vtu(_vtk_unstructuredGrid, file_name);
+
+//    write_vtp(file_name);
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> triangulation::vtu_snapshot()
+{
+    vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    grid->ShallowCopy(_vtk_unstructuredGrid);
+
+    // update_vtk_data writes into the same arrays each timestep, so these need to be a real copy
+    grid->GetCellData()->DeepCopy(_vtk_unstructuredGrid->GetCellData());
+
+    return grid;
+}
+
+void triangulation::write_vtu(vtkSmartPointer<vtkUnstructuredGrid> grid, std::string file_name)
+{
     vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
     writer->SetFileName(file_name.c_str());
 //    writer->SetCompressorType( vtkXMLUnstructuredGridWriter::CompressorType::ZLIB);
 #if VTK_MAJOR_VERSION <= 5
-    writer->SetInput(_vtk_unstructuredGrid);
+    writer->SetInput(grid);
 #else
-    writer->SetInputData(_vtk_unstructuredGrid);
+    writer->SetInputData(grid);
 #endif
     writer->Write();
-
-//    write_vtp(file_name);
 }
 
 double triangulation::max_z()
@@ -67,6 +67,11 @@ inline int omp_get_max_threads() { return 1;}
 #include <stack>
 #include <fstream>
 #include <utility>
+#include <span>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 
 #include <armadillo>
@@ -135,6 +140,7 @@ namespace pt = boost::property_tree;
 #include "utility/xxh64.hpp"
 
 #include "timeseries/variablestorage.hpp"
+#include "timeseries/columnstorage.hpp"
 
 // #include "hdf5.h"
 #include "H5Cpp.h"
@@ -151,10 +157,198 @@ struct face_info
     };
 };
 
+/**
+* \struct face_geometry
+* Face geometry for the whole mesh, stored as structure-of-arrays. Built once in a single parallel pass
+* by triangulation::compute_face_geometry and only changed in place by triangulation::update_face_geometry. Rows follow the face variable storage: [0, size_faces()) are the local
+* faces in face(i) order, followed by the ghost faces.
+*/
+struct face_geometry
+{
+    // centroid
+    std::vector<double> x, y, z;
+
+    // unit normal
+    std::vector<double> nx, ny, nz;
+
+    std::vector<double> slope;  // [rad]
+    std::vector<double> aspect; // North = 0, CW [rad]
+    std::vector<double> area;   // [m^2]
+
+    void resize(size_t n)
+    {
+        for (auto* v : {&x, &y, &z, &nx, &ny, &nz, &slope, &aspect, &area})
+            v->assign(n, 0.);
+    }
+
+    size_t size() const
+    {
+        return x.size();
+    }
+};
+
+/**
+* \class station_set_table
+* Interned table of the station lists used by the faces. Neighbouring faces almost always find the same stations, so
+* each unique (stations, nearest station) set is stored once, with the members of all the sets held contiguously in CSR
+* form. A face only holds the 32-bit id of its set, which can also be used to cache any per-set work, e.g.,
+* interpolation weights that only depend on the stations.
+*/
+class station_set_table
+{
+  public:
+    typedef uint32_t set_id;
+
+    /// Id of the empty set, a face without stations
+    static constexpr set_id npos = std::numeric_limits<set_id>::max();
+
+    /// Adds a set of stations, returning the id of an identical set if one is already in the table.
+    /// Sets are compared in order, so callers should give the stations in a canonical order.
+    /// @param stations
+    /// @param nearest Nearest station to the faces that use this set
+    /// @return
+    set_id insert(const std::vector< std::shared_ptr<station> >& stations, const std::shared_ptr<station>& nearest);
+
+    /// Stations of a set. Empty for npos
+    /// @param id
+    /// @return
+    std::span<const std::shared_ptr<station>> stations(set_id id) const;
+
+    /// Nearest station of a set. nullptr for npos
+    /// @param id
+    /// @return
+    const std::shared_ptr<station>& nearest(set_id id) const;
+
+    /// Number of unique sets
+    /// @return
+    size_t size() const;
+
+    /// Total number of stations across all the unique sets
+    /// @return
+    size_t members() const;
+
+    void clear();
+
+  private:
+    std::vector<size_t> _row_ptr = {0}; // set i is [_row_ptr[i], _row_ptr[i+1]) in _members
+    std::vector< std::shared_ptr<station> > _members;
+    std::vector< std::shared_ptr<station> > _nearest;
+
+    // hash of a set's members -> candidate set ids
+    std::unordered_multimap<uint64_t, set_id> _lookup;
+
+    std::shared_ptr<station> _null;
+};
+
+/**
+* \class azimuth_table
+* A value per local face and per azimuth bin, e.g., a terrain horizon angle or fetch that only depends on the static
+* terrain. Bin k is centred on the azimuth k * 360 / bins() and values in between bins are linearly interpolated.
+* Rows follow the local faces, face(i) and cell_local_id.
+*/
+class azimuth_table
+{
+  public:
+    /// Allocates rows x bins values, initialized to 0
+    /// @param rows
+    /// @param bins
+    void init(size_t rows, size_t bins);
+
+    /// Value of a row at a bin
+    /// @param row
+    /// @param bin
+    /// @return
+    inline float& operator()(size_t row, size_t bin)
+    {
+        return _values[row * _bins + bin];
+    }
+    inline float operator()(size_t row, size_t bin) const
+    {
+        return _values[row * _bins + bin];
+    }
+
+    /// Value of a row interpolated to an azimuth
+    /// @param row
+    /// @param azimuth [degrees], North = 0, CW
+    /// @return
+    double at(size_t row, double azimuth) const;
+
+    /// Azimuth of the centre of a bin
+    /// @param bin
+    /// @return [degrees]
+    double bin_azimuth(size_t bin) const;
+
+    size_t bins() const;
+    size_t rows() const;
+
+  private:
+    size_t _bins = 0;
+    std::vector<float> _values; // [row][bin]
+};
+
 //fwd decl
 class segmented_AABB;
 class triangulation;
 
+/**
+* \class direction_library
+* A library of per-face parameter maps that are indexed by a discrete direction, e.g., the WindNinja or MS_wind speed-up
+* maps with a transfer function, u and v component for each wind direction. Copied once out of the face parameters into
+* a dense [row][direction][component] array so that a per-timestep lookup is an indexed load instead of building the
+* parameter name and hashing it. Rows follow the local faces, face(i) and cell_local_id.
+*/
+class direction_library
+{
+  public:
+    /// Allocates rows x directions x components values, initialized to 0
+    /// @param rows
+    /// @param directions
+    /// @param components
+    void init(size_t rows, size_t directions, size_t components);
+
+    /// Allocates one row per local face and copies the parameters in. names[d][c] is the parameter holding component c
+    /// of direction d, and every direction must have the same number of components.
+    /// Throws if a parameter does not exist.
+    /// @param domain
+    /// @param names
+    void load(triangulation& domain, const std::vector< std::vector<std::string> >& names);
+
+    /// Value of a component of a row at a direction
+    /// @param row
+    /// @param direction
+    /// @param component
+    /// @return
+    inline float& operator()(size_t row, size_t direction, size_t component)
+    {
+        return _values[(row * _directions + direction) * _components + component];
+    }
+    inline float operator()(size_t row, size_t direction, size_t component) const
+    {
+        return _values[(row * _directions + direction) * _components + component];
+    }
+
+    /// Component of a row linearly interpolated between two directions
+    /// @param row
+    /// @param d1
+    /// @param d2
+    /// @param w Weight of d2, [0,1]
+    /// @param component
+    /// @return
+    inline double lerp(size_t row, size_t d1, size_t d2, double w, size_t component) const
+    {
+        return (1. - w) * (*this)(row, d1, component) + w * (*this)(row, d2, component);
+    }
+
+    size_t rows() const;
+    size_t directions() const;
+    size_t components() const;
+
+  private:
+    size_t _directions = 0;
+    size_t _components = 0;
+    std::vector<float> _values; // [row][direction][component]
+};
+
 typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
 
 typedef K::Triangle_3 Triangle_3;
@@ -214,24 +408,24 @@ public:
     ~face();
 
     /**
-    * Aspect of the face. North = 0, CW . Calculated on first use, subsequent usages will not recalculate
+    * Aspect of the face. North = 0, CW . Precomputed by triangulation::compute_face_geometry
     * \return Face aspect [rad]
     */
     double aspect();
 
     /**
-    * Slope of the face. Calculated on first use, subsequent usages will not recalculate
+    * Slope of the face. Precomputed by triangulation::compute_face_geometry
     * \return slope [rad]
     */
     double slope();
 
     /**
-    * Normalized face normal. Calculated on first use, subsequent usages will not recalculate
+    * Normalized face normal. Precomputed by triangulation::compute_face_geometry
     */
     Vector_3 normal();
 
     /**
-    * Center of the face as defined by a centroid. Calculated on first use, subsequent usages will not recalculate
+    * Center of the face as defined by a centroid. Precomputed by triangulation::compute_face_geometry
     */
     Point_3 center();
 
@@ -286,12 +480,20 @@ public:
 
     /// Returns the nearest station to the face
     /// @return
-    std::shared_ptr<station>& nearest_station();
+    const std::shared_ptr<station>& nearest_station();
 
     /**
-    * Returns the face's vector of stations
+    * Returns the face's stations, a view into the triangulation's station_set_table
     */
-  std::vector<std::shared_ptr<station>>& stations();
+    std::span<const std::shared_ptr<station>> stations();
+
+    /// Id of this face's set in the triangulation's station_set_table. Faces with the same id have identical stations
+    /// @return
+    station_set_table::set_id station_set() const;
+
+    /// Sets the station set of this face
+    /// @param id Id from triangulation::station_sets()
+    void set_station_set(station_set_table::set_id id);
 
     /**
     * Checks if a point x,y is within the face
@@ -334,6 +536,17 @@ public:
 
     double& operator[](const uint64_t& variable);
     double& operator[](const std::string& variable);
+
+    /**
+     * Direct access to a variable via a handle resolved with triangulation::handle. No lookup or checks are done.
+     * @param h
+     * @return
+     */
+    inline double& get(const var_handle& h)
+    {
+        return (*_variables)(_variables_row, h.column);
+    }
+
     /**
      * Returns the face vector for a specified variable
      * @param variable
@@ -342,10 +555,11 @@ public:
     Vector_3 face_vector(const std::string& variable);
 
     /**
-    * Initializes  this faces variable storage
-    * \param variables Names of the variables to add
+    * Attaches this face to a row of the mesh-wide variable storage. operator[] is a view onto this row.
+    * \param store Mesh-wide column storage, owned by the triangulation
+    * \param row Row in the storage that holds this face's values
     */
-    void init_time_series(std::set<std::string>& variables);
+    void attach_time_series(columnstorage<double>* store, size_t row);
 
     /**
     * Initializes  this faces vector storage
@@ -434,7 +648,7 @@ public:
 
 
     /**
-     * Get triangle area (m)
+     * Get triangle area (m). Uses the "area" parameter if present, which supports geographic meshes.
      */
     double get_area();
     /**
@@ -506,24 +720,31 @@ private:
     OGRSpatialReference _face_utm_srs; // will hold the crs of the face,
 
 
-    double _slope;
-    double _azimuth;
-    double _area;
-    double _x;
-    double _y;
-    double _z;
-
 
     //hold a pointer *back* to the triangulation. This let's use query triangles at distance X, etc
     //that allows for using data::parallel modules w/o having to use domain parallel.
     //const so we can't modify the domain via this as thar be dragons
     triangulation* _domain;
 
-    boost::shared_ptr<Point_3> _center;
-    boost::shared_ptr<Vector_3> _normal;
+    // view onto the triangulation owned geometry. Faces that aren't in it (e.g., not local or ghost to this rank)
+    // compute their geometry on demand instead
+    const face_geometry* _geometry;
+    size_t _geometry_row;
+
+    // Computes this face's geometry and stores it in row of g
+    void compute_geometry(face_geometry& g, size_t row);
+
+    Vector_3 compute_normal();
+    Point_3 compute_center();
+    double compute_slope(const Vector_3& n);
+    double compute_aspect(const Vector_3& n);
+    double compute_area();
 
 
-    variablestorage<double> _variables;
+    // view onto the triangulation owned variable storage
+    columnstorage<double>* _variables;
+    size_t _variables_row;
+
     variablestorage<double> _parameters;
 
     variablestorage< std::unique_ptr<face_info>> _module_face_data;
@@ -533,9 +754,8 @@ private:
     boost::shared_ptr<timeseries> _data;
     timeseries::iterator _itr;
 
-    std::vector<std::shared_ptr<station>> _stations;
-
-    std::shared_ptr<station> _nearest_station;
+    // row in the triangulation's station_set_table
+    station_set_table::set_id _station_set;
 
 };
 
@@ -698,6 +918,86 @@ public:
    */
   void ghost_to_neighbors_communicate_variable(const uint64_t& var);
 
+  /**
+   * Transfers several variables from the locally owned non-ghost faces to the corresponding ghost-faces on
+   * other MPI ranks. All the variables are packed into one message per communication partner, so prefer this over
+   * repeated calls to ghost_neighbors_communicate_variable.
+   * None of the halo exchanges are thread safe, so a module that uses them must declare itself a module_base::barrier().
+   * @param vars Variable names
+   */
+  void ghost_neighbors_communicate_variables(const std::vector<std::string>& vars);
+
+  /**
+   * Transfers several variables from the locally owned non-ghost faces to the corresponding ghost-faces on
+   * other MPI ranks, as one message per communication partner.
+   * @param vars Variable hashes, via "var_name"_s
+   */
+  void ghost_neighbors_communicate_variables(const std::vector<uint64_t>& vars);
+
+  /**
+   * Transfers several variables from the local ghost-faces to the corresponding non-ghost faces on other MPI ranks,
+   * as one message per communication partner.
+   * @param vars Variable names
+   */
+  void ghost_to_neighbors_communicate_variables(const std::vector<std::string>& vars);
+
+  /**
+   * Transfers several variables from the local ghost-faces to the corresponding non-ghost faces on other MPI ranks,
+   * as one message per communication partner.
+   * @param vars Variable hashes, via "var_name"_s
+   */
+  void ghost_to_neighbors_communicate_variables(const std::vector<uint64_t>& vars);
+
+  /**
+   * Starts transferring the variables from the locally owned faces to the ghost faces on other ranks, and returns
+   * without waiting for it to finish. The values are copied out when this is called.
+   * The ghost faces do not have the new values until end_exchange() is called, so in the meantime only faces from
+   * interior_faces() can be computed on. Only one exchange can be in flight at a time.
+   * @param vars Variable names
+   */
+  void begin_exchange(const std::vector<std::string>& vars);
+
+  /**
+   * Starts transferring the variables from the locally owned faces to the ghost faces on other ranks, and returns
+   * without waiting for it to finish.
+   * @param vars Variable hashes, via "var_name"_s
+   */
+  void begin_exchange(const std::vector<uint64_t>& vars);
+
+  /**
+   * Waits for the exchange started by begin_exchange() and writes the received values to the ghost faces
+   */
+  void end_exchange();
+
+  /**
+   * Local indexes of the faces that have no ghost neighbors and so can be computed on while an exchange is in flight
+   */
+  const std::vector<size_t>& interior_faces();
+
+  /**
+   * Local indexes of the faces that have at least one ghost neighbor and so need the exchange to have completed
+   */
+  const std::vector<size_t>& halo_faces();
+
+  /**
+   * Exchanges the variables to the ghost faces, calling fn(face) in parallel on the interior faces while the
+   * communication is in flight, and then on the faces that neighbor a ghost once it has completed.
+   * Equivalent to ghost_neighbors_communicate_variables(vars) followed by fn on every local face.
+   * @param vars Variable hashes, via "var_name"_s
+   * @param fn
+   */
+  template<typename Fn>
+  void overlap_halo_exchange(const std::vector<uint64_t>& vars, Fn fn);
+
+  /**
+   * Exchanges the variables to the ghost faces, calling fn(face) in parallel on the interior faces while the
+   * communication is in flight, and then on the faces that neighbor a ghost once it has completed.
+   * @param vars Variable names
+   * @param fn
+   */
+  template<typename Fn>
+  void overlap_halo_exchange(const std::vector<std::string>& vars, Fn fn);
+
     /**
     * Figures out which faces are required in the ghost region of an MPI process.
     * \param max_distance the maximum distance needed for communication
@@ -836,10 +1136,50 @@ public:
      */
     void init_vtkUnstructured_Grid(std::vector<std::string> output_variables);
 
-    /// Initializes all the face timeseries to hold the selected variables
+    /// Initializes all the face timeseries to hold the selected variables.
+    /// This builds the mesh-wide column storage: rows [0, size_faces()) are the local faces in face(i) order,
+    /// followed by the ghost faces. Each face is then attached to its row.
     /// @param variables
     void init_timeseries(std::set< std::string > variables);
 
+    /// Mesh-wide variable storage that backs face::operator[]
+    /// @return
+    columnstorage<double>& face_variables();
+
+    /// Computes centroid, normal, slope, aspect, and area for the local and ghost faces in one parallel pass
+    /// and attaches each face to its row. Done on mesh load and after parameters are loaded (for the "area" parameter).
+    /// Reallocates the arrays, so use update_face_geometry() once the model is running.
+    void compute_face_geometry();
+
+    /// Recomputes the geometry of every face in place after its vertices have been moved, e.g., by deform_mesh. The
+    /// arrays are not reallocated so references to them stay valid. Rows are rewritten while this runs, so it must not
+    /// be called while any other module is running; a module that calls it must declare itself a module_base::barrier().
+    void update_face_geometry();
+
+    /// Precomputed face geometry. Rows [0, size_faces()) are the local faces in face(i) order, followed by the ghosts.
+    /// @return
+    const face_geometry& geometry() const;
+
+    /// Unique station sets referenced by the faces
+    /// @return
+    station_set_table& station_sets();
+
+    /// Terrain horizon angle [rad] of each local face along bins azimuths. Along each azimuth the closest face is found
+    /// at steps evenly spaced points out to max_distance, and the horizon is the largest elevation angle to a face higher
+    /// than this one, or 0. The table is computed in parallel on first use and shared by any module that asks for
+    /// the same search, e.g., the sky view factor in solar and fast_shadow.
+    /// @param bins
+    /// @param steps
+    /// @param max_distance [m]
+    /// @return
+    const azimuth_table& horizon(size_t bins, int steps, double max_distance);
+
+    /// Resolve a variable to a handle for use with face::get. Throws if the variable does not exist.
+    /// Must be called after init_timeseries/init_face_data.
+    /// @param variable
+    /// @return
+    var_handle handle(const std::string& variable);
+
     /// Initializes the face vectors
     /// @param variables
     void init_vectors(std::set<std::string>& variables);
@@ -860,7 +1200,8 @@ public:
 
     /**
      * Prunes the internal vector that holds faces to only hold a subset. Does not actually remove the faces from the
-     * triangulation. Cannot be used with MPI ranks >1 and outside point mode.
+     * triangulation. Cannot be used with MPI ranks >1 and outside point mode. The kept faces are renumbered so that
+     * face(i)->cell_local_id == i.
      * @param faces
      */
     void prune_faces(std::vector<Face_handle>& faces);
@@ -879,6 +1220,18 @@ public:
     */
 	void write_vtu(std::string fname);
 
+    /**
+     * Copy of the vtk structure as of the last update_vtk_data. The cell data is copied while the points and cells
+     * are shared, so it is cheap to take and can be written by write_vtu on another thread while the model continues.
+     * @return
+     */
+    vtkSmartPointer<vtkUnstructuredGrid> vtu_snapshot();
+
+    /**
+     * Saves a vtk structure, e.g., from vtu_snapshot(), to a vtu file
+     */
+    static void write_vtu(vtkSmartPointer<vtkUnstructuredGrid> grid, std::string fname);
+
 
 	/**
 	 * Returns true if this is a geogrphic mesh
@@ -1113,6 +1466,79 @@ protected:
     // _ghost_neighbors + the distance (type 2) ghosts
     std::vector< mesh_elem > _ghost_faces;
 
+    // Structure-of-arrays storage for all face variables, one column per variable.
+    // Local faces occupy the first size_faces() rows, ghosts follow.
+    columnstorage<double> _face_variables;
+
+    // Face geometry, same row layout as _face_variables
+    face_geometry _face_geometry;
+
+    // Station sets of the local faces
+    station_set_table _station_sets;
+
+    // Horizon tables keyed by (bins, steps, max_distance)
+    std::map< std::tuple<size_t, int, double>, std::unique_ptr<azimuth_table> > _horizons;
+    std::mutex _horizons_mutex;
+
+#ifdef USE_MPI
+    // Preallocated buffers and persistent requests to exchange a fixed number of variables with every
+    // communication partner in one direction
+    struct halo_exchange
+    {
+        std::vector<int> send_partners;
+        std::vector<int> recv_partners;
+
+        // one contiguous buffer per partner, stored variable by variable
+        std::vector< std::vector<double> > send_buffers;
+        std::vector< std::vector<double> > recv_buffers;
+
+        // all the sends, followed by all the recvs
+        std::vector<MPI_Request> requests;
+    };
+
+    // key = (towards the ghosts, number of variables)
+    std::map< std::pair<bool, size_t>, halo_exchange > _halo_exchanges;
+
+    /**
+     * Returns the exchange for this direction and number of variables, creating its buffers and persistent requests on
+     * first use.
+     * @param to_ghosts True for owned faces -> ghost faces, false for ghost faces -> owned faces
+     * @param nvars
+     */
+    halo_exchange& get_halo_exchange(bool to_ghosts, size_t nvars);
+
+    /**
+     * Packs, exchanges and unpacks the given variables
+     * @param to_ghosts True for owned faces -> ghost faces, false for ghost faces -> owned faces
+     * @param vars
+     */
+    void halo_communicate(bool to_ghosts, const std::vector<uint64_t>& vars);
+
+    /**
+     * Packs the variables and starts the exchange
+     */
+    void halo_begin(bool to_ghosts, const std::vector<uint64_t>& vars);
+
+    /**
+     * Waits for the exchange started by halo_begin and unpacks it
+     */
+    void halo_end();
+
+    // exchange started by halo_begin and not yet finished by halo_end, or nullptr
+    halo_exchange* _pending_exchange;
+    bool _pending_to_ghosts;
+    std::vector<var_handle> _pending_handles;
+#endif
+
+    /**
+     * Sorts the local faces into _interior_faces and _halo_faces
+     */
+    void determine_interior_faces();
+
+    // local indexes of the faces without, and with, a ghost neighbor
+    std::vector<size_t> _interior_faces;
+    std::vector<size_t> _halo_faces;
+
     // The communication partnership for each rank
     // Partner ID, (start_local_idx, length)
     std::map< int, std::pair<int,int> > _comm_partner_ownership;
@@ -1278,15 +1704,27 @@ private:
 };
 
 template < class Gt, class Fb>
-std::vector<std::shared_ptr<station>>& face<Gt, Fb>::stations()
+std::span<const std::shared_ptr<station>> face<Gt, Fb>::stations()
 {
-    return _stations;
+    return _domain->station_sets().stations(_station_set);
 }
 
 template < class Gt, class Fb>
-std::shared_ptr<station>& face<Gt, Fb>::nearest_station()
+const std::shared_ptr<station>& face<Gt, Fb>::nearest_station()
 {
-    return _nearest_station;
+    return _domain->station_sets().nearest(_station_set);
+}
+
+template < class Gt, class Fb>
+station_set_table::set_id face<Gt, Fb>::station_set() const
+{
+    return _station_set;
+}
+
+template < class Gt, class Fb>
+void face<Gt, Fb>::set_station_set(station_set_table::set_id id)
+{
+    _station_set = id;
 }
 
 template < class Gt, class Fb>
@@ -1360,13 +1798,13 @@ face<Gt, Fb>::~face()
 template < class Gt, class Fb >
 face<Gt, Fb>::face()
 {
-    _slope = -1;
-    _azimuth = -1;
     _data = boost::make_shared<timeseries>();
-    _center = NULL;
-    _normal = NULL;
-    _area = -1.;
+    _geometry = nullptr;
+    _geometry_row = 0;
+    _station_set = station_set_table::npos;
     _is_geographic = false;
+    _variables = nullptr;
+    _variables_row = 0;
 
 
 
@@ -1378,13 +1816,13 @@ face<Gt, Fb>::face(Vertex_handle v0,
                    Vertex_handle v2)
         : Fb(v0, v1, v2)
 {
-    _slope = -1;
-    _azimuth = -1;
     _data = boost::make_shared<timeseries>();
-    _center = NULL;
-    _normal = NULL;
-    _area = -1.;
+    _geometry = nullptr;
+    _geometry_row = 0;
+    _station_set = station_set_table::npos;
     _is_geographic = false;
+    _variables = nullptr;
+    _variables_row = 0;
 
 }
 
@@ -1397,13 +1835,13 @@ face<Gt, Fb>::face(Vertex_handle v0,
                    Face_handle n2)
         : Fb(v0, v1, v2, n0, n1, n2)
 {
-    _slope = -1;
-    _azimuth = -1;
     _data = boost::make_shared<timeseries>();
-    _center = NULL;
-    _normal = NULL;
-    _area = -1.;
+    _geometry = nullptr;
+    _geometry_row = 0;
+    _station_set = station_set_table::npos;
     _is_geographic = false;
+    _variables = nullptr;
+    _variables_row = 0;
 
 }
 
@@ -1419,13 +1857,13 @@ face<Gt, Fb>::face(Vertex_handle v0,
                    bool c2)
         : Fb(v0, v1, v2, n0, n1, n2)
 {
-    _slope = -1;
-    _azimuth = -1;
     _data = boost::make_shared<timeseries>();
-    _center = NULL;
-    _normal = NULL;
-    _area = -1.;
+    _geometry = nullptr;
+    _geometry_row = 0;
+    _station_set = station_set_table::npos;
     _is_geographic = false;
+    _variables = nullptr;
+    _variables_row = 0;
 
 
 }
@@ -1433,16 +1871,16 @@ face<Gt, Fb>::face(Vertex_handle v0,
 template < class Gt, class Fb>
 double face<Gt, Fb>::aspect()
 {
-    if (_azimuth == -1)
-    {
-        if(!_normal)
-            this->normal();
-
-        _azimuth = math::gis::cartesian_to_bearing(Vector_2((*_normal)[0],(*_normal)[1])) * M_PI/180.; //need in radians
+    if (_geometry)
+        return _geometry->aspect[_geometry_row];
 
-    }
+    return compute_aspect(compute_normal());
+}
 
-    return _azimuth;
+template < class Gt, class Fb>
+double face<Gt, Fb>::compute_aspect(const Vector_3& n)
+{
+    return math::gis::cartesian_to_bearing(Vector_2(n[0], n[1])) * M_PI/180.; //need in radians
 }
 
 template < class Gt, class Fb>
@@ -1506,26 +1944,18 @@ double face<Gt, Fb>::edge_length(int i)
 template < class Gt, class Fb>
 double face<Gt, Fb>::slope()
 {
-    if (_slope == -1)
-    {
-        if(!_normal)
-            this->normal();
+    if (_geometry)
+        return _geometry->slope[_geometry_row];
 
-        //z surface normal
-        arma::vec n(3);
-        n(0) = 0.0; //x
-        n(1) = 0.0; //y
-        n(2) = 1.0;
-
-        arma::vec normal(3);
-        normal(0) = (*_normal)[0];
-        normal(1) = (*_normal)[1];
-        normal(2) = (*_normal)[2];
-
-        _slope = acos(arma::norm_dot(normal, n));
-    }
+    return compute_slope(compute_normal());
+}
 
-    return _slope;
+template < class Gt, class Fb>
+double face<Gt, Fb>::compute_slope(const Vector_3& n)
+{
+    // angle between the face normal and the z surface normal (0,0,1)
+    double len = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+    return acos(n[2] / len);
 }
 
 template < class Gt, class Fb>
@@ -1554,44 +1984,69 @@ const typename face<Gt, Fb>::Face_handle face<Gt, Fb>::find_closest_face(double
 template < class Gt, class Fb>
 Vector_3 face<Gt, Fb>::normal()
 {
-    if(!_normal)
+    if (_geometry)
+        return Vector_3(_geometry->nx[_geometry_row], _geometry->ny[_geometry_row], _geometry->nz[_geometry_row]);
+
+    return compute_normal();
+}
+
+template < class Gt, class Fb>
+Vector_3 face<Gt, Fb>::compute_normal()
+{
+    if(_is_geographic)
     {
-        if(_is_geographic)
-        {
 
-//            OGRSpatialReference monUtm;
+//        OGRSpatialReference monUtm;
 //
-//            OGRSpatialReference monGeo;
-//            monGeo.SetWellKnownGeogCS("WGS84");
+//        OGRSpatialReference monGeo;
+//        monGeo.SetWellKnownGeogCS("WGS84");
 
 
-            CGAL::Point_3<K> v0(this->vertex(0)->point()[0]*100000., this->vertex(0)->point()[1]*100000.,this->vertex(0)->point()[2]);
-            CGAL::Point_3<K> v1(this->vertex(1)->point()[0]*100000., this->vertex(1)->point()[1]*100000.,this->vertex(1)->point()[2]);
-            CGAL::Point_3<K> v2(this->vertex(2)->point()[0]*100000., this->vertex(2)->point()[1]*100000.,this->vertex(2)->point()[2]);
+        CGAL::Point_3<K> v0(this->vertex(0)->point()[0]*100000., this->vertex(0)->point()[1]*100000.,this->vertex(0)->point()[2]);
+        CGAL::Point_3<K> v1(this->vertex(1)->point()[0]*100000., this->vertex(1)->point()[1]*100000.,this->vertex(1)->point()[2]);
+        CGAL::Point_3<K> v2(this->vertex(2)->point()[0]*100000., this->vertex(2)->point()[1]*100000.,this->vertex(2)->point()[2]);
 
-            _normal = boost::make_shared<Vector_3>(CGAL::unit_normal(v0, v1, v2));
+        return CGAL::unit_normal(v0, v1, v2);
 
-        }
-        else
-            _normal = boost::make_shared<Vector_3>(CGAL::unit_normal(this->vertex(0)->point(), this->vertex(1)->point(), this->vertex(2)->point()));
     }
-
-    return *_normal;
+    else
+        return CGAL::unit_normal(this->vertex(0)->point(), this->vertex(1)->point(), this->vertex(2)->point());
 }
 
 template < class Gt, class Fb>
 Point_3 face<Gt, Fb>::center()
 {
-    if (!_center)
-    {
-        _center = boost::make_shared<Point_3>(CGAL::centroid(this->vertex(0)->point(), this->vertex(1)->point(), this->vertex(2)->point()));
-        _x=_center->x();
-        _y=_center->y();
-        _z=_center->z();
-    }
-    //return CGAL::centroid(this->vertex(0)->point(), this->vertex(1)->point(), this->vertex(2)->point());
-    return *_center;
+    if (_geometry)
+        return Point_3(_geometry->x[_geometry_row], _geometry->y[_geometry_row], _geometry->z[_geometry_row]);
+
+    return compute_center();
+}
+
+template < class Gt, class Fb>
+Point_3 face<Gt, Fb>::compute_center()
+{
+    return CGAL::centroid(this->vertex(0)->point(), this->vertex(1)->point(), this->vertex(2)->point());
+}
 
+template < class Gt, class Fb>
+void face<Gt, Fb>::compute_geometry(face_geometry& g, size_t row)
+{
+    auto c = compute_center();
+    g.x[row] = c.x();
+    g.y[row] = c.y();
+    g.z[row] = c.z();
+
+    auto n = compute_normal();
+    g.nx[row] = n[0];
+    g.ny[row] = n[1];
+    g.nz[row] = n[2];
+
+    g.slope[row] = compute_slope(n);
+    g.aspect[row] = compute_aspect(n);
+    g.area[row] = compute_area();
+
+    _geometry = &g;
+    _geometry_row = row;
 }
 template < class Gt, class Fb>
 bool face<Gt, Fb>::contains(Point_3 p)
@@ -1628,34 +2083,50 @@ bool face<Gt, Fb>::contains(double x, double y)
 template < class Gt, class Fb>
 std::vector<std::string> face<Gt, Fb>::variables()
 {
+    if(!_variables)
+        return {};
 
-    return _variables.variables();
+    return _variables->variables();
 }
 
 
 template < class Gt, class Fb>
 bool face<Gt, Fb>::has(const std::string& variable)
 {
-    return _variables.has(variable);
+    if(!_variables)
+        return false;
+
+    return _variables->has(variable);
 
 };
 
 template < class Gt, class Fb>
 bool face<Gt, Fb>::has(const uint64_t& hash)
 {
-    return _variables.has(hash);
+    if(!_variables)
+        return false;
+
+    return _variables->has(hash);
 }
 
 template < class Gt, class Fb>
 double& face<Gt, Fb>::operator[](const uint64_t& hash)
 {
-     return _variables[hash];
+    if(!_variables)
+    {
+        CHM_THROW_EXCEPTION(module_error, "Variable " + std::to_string(hash) + " does not exist.");
+    }
+    return _variables->at(_variables_row, hash);
 }
 
 template < class Gt, class Fb>
 double& face<Gt, Fb>::operator[](const std::string& variable)
 {
-    return _variables[variable];
+    if(!_variables)
+    {
+        CHM_THROW_EXCEPTION(module_error, "Variable " + variable + " does not exist.");
+    }
+    return _variables->at(_variables_row, variable);
 }
 
 template < class Gt, class Fb >
@@ -1709,9 +2180,10 @@ Vector_3 face<Gt, Fb>::face_vector(const std::string& variable)
 };
 
 template < class Gt, class Fb>
-void face<Gt, Fb>::init_time_series(std::set<std::string>& variables)
+void face<Gt, Fb>::attach_time_series(columnstorage<double>* store, size_t row)
 {
-    _variables.init(variables);
+    _variables = store;
+    _variables_row = row;
 }
 
 template < class Gt, class Fb>
@@ -1760,29 +2232,28 @@ void face<Gt, Fb>::to_file(std::string fname)
 template < class Gt, class Fb>
 double face<Gt, Fb>::get_x()
 {
-    if(!_center)
-        this->center();
+    if (_geometry)
+        return _geometry->x[_geometry_row];
 
-    return _x;
+    return compute_center().x();
 }
 
 template < class Gt, class Fb>
 double face<Gt, Fb>::get_y()
 {
-    if(!_center)
-        this->center();
+    if (_geometry)
+        return _geometry->y[_geometry_row];
 
-
-    return _y;
+    return compute_center().y();
 }
 
 template < class Gt, class Fb>
 double face<Gt, Fb>::get_z()
 {
-    if(!_center)
-        this->center();
+    if (_geometry)
+        return _geometry->z[_geometry_row];
 
-    return _z;
+    return compute_center().z();
 }
 template < class Gt, class Fb>
 boost::shared_ptr<timeseries> face<Gt, Fb>::get_underlying_timeseries()
@@ -1835,30 +2306,28 @@ void face<Gt, Fb>::set_face_vector(const std::string& variable, Vector_3 v)
 template < class Gt, class Fb>
 double face<Gt, Fb>::get_area()
 {
-    if(_area == -1)
-    {
-        // supports geographic
-        if(has_parameter("area"_s))
-        {
-            _area = parameter("area"_s);
-        }
-        else
-        {
+    if (_geometry)
+        return _geometry->area[_geometry_row];
 
-            auto& pa = this->vertex(0)->point();
-            auto& pb = this->vertex(1)->point();
-            auto& pc = this->vertex(2)->point();
-
-
-            //same way it's done in mesher for consistency
-            typename Fb::Geom_traits traits;
-            _area = CGAL::to_double(traits.compute_area_2_object()(pa, pb, pc));
+    return compute_area();
+}
 
-        }
+template < class Gt, class Fb>
+double face<Gt, Fb>::compute_area()
+{
+    // supports geographic
+    if(has_parameter("area"_s))
+    {
+        return parameter("area"_s);
     }
 
+    auto& pa = this->vertex(0)->point();
+    auto& pb = this->vertex(1)->point();
+    auto& pc = this->vertex(2)->point();
 
-    return _area;
+    //same way it's done in mesher for consistency
+    typename Fb::Geom_traits traits;
+    return CGAL::to_double(traits.compute_area_2_object()(pa, pb, pc));
 }
 template < class Gt, class Fb>
 double face<Gt, Fb>::get_subgrid_z(Point_2 query)
@@ -1899,6 +2368,40 @@ double face<Gt, Fb>::get_subgrid_z(Point_2 query)
 
 };
 
+template<typename Fn>
+void triangulation::overlap_halo_exchange(const std::vector<uint64_t>& vars, Fn fn)
+{
+    begin_exchange(vars);
+
+    auto& interior = interior_faces();
+    #pragma omp parallel for
+    for (size_t i = 0; i < interior.size(); i++)
+    {
+        auto f = face(interior[i]);
+        fn(f);
+    }
+
+    end_exchange();
+
+    auto& halo = halo_faces();
+    #pragma omp parallel for
+    for (size_t i = 0; i < halo.size(); i++)
+    {
+        auto f = face(halo[i]);
+        fn(f);
+    }
+}
+
+template<typename Fn>
+void triangulation::overlap_halo_exchange(const std::vector<std::string>& vars, Fn fn)
+{
+    std::vector<uint64_t> hashes;
+    for (auto& v : vars)
+        hashes.push_back(xxh64::hash (v.c_str(), v.length()));
+
+    overlap_halo_exchange(hashes, fn);
+}
+
 template <typename T>
 T determine_owner_of_global_index(T index, std::vector<T> num_faces_in_partition)
 {
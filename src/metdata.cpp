@@ -22,11 +22,26 @@
 //
 
 #include "metdata.hpp"
+#include "timer.hpp"
+
+#include "utility/xxh64.hpp"
+
+#include <tbb/parallel_for.h>
+#include <boost/filesystem.hpp>
 
 metdata::metdata(std::string mesh_proj4)
 {
     _nc = nullptr;
     _use_netcdf = false;
+    _nc_x_start = _nc_y_start = _nc_nx = _nc_ny = 0;
+    _prefetch_depth = 2;
+    _ascii_cache = true;
+    _ascii_frames = nullptr;
+    _ascii_released = false;
+    _ascii_frames_nt = 0;
+    _prefetch_stop = false;
+    _prefetch_eof = false;
+    _prefetch_stall = 0;
     _n_timesteps = 0;
     _mesh_proj4 = mesh_proj4;
     is_first_timestep = true;
@@ -38,11 +53,13 @@ metdata::metdata(std::string mesh_proj4)
 
 metdata::~metdata()
 {
-
+    stop_prefetch();
 }
 
 void metdata::load_from_netcdf(const std::string& path, const triangulation::bounding_box* box, std::map<std::string, boost::shared_ptr<filter_base> > filters)
 {
+    stop_prefetch();
+
     if(_mesh_proj4 == "")
     {
         CHM_THROW_EXCEPTION(forcing_error, "Met loader not initialized with proj4 string");
@@ -201,9 +218,73 @@ void metdata::load_from_netcdf(const std::string& path, const triangulation::bou
     OGRCoordinateTransformation::DestroyCT(coordTrans);
     _dt = _nc->get_dt();
 
+    auto nc_vars = _nc->get_variable_names();
+    _nc_variables.assign(nc_vars.begin(), nc_vars.end());
+
+    _nc_filter_variables.clear();
+    for(auto& p : _provides_from_nc_filters)
+    {
+        if(nc_vars.find(p) == nc_vars.end())
+            _nc_filter_variables.push_back(p);
+    }
+
+    compute_nc_window();
+
     _current_ts = _start_time;
 }
 
+void metdata::compute_nc_window()
+{
+    size_t x_min = std::numeric_limits<size_t>::max();
+    size_t y_min = std::numeric_limits<size_t>::max();
+    size_t x_max = 0;
+    size_t y_max = 0;
+
+    for(auto& s : _stations)
+    {
+        // NaN grid cells are nullptr stations
+        if(!s)
+            continue;
+
+        x_min = std::min(x_min, s->_nc_x);
+        y_min = std::min(y_min, s->_nc_y);
+        x_max = std::max(x_max, s->_nc_x);
+        y_max = std::max(y_max, s->_nc_y);
+    }
+
+    if(x_min > x_max || y_min > y_max)
+    {
+        _nc_x_start = _nc_y_start = _nc_nx = _nc_ny = 0;
+    }
+    else
+    {
+        _nc_x_start = x_min;
+        _nc_y_start = y_min;
+        _nc_nx = x_max - x_min + 1;
+        _nc_ny = y_max - y_min + 1;
+    }
+
+    _nc_buffers.resize(_nc_variables.size() + _nc_filter_variables.size());
+    for(auto& b : _nc_buffers)
+        b.resize(_nc_nx * _nc_ny);
+
+    _nc_filter_stations.assign(_stations.size(), nullptr);
+    if(!_netcdf_filters.empty())
+    {
+        for(size_t i = 0; i < _stations.size(); i++)
+        {
+            auto& s = _stations[i];
+            if(!s)
+                continue;
+
+            _nc_filter_stations[i] = std::make_shared<station>(s->ID(), s->x(), s->y(), s->z(), _variables);
+        }
+    }
+
+    SPDLOG_DEBUG("NetCDF read window is x=[{},{}) y=[{},{})", _nc_x_start, _nc_x_start + _nc_nx,
+                 _nc_y_start, _nc_y_start + _nc_ny);
+}
+
 void metdata::load_from_ascii(std::vector<ascii_metdata> stations, int utc_offset)
 {
     if(_mesh_proj4 == "")
@@ -214,6 +295,9 @@ void metdata::load_from_ascii(std::vector<ascii_metdata> stations, int utc_offse
     // a set of the ids we've loaded, ensure there are no duplicated IDs as there is some assumption we are not loading the same thing twic
     std::set<std::string> loaded_ids;
 
+    // stations in the same order as the input
+    std::vector< std::shared_ptr<station> > new_stations;
+
     for(auto& itr: stations)
     {
         if( (itr.latitude > 90 || itr.latitude < -90) ||
@@ -262,9 +346,21 @@ void metdata::load_from_ascii(std::vector<ascii_metdata> stations, int utc_offse
             CHM_THROW_EXCEPTION(forcing_error, "Stations with duplicated ID (" + s->ID() + ") inserted.");
         }
 
-        // load the ascii data into the timeseries object
         _ascii_stations.insert( std::make_pair(s->ID(), std::make_unique<ascii_data>()));
-        _ascii_stations[s->ID()]->_obs.open(itr.path);
+        new_stations.push_back(s);
+    }
+
+    // load the ascii data into the timeseries objects. Each file is independent, so parse them concurrently.
+    // Any exception thrown by a parse is rethrown here by parallel_for
+    tbb::parallel_for(size_t(0), stations.size(), [&](size_t i)
+    {
+        _ascii_stations.at(new_stations[i]->ID())->_obs.open(stations[i].path, _ascii_cache);
+    });
+
+    for(size_t i = 0; i < stations.size(); i++)
+    {
+        auto& itr = stations[i];
+        auto& s = new_stations[i];
 
         // computes dt
         if(_ascii_stations[s->ID()]->_obs.get_date_timeseries().size() == 1)
@@ -272,7 +368,6 @@ void metdata::load_from_ascii(std::vector<ascii_metdata> stations, int utc_offse
             CHM_THROW_EXCEPTION(model_init_error,"Unable to determine model timestep from only 1 input timestep.");
         }
 
-        _ascii_stations[s->ID()]->_itr =  _ascii_stations[s->ID()]->_obs.begin();
         _ascii_stations[s->ID()]->id = s->ID();
 
         _variables = _ascii_stations[s->ID()]->_obs.list_variables();
@@ -370,6 +465,8 @@ std::set<std::string> metdata::list_variables()
 
 void metdata::check_ts_consistency()
 {
+    check_ascii_resident();
+
     //ensure all the stations have the same start and end times
     // per-timestep agreeent happens during runtime.
 
@@ -396,13 +493,29 @@ void metdata::subset(boost::posix_time::ptime start, boost::posix_time::ptime en
     // the netcdf files are simple and don't need this subsetting
     if(!_use_netcdf)
     {
-        for(auto& itr : _ascii_stations)
+        if(_ascii_released)
         {
-            itr.second->_obs.subset(start, end);
-            itr.second->_itr = itr.second->_obs.begin();
+            // the frames are timestep-major, so a subset of the packed range is just a different first frame
+            if(start < _ascii_frames_start || end > _ascii_frames_start + _dt * static_cast<int>(_ascii_frames_nt - 1))
+            {
+                CHM_THROW_EXCEPTION(forcing_error, "Cannot subset the ascii forcing to " +
+                                                   boost::posix_time::to_simple_string(start) + " - " +
+                                                   boost::posix_time::to_simple_string(end) +
+                                                   " as it is outside the already loaded period");
+            }
+        }
+        else
+        {
+            for(auto& itr : _ascii_stations)
+            {
+                itr.second->_obs.subset(start, end);
+            }
         }
     }
 
+    // anything read ahead is for the old time range
+    stop_prefetch();
+
     _start_time = start;
     _end_time = end;
     _current_ts = _start_time;
@@ -416,6 +529,7 @@ std::pair<boost::posix_time::ptime,boost::posix_time::ptime> metdata::find_unifi
 {
     if(!_use_netcdf)
     {
+        check_ascii_resident();
 
         _start_time = _ascii_stations.begin()->second->_obs.get_date_timeseries().at(0);
         _end_time = _ascii_stations.begin()->second->_obs.get_date_timeseries().back();
@@ -505,50 +619,184 @@ bool metdata::next()
 
 bool metdata::next_ascii()
 {
+    if(!_ascii_frames)
+        pack_ascii();
+
+    // next() has already advanced _current_ts, so this is the frame to load
+    if(_current_ts > _end_time || _current_ts < _ascii_frames_start)
+        return false;
+
+    size_t t = (_current_ts - _ascii_frames_start).total_seconds() / _dt.total_seconds();
+    if(t >= _ascii_frames_nt)
+        return false;
 
+    const size_t nvar = _ascii_variables.size();
+    const double* frame = _ascii_frames + t * nstations() * nvar;
+
+    #pragma omp parallel for
     for(size_t i = 0; i < nstations();i++)
     {
-        auto s = _stations.at(i);
-        auto& proxy = _ascii_stations[s->ID()];
+        auto& s = _stations[i];
+        const double* values = frame + i * nvar;
 
-        //the very first timestep needs to handle loading the data without incrementing the internal iterators
-        if(!is_first_timestep)
+        // don't use the stations variable map as it'll contain anything inserted by a filter which won't exist in the ascii file
+        for (auto k : _ascii_station_variables[i])
         {
-            ++proxy->_itr;
-            if (proxy->_itr == proxy->_obs.end())
-                return false;
+            (*s)[_ascii_variable_hash[k]] = values[k];
         }
 
+        // each station owns its own filter instances, so these are safe to run concurrently
+        for (auto& filt : _ascii_proxy[i]->filters)
+        {
+            filt->process(s);
+        }
 
-        if(proxy->_itr->get_posix() != _current_ts)
+        s->set_posix(_current_ts);
+    }
+
+    return true;
+}
+
+void metdata::pack_ascii()
+{
+    // a prune after the first next() would need to rebuild the frames from the freed timeseries
+    check_ascii_resident();
+
+    timer c;
+    c.tic();
+
+    release_ascii_frames();
+
+    std::set<std::string> variables;
+    _ascii_proxy.resize(nstations());
+    for(size_t i = 0; i < nstations(); i++)
+    {
+        _ascii_proxy[i] = _ascii_stations.at(_stations[i]->ID()).get();
+
+        auto v = _ascii_proxy[i]->_obs.list_variables();
+        variables.insert(v.begin(), v.end());
+    }
+
+    _ascii_variables.assign(variables.begin(), variables.end());
+    _ascii_variable_hash.clear();
+    for(auto& v : _ascii_variables)
+    {
+        _ascii_variable_hash.push_back(xxh64::hash(v.c_str(), v.length()));
+    }
+
+    // Every station must have exactly one record per model timestep. This used to be checked as each timestep was
+    // read, now it is checked once up front
+    _ascii_station_variables.assign(nstations(), {});
+    for(size_t i = 0; i < nstations(); i++)
+    {
+        auto dates = _ascii_proxy[i]->_obs.get_date_timeseries();
+
+        for(size_t t = 0; t < _n_timesteps; t++)
         {
-            CHM_THROW_EXCEPTION(forcing_error,
-                "Mismatch between model timestep and ascii file timestep. Current model = " +
-                boost::posix_time::to_simple_string(_current_ts) + ", ascii was:"+
-                boost::posix_time::to_simple_string(proxy->_itr->get_posix()) +" @station id="+s->ID());
+            auto model_ts = _start_time + _dt * static_cast<int>(t);
+            if(t >= dates.size() || dates[t] != model_ts)
+            {
+                CHM_THROW_EXCEPTION(forcing_error,
+                    "Mismatch between model timestep and ascii file timestep. Current model = " +
+                    boost::posix_time::to_simple_string(model_ts) + ", ascii was:" +
+                    (t < dates.size() ? boost::posix_time::to_simple_string(dates[t]) : std::string("end of file")) +
+                    " @station id=" + _stations[i]->ID());
+            }
         }
 
-        // don't use the stations variable map as it'll contain anything inserted by a filter which won't exist in the ascii file
-        for (auto &v: proxy->_obs.list_variables() )
+        for(auto& v : _ascii_proxy[i]->_obs.list_variables())
         {
-            (*s)[v] = proxy->_itr->get(v);
+            auto k = std::lower_bound(_ascii_variables.begin(), _ascii_variables.end(), v) - _ascii_variables.begin();
+            _ascii_station_variables[i].push_back(k);
+        }
+    }
+
+    const size_t nvar = _ascii_variables.size();
+    const size_t frame_size = nstations() * nvar;
+    const size_t bytes = _n_timesteps * frame_size * sizeof(double);
+
+    if(bytes > ascii_frames_mmap_bytes)
+    {
+        auto dir = _ascii_spill_dir.empty() ? boost::filesystem::temp_directory_path()
+                                            : boost::filesystem::path(_ascii_spill_dir);
+        auto path = dir / boost::filesystem::unique_path("chm-forcing-%%%%-%%%%-%%%%.bin");
+
+        boost::iostreams::mapped_file_params params;
+        params.path = path.string();
+        params.new_file_size = bytes;
+        params.flags = boost::iostreams::mapped_file::readwrite;
 
+        try
+        {
+            _ascii_frames_map.open(params);
         }
+        catch(std::exception& e)
+        {
+            CHM_THROW_EXCEPTION(forcing_error, "Unable to map the forcing store " + path.string() + ": " + e.what());
+        }
+
+        // the mapping keeps the file alive, so unlink it now and it is cleaned up however we exit
+        boost::system::error_code ec;
+        boost::filesystem::remove(path, ec);
 
-        //get the list of filters to run for this station
-        auto filters = proxy->filters;
+        _ascii_frames = reinterpret_cast<double*>(_ascii_frames_map.data());
+    }
+    else
+    {
+        _ascii_frames_mem.assign(_n_timesteps * frame_size, -9999.0);
+        _ascii_frames = _ascii_frames_mem.data();
+    }
 
-        for (auto& filt : filters)
+    // transpose each station's columns into the frames. Stations write disjoint slots
+    tbb::parallel_for(size_t(0), nstations(), [&](size_t i)
+    {
+        for(auto k : _ascii_station_variables[i])
         {
-            filt->process(s);
+            auto column = _ascii_proxy[i]->_obs.get_time_series(_ascii_variables[k]);
+
+            double* dst = _ascii_frames + i * nvar + k;
+            for(size_t t = 0; t < _n_timesteps; t++)
+            {
+                dst[t * frame_size] = column[t];
+            }
         }
+    });
 
-        s->set_posix(_current_ts);
+    // the frames are now the only copy that is read, so don't also hold every station's timeseries. This includes
+    // the pruned stations as they are never used again
+    for(auto& itr : _ascii_stations)
+    {
+        itr.second->_obs = timeseries();
+    }
+    _ascii_released = true;
+    _ascii_frames_start = _start_time;
+    _ascii_frames_nt = _n_timesteps;
 
+    SPDLOG_DEBUG("Packed {} ascii stations x {} variables x {} timesteps ({} MB{}) in {} s",
+                 nstations(), nvar, _n_timesteps, bytes / (1024 * 1024),
+                 _ascii_frames_map.is_open() ? ", mapped" : "", c.toc<s>());
+}
+
+void metdata::check_ascii_resident()
+{
+    if(_ascii_released)
+    {
+        CHM_THROW_EXCEPTION(forcing_error, "The ascii forcing timeseries were freed once the first timestep was "
+                                           "loaded. Stations must be pruned before then");
     }
+}
 
-    return true;
+void metdata::release_ascii_frames()
+{
+    _ascii_frames = nullptr;
+
+    _ascii_frames_mem.clear();
+    _ascii_frames_mem.shrink_to_fit();
+
+    if(_ascii_frames_map.is_open())
+        _ascii_frames_map.close();
 }
+
 bool metdata::next_nc()
 {
     if(_current_ts > _end_time) //_current_ts is already ++ from the next() call
@@ -557,8 +805,58 @@ bool metdata::next_nc()
     }
 
 
-    //The call to netCDF isn't thread safe. It is protected by a critical section but it's costly, and not running this
-    // in parallel is about 2x faster  #pragma omp parallel for
+    if(_prefetch_depth == 0)
+    {
+        read_nc_window(_current_ts, _nc_buffers);
+        filter_nc_window(_current_ts, _nc_buffers);
+    }
+    else
+    {
+        if(!_prefetch_thread.joinable())
+        {
+            // resume after whatever has already been read
+            auto t = _prefetch_queue.empty() ? _current_ts : _prefetch_queue.back().time + _dt;
+            start_prefetch(t);
+        }
+
+        timer c;
+        c.tic();
+
+        std::unique_lock<std::mutex> lock(_prefetch_mutex);
+        _prefetch_cv.wait(lock, [this] { return !_prefetch_queue.empty() || _prefetch_eof; });
+
+        _prefetch_stall += c.toc<ms>();
+
+        if(_prefetch_queue.empty())
+        {
+            if(_prefetch_error)
+                std::rethrow_exception(_prefetch_error);
+
+            CHM_THROW_EXCEPTION(forcing_error, "Forcing prefetch ended before " + boost::posix_time::to_simple_string(_current_ts));
+        }
+
+        auto& frame = _prefetch_queue.front();
+        if(frame.time != _current_ts)
+        {
+            CHM_THROW_EXCEPTION(forcing_error,
+                                "Mismatch between model timestep and prefetched forcing. Current model = " +
+                                boost::posix_time::to_simple_string(_current_ts) + ", prefetched was: " +
+                                boost::posix_time::to_simple_string(frame.time));
+        }
+
+        // swap in the new timestep and hand the old buffers back to the reader
+        std::swap(_nc_buffers, frame.buffers);
+        _prefetch_free.push_back(std::move(frame.buffers));
+        _prefetch_queue.pop_front();
+
+        lock.unlock();
+        _prefetch_cv.notify_all();
+    }
+
+    // scatter the values into the stations, the filters have already been applied to the frame
+    size_t nnc = _nc_variables.size();
+
+    #pragma omp parallel for
     for(size_t i = 0; i < nstations();i++)
     {
         auto s = _stations.at(i);
@@ -569,12 +867,66 @@ bool metdata::next_nc()
 
         s->set_posix(_current_ts);
 
+        size_t idx = (s->_nc_x - _nc_x_start) + (s->_nc_y - _nc_y_start) * _nc_nx;
+
         // don't use the stations variable map as it'll contain anything inserted by a filter which won't exist in the nc file
-        for (auto &v: _nc->get_variable_names() )
+        for (size_t v = 0; v < nnc; v++)
         {
-            double d = _nc->get_var(v, _current_ts, s->_nc_x, s->_nc_y);
-            (*s)[v] = d;
+            (*s)[_nc_variables[v]] = _nc_buffers[v][idx];
+        }
+        for (size_t v = 0; v < _nc_filter_variables.size(); v++)
+        {
+            (*s)[_nc_filter_variables[v]] = _nc_buffers[nnc + v][idx];
+        }
+    }
 
+    return true;
+
+}
+
+void metdata::read_nc_window(const boost::posix_time::ptime& t, std::vector< std::vector<double> >& buffers)
+{
+    buffers.resize(_nc_variables.size() + _nc_filter_variables.size());
+    for(auto& b : buffers)
+        b.resize(_nc_nx * _nc_ny);
+
+    // Read each variable over the window that bounds all the stations in one call.
+    // This keeps all the netCDF calls, which are not thread safe, out of the station loop
+    if(_nc_nx == 0 || _nc_ny == 0)
+        return;
+
+    // the main thread may be writing output or a checkpoint through netCDF/HDF5
+    std::lock_guard<std::mutex> lock(netcdf::library_mutex());
+
+    for (size_t v = 0; v < _nc_variables.size(); v++)
+    {
+        _nc->get_var_hyperslab(_nc_variables[v], t,
+                               _nc_x_start, _nc_y_start, _nc_nx, _nc_ny,
+                               buffers[v].data());
+    }
+}
+
+void metdata::filter_nc_window(const boost::posix_time::ptime& t, std::vector< std::vector<double> >& buffers)
+{
+    if(_netcdf_filters.empty())
+        return;
+
+    size_t nnc = _nc_variables.size();
+
+    // Serial as this normally runs on the prefetch thread, alongside the model's own threads
+    for(size_t i = 0; i < _nc_filter_stations.size(); i++)
+    {
+        auto& s = _nc_filter_stations[i];
+        if(!s)
+            continue;
+
+        s->set_posix(t);
+
+        size_t idx = (_stations[i]->_nc_x - _nc_x_start) + (_stations[i]->_nc_y - _nc_y_start) * _nc_nx;
+
+        for (size_t v = 0; v < nnc; v++)
+        {
+            (*s)[_nc_variables[v]] = buffers[v][idx];
         }
 
         // run all the filters for this station
@@ -582,10 +934,119 @@ bool metdata::next_nc()
         {
             f.second->process(s);
         }
+
+        // keep the filtered values, including what the filters provide
+        for (size_t v = 0; v < nnc; v++)
+        {
+            buffers[v][idx] = (*s)[_nc_variables[v]];
+        }
+        for (size_t v = 0; v < _nc_filter_variables.size(); v++)
+        {
+            buffers[nnc + v][idx] = (*s)[_nc_filter_variables[v]];
+        }
     }
+}
 
-    return true;
+void metdata::set_ascii_cache(bool use_cache)
+{
+    _ascii_cache = use_cache;
+}
+
+void metdata::set_ascii_spill_directory(const std::string& path)
+{
+    _ascii_spill_dir = path;
+}
+
+void metdata::set_prefetch_depth(size_t depth)
+{
+    stop_prefetch();
+    _prefetch_depth = depth;
+}
+
+double metdata::prefetch_stall_time()
+{
+    return _prefetch_stall / 1000.0;
+}
+
+void metdata::start_prefetch(boost::posix_time::ptime t)
+{
+    _prefetch_stop = false;
+    _prefetch_eof = false;
+    _prefetch_error = nullptr;
+
+    _prefetch_thread = std::thread(&metdata::prefetch_worker, this, t);
+}
+
+void metdata::prefetch_worker(boost::posix_time::ptime t)
+{
+    try
+    {
+        while (t <= _end_time)
+        {
+            std::vector< std::vector<double> > buffers;
+            {
+                std::unique_lock<std::mutex> lock(_prefetch_mutex);
+                _prefetch_cv.wait(lock, [this] { return _prefetch_stop || _prefetch_queue.size() < _prefetch_depth; });
+
+                if(_prefetch_stop)
+                    return;
+
+                if(!_prefetch_free.empty())
+                {
+                    buffers = std::move(_prefetch_free.back());
+                    _prefetch_free.pop_back();
+                }
+            }
+
+            // the read and filters are done without holding the lock so that next() can consume frames in the meantime
+            read_nc_window(t, buffers);
+            filter_nc_window(t, buffers);
+
+            {
+                std::lock_guard<std::mutex> lock(_prefetch_mutex);
+                _prefetch_queue.push_back({t, std::move(buffers)});
+            }
+            _prefetch_cv.notify_all();
+
+            t = t + _dt;
+        }
+    }
+    catch(...)
+    {
+        std::lock_guard<std::mutex> lock(_prefetch_mutex);
+        _prefetch_error = std::current_exception();
+    }
 
+    {
+        std::lock_guard<std::mutex> lock(_prefetch_mutex);
+        _prefetch_eof = true;
+    }
+    _prefetch_cv.notify_all();
+}
+
+void metdata::stop_prefetch()
+{
+    if(_prefetch_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_prefetch_mutex);
+            _prefetch_stop = true;
+        }
+        _prefetch_cv.notify_all();
+        _prefetch_thread.join();
+    }
+
+    // anything already read is for the old window or time range
+    _prefetch_queue.clear();
+    _prefetch_free.clear();
+    _prefetch_error = nullptr;
+    _prefetch_stop = false;
+    _prefetch_eof = false;
+}
+
+void metdata::build_search_tree()
+{
+    _dD_tree.build();
 }
 
 std::vector< std::shared_ptr<station> > metdata::get_stations_in_radius(double x, double y, double radius )
@@ -623,6 +1084,9 @@ std::vector< std::shared_ptr<station> > metdata::nearest_station(double x, doubl
 
 void metdata::prune_stations(std::unordered_set<std::string>& station_ids)
 {
+    // anything read ahead is for the old window
+    stop_prefetch();
+
     _stations.erase(
         std::remove_if(std::begin(_stations), std::end(_stations),
         [&](auto const& it)
@@ -633,6 +1097,12 @@ void metdata::prune_stations(std::unordered_set<std::string>& station_ids)
         std::end(_stations));
 
     _nstations = _stations.size();
+
+    // shrink the forcing read window to the remaining stations
+    if(_use_netcdf)
+        compute_nc_window();
+    else
+        release_ascii_frames();
 }
 
 std::vector< std::shared_ptr<station>>& metdata::stations()
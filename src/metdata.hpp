@@ -38,10 +38,16 @@
 #include <set>
 #include <unordered_set>
 #include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 
 //boost includes
 #include <boost/function.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp> // for boost::posix
+#include <boost/iostreams/device/mapped_file.hpp>
 
 //Gdal includes
 #include <ogr_spatialref.h>
@@ -131,6 +137,10 @@ class metdata
      */
     std::vector< std::shared_ptr<station> > nearest_station(double x, double y,unsigned int N=1);
 
+    /// Builds the station search tree. CGAL otherwise builds it on the first query, which is not thread safe, so this
+    /// must be called before get_stations or nearest_station are used concurrently
+    void build_search_tree();
+
     /// Return a list of stations for a point x,y corresponding to a search radius, or nearest station
     boost::function< std::vector< std::shared_ptr<station> > ( double, double) > get_stations;
 
@@ -194,6 +204,25 @@ class metdata
 
     std::vector< std::shared_ptr<station>>& stations();
 
+    /// If true (default), ascii forcing files are read from, and written to, a binary sidecar cache (<file>.chmcache)
+    /// that is reused as long as the source file is unchanged. Must be called before load_from_ascii.
+    /// @param use_cache
+    void set_ascii_cache(bool use_cache);
+
+    /// Directory for the temporary file that holds the packed ascii forcing when it is too large to keep in memory.
+    /// Defaults to the system temporary directory. Must be called before the first next().
+    /// @param path
+    void set_ascii_spill_directory(const std::string& path);
+
+    /// Number of timesteps of NetCDF forcing to read ahead on a background I/O thread. 0 disables the prefetch and
+    /// reads synchronously in next(). Has no effect for ascii forcing as it is already held in memory.
+    /// @param depth
+    void set_prefetch_depth(size_t depth);
+
+    /// Total time, in seconds, that next() has spent waiting on the prefetch I/O thread
+    /// @return
+    double prefetch_stall_time();
+
   private:
 
     struct ascii_data
@@ -205,7 +234,6 @@ class metdata
         std::string id;
         // these are loaded into by metdata. Essentially this becomes like the old station
         timeseries _obs;
-        timeseries::iterator _itr;
     };
 
     /// Advances 1 timestep in the netcdf files
@@ -216,6 +244,16 @@ class metdata
     /// @return
     bool next_ascii();
 
+    /// Copies the ascii timeseries of the current stations into the timestep-major _ascii_frames store, then frees the
+    /// timeseries so the forcing is only held once
+    void pack_ascii();
+
+    /// Throws if pack_ascii has already freed the ascii timeseries
+    void check_ascii_resident();
+
+    /// Frees the _ascii_frames store. It is rebuilt on the next call to next()
+    void release_ascii_frames();
+
     /// For all the stations loaded from ascii files, find the latest start time, and the earliest end time that is consistent across all stations
     /// @return
     std::pair<boost::posix_time::ptime, boost::posix_time::ptime> find_unified_start_end();
@@ -231,12 +269,98 @@ class metdata
 
         std::set<std::string> _provides_from_nc_filters;
 
+        // Names of the variables read from the nc file, cached at load time
+        std::vector<std::string> _nc_variables;
+
+        // Names of the variables the filters provide that are not in the nc file. A frame holds the _nc_variables
+        // followed by these
+        std::vector<std::string> _nc_filter_variables;
+
+        // Scratch copy of each station that the filters are run on when a frame is read, so that they can run on the
+        // prefetch thread without touching the stations the model is using. nullptr for NaN grid cells
+        std::vector< std::shared_ptr<station> > _nc_filter_stations;
+
+        // Window, in grid indexes, that bounds all the stations in use. Each timestep every variable is read over this
+        // window with a single hyperslab read instead of one read per station
+        size_t _nc_x_start, _nc_y_start, _nc_nx, _nc_ny;
+
+        // One buffer per frame variable to hold this timestep's filtered hyperslab, row-major (y,x)
+        std::vector< std::vector<double> > _nc_buffers;
+
+        /// Computes the _nc_* window from the current set of stations and sizes the buffers
+        void compute_nc_window();
+
+        /// Reads the window for all variables at time t into buffers
+        void read_nc_window(const boost::posix_time::ptime& t, std::vector< std::vector<double> >& buffers);
+
+        /// Runs the filters over each station's values in the buffers read for time t, in place
+        void filter_nc_window(const boost::posix_time::ptime& t, std::vector< std::vector<double> >& buffers);
+
+        // A timestep's worth of windowed and filtered forcing, read ahead by the prefetch thread
+        struct nc_frame
+        {
+            boost::posix_time::ptime time;
+            std::vector< std::vector<double> > buffers;
+        };
+
+        // Prefetch pipeline. Once started, the prefetch thread is the only thread that makes calls into _nc, which it
+        // does holding netcdf::library_mutex(), and the only thread that runs the _netcdf_filters
+        size_t _prefetch_depth;
+        std::thread _prefetch_thread;
+        std::mutex _prefetch_mutex;
+        std::condition_variable _prefetch_cv; // signals a frame was produced or consumed, or a stop request
+        std::deque<nc_frame> _prefetch_queue; // read frames waiting to be consumed, in time order
+        std::vector< std::vector< std::vector<double> > > _prefetch_free; // consumed buffers available for reuse
+        bool _prefetch_stop;
+        bool _prefetch_eof;
+        std::exception_ptr _prefetch_error;
+        double _prefetch_stall; // ms
+
+        /// Starts the prefetch thread reading from t
+        void start_prefetch(boost::posix_time::ptime t);
+
+        /// Body of the prefetch thread
+        void prefetch_worker(boost::posix_time::ptime t);
+
+        /// Stops the prefetch thread and drops any frames already read
+        void stop_prefetch();
+
         // if false, we are using ascii files
         bool _use_netcdf;
 
     // -----------------------------------
     // ASCII met data specific variables
 
+        // use the binary sidecar cache when loading ascii files
+        bool _ascii_cache;
+
+        // Packed copy of the ascii forcing laid out as [timestep][station][variable] so that each timestep is one
+        // contiguous frame. Stations are in the order of _stations and variables in the order of _ascii_variables.
+        // Built on the first next(), after which the per-station timeseries are freed. Stations must be pruned before
+        // then, and a later subset can only narrow the packed [_ascii_frames_start, +_ascii_frames_nt) period.
+        // Records larger than ascii_frames_mmap_bytes are held in an unlinked temporary file in _ascii_spill_dir
+        // that is memory mapped so the OS can page them in as the model advances
+        double* _ascii_frames;
+        std::vector<double> _ascii_frames_mem;
+        boost::iostreams::mapped_file _ascii_frames_map;
+        static constexpr size_t ascii_frames_mmap_bytes = 256 * 1024 * 1024;
+        std::string _ascii_spill_dir;
+        boost::posix_time::ptime _ascii_frames_start;
+        size_t _ascii_frames_nt;
+
+        // true once pack_ascii has freed the per-station timeseries
+        bool _ascii_released;
+
+        // union of the variables in all the ascii files, and their hashes for direct station access
+        std::vector<std::string> _ascii_variables;
+        std::vector<uint64_t> _ascii_variable_hash;
+
+        // per station, the indexes into _ascii_variables that are present in that station's file
+        std::vector< std::vector<size_t> > _ascii_station_variables;
+
+        // per station, the ascii proxy that holds its filters
+        std::vector<ascii_data*> _ascii_proxy;
+
         //Essentially what the old stations turned into.
         // Holds all the met data to init that stations + the underlying timeseries data
         // Mapped w/ stations ID -> metdata
@@ -167,28 +167,31 @@ void Harder_precip_phase::checkpoint(mesh& domain,  netcdf& chkpt)
     chkpt.create_variable1D("Harder_precip_phase:acc_rain", domain->size_faces());
     chkpt.create_variable1D("Harder_precip_phase:acc_snow", domain->size_faces());
 
-    for (size_t i = 0; i < domain->size_faces(); i++)
-    {
-        auto face = domain->face(i);
-        chkpt.put_var1D("Harder_precip_phase:hours_since_snowfall",i,face->get_module_data<data>(ID).hours_since_snowfall);
-        chkpt.put_var1D("Harder_precip_phase:acc_rain",i,face->get_module_data<data>(ID).acc_rain);
-        chkpt.put_var1D("Harder_precip_phase:acc_snow",i,face->get_module_data<data>(ID).acc_snow);
-    }
+    put_checkpoint_var(domain, chkpt, "Harder_precip_phase:hours_since_snowfall",
+                       [&](mesh_elem& face) { return face->get_module_data<data>(ID).hours_since_snowfall; });
+    put_checkpoint_var(domain, chkpt, "Harder_precip_phase:acc_rain",
+                       [&](mesh_elem& face) { return face->get_module_data<data>(ID).acc_rain; });
+    put_checkpoint_var(domain, chkpt, "Harder_precip_phase:acc_snow",
+                       [&](mesh_elem& face) { return face->get_module_data<data>(ID).acc_snow; });
 
 }
 void Harder_precip_phase::load_checkpoint(mesh& domain, netcdf& chkpt)
 {
 
-    for (size_t i = 0; i < domain->size_faces(); i++)
-    {
-        auto face = domain->face(i);
-        face->get_module_data<data>(ID).hours_since_snowfall = chkpt.get_var1D("Harder_precip_phase:hours_since_snowfall",i);
-        face->get_module_data<data>(ID).acc_rain = chkpt.get_var1D("Harder_precip_phase:acc_rain",i);
-        face->get_module_data<data>(ID).acc_snow = chkpt.get_var1D("Harder_precip_phase:acc_snow",i);
-
-        (*face)["acc_rain"_s]=face->get_module_data<data>(ID).acc_rain;
-        (*face)["acc_snow"_s]=face->get_module_data<data>(ID).acc_snow;
-    }
+    get_checkpoint_var(domain, chkpt, "Harder_precip_phase:hours_since_snowfall",
+                       [&](mesh_elem& face, double value) { face->get_module_data<data>(ID).hours_since_snowfall = value; });
+    get_checkpoint_var(domain, chkpt, "Harder_precip_phase:acc_rain",
+                       [&](mesh_elem& face, double value)
+                       {
+                           face->get_module_data<data>(ID).acc_rain = value;
+                           (*face)["acc_rain"_s] = value;
+                       });
+    get_checkpoint_var(domain, chkpt, "Harder_precip_phase:acc_snow",
+                       [&](mesh_elem& face, double value)
+                       {
+                           face->get_module_data<data>(ID).acc_snow = value;
+                           (*face)["acc_snow"_s] = value;
+                       });
 
 
 }
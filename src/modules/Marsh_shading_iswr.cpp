@@ -34,187 +34,261 @@ Marsh_shading_iswr::Marsh_shading_iswr(config_file cfg)
     provides("shadow");
     provides("z_prime");
 
-    x_AABB = cfg.get<int>("x_AABB",10);
-    y_AABB = cfg.get<int>("y_AABB",10);
+    resolution = cfg.get<double>("resolution",0);
     SPDLOG_DEBUG("Successfully instantiated module {}",this->ID);
 
 }
 
-void Marsh_shading_iswr::run(mesh& domain)
+void Marsh_shading_iswr::init(mesh& domain)
 {
+    h_shadow = handle(domain, "shadow");
+    h_z_prime = handle(domain, "z_prime");
+    h_solar_az = handle(domain, "solar_az");
+    h_solar_el = handle(domain, "solar_el");
+}
 
+void Marsh_shading_iswr::run(mesh& domain)
+{
+    const size_t n = domain->size_faces();
 
-    //compute the rotation of each vertex
-
-    //    tbb::concurrent_vector<triangulation::Face_handle> rot_faces;
-    //    rot_faces.grow_by(domain->size());
-
-#pragma omp parallel for
-    for (size_t i = 0; i < domain->size_vertex(); i++)
+    // The projection is parallel, so use a single solar vector for the domain, the mean of the faces'
+    double sx = 0, sy = 0, sz = 0;
+    #pragma omp parallel for reduction(+:sx,sy,sz)
+    for (size_t i = 0; i < n; i++)
     {
-        auto vert = domain->vertex(i);
-
-        double A =  (*vert->face())["solar_az"_s];
-        double E = (*vert->face())["solar_el"_s];
-
-
-        //euler rotation matrix K
-        arma::mat K;
-        // eqns(6) & (7) in Montero
-        double z0 = M_PI - A * M_PI / 180.0;
-        double q0 = M_PI / 2.0 - E * M_PI / 180.0;
-
-        K << cos(z0) << sin(z0) << 0 << arma::endr
-         << -cos(q0) * sin(z0) << cos(q0) * cos(z0) << sin(q0) << arma::endr
-         << sin(q0) * sin(z0) << -cos(z0) * sin(q0) << cos(q0) << arma::endr;
+        auto face = domain->face(i);
+        double A = face->get(h_solar_az) * M_PI / 180.0;
+        double E = face->get(h_solar_el) * M_PI / 180.0;
 
+        sx += cos(E) * sin(A);
+        sy += cos(E) * cos(A);
+        sz += sin(E);
+    }
+    double A = atan2(sx, sy);
+    double E = atan2(sz, sqrt(sx * sx + sy * sy));
 
-        auto vf = vert->make_module_data<vertex_data>(ID);
+    //euler rotation matrix K
+    // eqns(6) & (7) in Montero
+    double z0 = M_PI - A;
+    double q0 = M_PI / 2.0 - E;
 
-        arma::vec coord(3);
+    const double K[3][3] = {{cos(z0), sin(z0), 0},
+                            {-cos(q0) * sin(z0), cos(q0) * cos(z0), sin(q0)},
+                            {sin(q0) * sin(z0), -cos(z0) * sin(q0), cos(q0)}};
 
-        Point_3 p;
-        coord(0) = vert->point().x();
-        coord(1) = vert->point().y();
-        coord(2) = vert->point().z();
+    // rotate the vertices of each face into the solar frame. z' increases towards the sun
+    prj.resize(9 * n);
+    active.resize(n);
 
-        coord = K*coord;
-        p = Point_3(coord(0), coord(1), coord(2));
-        vf->prj_vertex = p;
-        vf->org_vertex = vert->point();
+    double xmin = std::numeric_limits<double>::max(), ymin = std::numeric_limits<double>::max();
+    double xmax = std::numeric_limits<double>::lowest(), ymax = std::numeric_limits<double>::lowest();
 
-        vert->set_point(vf->prj_vertex); //modify the underlying triangulation to reflect the rotated vertices
+    #pragma omp parallel for reduction(min:xmin,ymin) reduction(max:xmax,ymax)
+    for (size_t i = 0; i < n; i++)
+    {
+        auto face = domain->face(i);
+
+        // low sun angles are left unshadowed and do not shadow anything else
+        active[i] = face->get(h_solar_el) >= 5;
+
+        for (int v = 0; v < 3; v++)
+        {
+            auto& p = face->vertex(v)->point();
+            double* out = &prj[9 * i + 3 * v];
+
+            for (int r = 0; r < 3; r++)
+                out[r] = K[r][0] * p.x() + K[r][1] * p.y() + K[r][2] * p.z();
+
+            if (active[i])
+            {
+                xmin = std::min(xmin, out[0]);
+                xmax = std::max(xmax, out[0]);
+                ymin = std::min(ymin, out[1]);
+                ymax = std::max(ymax, out[1]);
+            }
+        }
     }
 
-    auto BBR = domain->AABB(x_AABB,y_AABB);
-
-    #pragma omp parallel for
-    for (size_t i = 0; i < domain->size_faces(); i++)
+    if (xmin > xmax)
     {
-      auto face = domain->face(i);
-      double E = (*domain->face(i))["solar_el"_s];
-      if (E < 5)
-      {
-	(*face)["z_prime"_s]= 0; //unshadowed
-	(*face)["shadow"_s]= 0;
-	continue;
-      }
-
-	       for (size_t j = 0; j < BBR->n_rows; j++)
-	       {
-		   for (size_t k = 0; k < BBR->n_cols; k++)
-		   {
-
-		       if (BBR->pt_in_rect(face->vertex(0), BBR->get_rect(j, k)) || //pt1
-			   BBR->pt_in_rect(face->vertex(1), BBR->get_rect(j, k)) || //pt2
-			   BBR->pt_in_rect(face->vertex(2), BBR->get_rect(j, k))) //pt3
-		       {
-			   //#pragma omp critical
-			   //                    {
-			   BBR->get_rect(j, k)->triangles.push_back(face);
-			   //                    }
-		       }
-		   }
-	       }
-	       //init memory
-	       auto& tv = face->make_module_data<module_shadow_face_info>(ID);
-	       // module_shadow_face_info* tv = new module_shadow_face_info;
-	       //face->set_module_data(ID, tv);
-	       tv.z_prime = CGAL::centroid(face->vertex(0)->point(), face->vertex(1)->point(), face->vertex(2)->point()).z();
+        // nothing is lit
+        #pragma omp parallel for
+        for (size_t i = 0; i < n; i++)
+        {
+            domain->face(i)->get(h_shadow) = 0;
+            domain->face(i)->get(h_z_prime) = 0;
+        }
+        return;
+    }
 
+    // size the depth buffer
+    double cell = resolution;
+    if (cell <= 0)
+    {
+        auto& area = domain->geometry().area;
+        double mean_area = 0;
+        #pragma omp parallel for reduction(+:mean_area)
+        for (size_t i = 0; i < n; i++)
+            mean_area += area[i];
+        mean_area /= n;
+
+        cell = 0.5 * sqrt(mean_area);
     }
 
+    const double max_cells = 1 << 27;
+    cell = std::max(cell, sqrt((xmax - xmin) * (ymax - ymin) / max_cells));
 
-//    LOG_DEBUG << "AABB is " <<BBR->n_rows << "x" << BBR->n_rows;
-//    for (size_t j = 0; j < BBR->n_rows; j++)
-//    {
-//        for (size_t k = 0; k < BBR->n_cols; k++)
-//        {
-//            LOG_DEBUG << BBR->get_rect(j, k)->triangles.size();
-//        }
-//    }
+    const size_t nx = static_cast<size_t>((xmax - xmin) / cell) + 1;
+    const size_t ny = static_cast<size_t>((ymax - ymin) / cell) + 1;
 
+    zbuf.assign(nx * ny, std::numeric_limits<double>::lowest());
 
+    // the raster is split into bands of rows that are filled independently. Bin the faces by the rows they cover
+    const size_t band_rows = 32;
+    const size_t nbands = (ny + band_rows - 1) / band_rows;
 
-#pragma omp parallel for
-    for (size_t i = 0; i < BBR->n_rows; i++)
+    auto row_range = [&](size_t i, size_t& r0, size_t& r1)
     {
+        const double* p = &prj[9 * i];
+        double lo = std::min({p[1], p[4], p[7]});
+        double hi = std::max({p[1], p[4], p[7]});
 
-	       for (size_t ii = 0; ii < BBR->n_cols; ii++)
-	       {
-		   //sort descending
-		   tbb::parallel_sort(BBR->get_rect(i, ii)->triangles.begin(), BBR->get_rect(i, ii)->triangles.end(),
-				      [](triangulation::Face_handle fa, triangulation::Face_handle fb)->bool
-				      {
-					auto& fa_info = fa->get_module_data<module_shadow_face_info>(
-												    "Marsh_shading_iswr");
-					auto& fb_info = fb->get_module_data<module_shadow_face_info>(
-												    "Marsh_shading_iswr");
-
-					return fa_info.z_prime > fb_info.z_prime;
-				      });
-
-		   size_t num_tri = BBR->get_rect(i, ii)->triangles.size();
-
-
-		   for (size_t j = 0; j < num_tri; j++)
-		   {
-		       triangulation::Face_handle face_j = BBR->get_rect(i, ii)->triangles.at(j);
-
-		       K::Triangle_2 tj(K::Point_2(face_j->vertex(0)->point().x(), face_j->vertex(0)->point().y()),
-					K::Point_2(face_j->vertex(1)->point().x(), face_j->vertex(1)->point().y()),
-					K::Point_2(face_j->vertex(2)->point().x(), face_j->vertex(2)->point().y()));
-
-		       CGAL::Bbox_2 bj(tj.bbox());
-		       //compare to other triangles
-
-		       for (size_t k = j + 1; k < num_tri; k++)
-		       {
-			   triangulation::Face_handle face_k = BBR->get_rect(i, ii)->triangles.at(k);
-			   auto& face_k_info = face_k->get_module_data<module_shadow_face_info>(ID);
-
-			   if (face_k_info.shadow == 0)
-			   {
-			       //not needed as our sort will ensure face_j > face_k
-			       if(face_j->get_z() > face_k->get_z())  //tj is above tk, and tk is shadded by tj?)
-			       {
-				   K::Triangle_2 tk(K::Point_2(face_k->vertex(0)->point().x(), face_k->vertex(0)->point().y()),
-						    K::Point_2(face_k->vertex(1)->point().x(), face_k->vertex(1)->point().y()),
-						    K::Point_2(face_k->vertex(2)->point().x(), face_k->vertex(2)->point().y()));
-
-				   CGAL::Bbox_2 bk(tk.bbox());
-
-				   if (CGAL::do_overlap(bk, bj)) {
-				     bool collision = face_k->intersects(face_j);
-				     if (collision) {
-				       face_k_info.shadow = 1;
-				     }
-				   }
-			       }
-			   }
-		       }
-
-		       auto& face_info = face_j->get_module_data<module_shadow_face_info>(ID);
-		       (*face_j)["shadow"_s] = face_info.shadow;
-		       (*face_j)["z_prime"_s]= face_info.z_prime;
-		   }
-	       }
+        // rows whose cell centres can fall in [lo, hi]
+        r0 = static_cast<size_t>(std::max(0.0, std::ceil((lo - ymin) / cell - 0.5)));
+        r1 = std::min(ny, static_cast<size_t>(std::max(0.0, std::floor((hi - ymin) / cell - 0.5) + 1)));
+    };
+
+    band_ptr.assign(nbands + 1, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t r0, r1;
+        row_range(i, r0, r1);
+        if (!active[i] || r0 >= r1)
+            continue;
 
+        for (size_t b = r0 / band_rows; b <= (r1 - 1) / band_rows; b++)
+            band_ptr[b + 1]++;
     }
+    for (size_t b = 0; b < nbands; b++)
+        band_ptr[b + 1] += band_ptr[b];
 
+    band_faces.resize(band_ptr.back());
+    {
+        std::vector<size_t> fill(band_ptr.begin(), band_ptr.end() - 1);
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t r0, r1;
+            row_range(i, r0, r1);
+            if (!active[i] || r0 >= r1)
+                continue;
+
+            for (size_t b = r0 / band_rows; b <= (r1 - 1) / band_rows; b++)
+                band_faces[fill[b]++] = i;
+        }
+    }
 
-    // here we need to 'undo' the rotation we applied.
-#pragma omp parallel for
-    for (size_t i = 0; i < domain->size_vertex(); i++)
+    // z' of face i's plane at x,y. Also returns the plane gradient
+    auto plane = [&](size_t i, double x, double y, double& gx, double& gy)
     {
+        const double* p = &prj[9 * i];
+        double det = (p[3] - p[0]) * (p[7] - p[1]) - (p[6] - p[0]) * (p[4] - p[1]);
 
-        auto vert = domain->vertex(i);
-        auto  vf = vert->get_module_data<vertex_data>(ID);
-        vert->set_point(vf->org_vertex);
+        if (std::fabs(det) < 1e-12)
+        {
+            // edge on to the sun
+            gx = gy = 0;
+            return std::max({p[2], p[5], p[8]});
+        }
 
-    }
+        gx = ((p[5] - p[2]) * (p[7] - p[1]) - (p[8] - p[2]) * (p[4] - p[1])) / det;
+        gy = ((p[8] - p[2]) * (p[3] - p[0]) - (p[5] - p[2]) * (p[6] - p[0])) / det;
 
+        return p[2] + gx * (x - p[0]) + gy * (y - p[1]);
+    };
 
+    // fill the depth buffer with the surface closest to the sun
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < nbands; b++)
+    {
+        size_t band_r0 = b * band_rows;
+        size_t band_r1 = std::min(ny, band_r0 + band_rows);
+
+        for (size_t k = band_ptr[b]; k < band_ptr[b + 1]; k++)
+        {
+            size_t i = band_faces[k];
+            const double* p = &prj[9 * i];
+
+            size_t r0, r1;
+            row_range(i, r0, r1);
+            r0 = std::max(r0, band_r0);
+            r1 = std::min(r1, band_r1);
+
+            double lo = std::min({p[0], p[3], p[6]});
+            double hi = std::max({p[0], p[3], p[6]});
+            size_t c0 = static_cast<size_t>(std::max(0.0, std::ceil((lo - xmin) / cell - 0.5)));
+            size_t c1 = std::min(nx, static_cast<size_t>(std::max(0.0, std::floor((hi - xmin) / cell - 0.5) + 1)));
+
+            // orientation of the projected triangle, so the inside test works for either winding
+            double det = (p[3] - p[0]) * (p[7] - p[1]) - (p[6] - p[0]) * (p[4] - p[1]);
+            if (det == 0)
+                continue;
+            double sign = det > 0 ? 1 : -1;
+
+            for (size_t r = r0; r < r1; r++)
+            {
+                double y = ymin + (r + 0.5) * cell;
+                for (size_t c = c0; c < c1; c++)
+                {
+                    double x = xmin + (c + 0.5) * cell;
+
+                    double w0 = sign * ((p[3] - x) * (p[7] - y) - (p[6] - x) * (p[4] - y));
+                    double w1 = sign * ((p[6] - x) * (p[1] - y) - (p[0] - x) * (p[7] - y));
+                    double w2 = sign * ((p[0] - x) * (p[4] - y) - (p[3] - x) * (p[1] - y));
+
+                    if (w0 < 0 || w1 < 0 || w2 < 0)
+                        continue;
+
+                    double gx, gy;
+                    double z = plane(i, x, y, gx, gy);
+
+                    double& d = zbuf[r * nx + c];
+                    d = std::max(d, z);
+                }
+            }
+        }
+    }
+
+    // a face is shadowed if something closer to the sun covers its centroid
+    #pragma omp parallel for
+    for (size_t i = 0; i < n; i++)
+    {
+        auto face = domain->face(i);
+
+        if (!active[i])
+        {
+            face->get(h_shadow) = 0;
+            face->get(h_z_prime) = 0; //unshadowed
+            continue;
+        }
+
+        const double* p = &prj[9 * i];
+        double cx = (p[0] + p[3] + p[6]) / 3.0;
+        double cy = (p[1] + p[4] + p[7]) / 3.0;
+        double cz = (p[2] + p[5] + p[8]) / 3.0;
+
+        size_t c = std::min(nx - 1, static_cast<size_t>((cx - xmin) / cell));
+        size_t r = std::min(ny - 1, static_cast<size_t>((cy - ymin) / cell));
+
+        // compare against this face's own depth at the cell centre. Neighbouring faces on a continuous surface can
+        // differ by up to the change across half a cell, so allow for that. The gradient is capped so that faces near
+        // edge on to the sun can still be shadowed by distant terrain
+        double gx, gy;
+        double z_self = plane(i, xmin + (c + 0.5) * cell, ymin + (r + 0.5) * cell, gx, gy);
+        double bias = 0.5 * cell * std::min(std::fabs(gx) + std::fabs(gy), 4.0) + 1e-6;
+
+        face->get(h_shadow) = zbuf[r * nx + c] > z_self + bias ? 1 : 0;
+        face->get(h_z_prime) = cz;
+    }
 }
 
 Marsh_shading_iswr::~Marsh_shading_iswr()
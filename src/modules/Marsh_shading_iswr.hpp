@@ -27,34 +27,13 @@
 #include "triangulation.hpp"
 #include "module_base.hpp"
 
-#include <cstdlib>
 #include <string>
-#include <utility> //for pair
 #include <vector>
 #include <cmath>
-#include <armadillo>
+#include <limits>
+#include <algorithm>
 #define _USE_MATH_DEFINES
 #include <math.h>
-#include "tbb/parallel_sort.h"
-
-struct module_shadow_face_info :  face_info
-{
-    module_shadow_face_info()
-    {
-        shadow = 0;
-        z_prime = 0;
-    }
-
-    int shadow;
-    double z_prime;
-};
-
-struct vertex_data : vertex_info
-{
-
-    Point_3 prj_vertex;
-    Point_3 org_vertex;
-};
 
 /**
  * \ingroup modules iswr
@@ -64,6 +43,11 @@ struct vertex_data : vertex_info
  * Computes the horizon-shadows using the parallel point plane projection from Marsh, et al (2011). The :ref:`fast_shadow` routine
  * provides almost as good of a result with less computational overhead.
  *
+ * Every face is projected along the mean solar vector onto a plane normal to the sun. The projected faces are
+ * rasterised into a depth buffer that keeps, for each cell, the surface closest to the sun. A face is shadowed if the
+ * buffer at its centroid holds a surface closer to the sun than the face itself. The mesh is not modified, and the
+ * raster is processed as independent bands of rows in parallel so the cost grows linearly with the number of faces.
+ *
  * **Depends:**
  * - Solar azimuth "solar_az" [degrees]
  * - Solar elevation "solar_el" [degrees]
@@ -78,30 +62,17 @@ struct vertex_data : vertex_info
  * .. code:: json
  *
  *    {
- *       "x_AABB":10,
- *       "y_AABB":10
+ *       "resolution": 0
  *    }
  *
+ * .. confval:: resolution
  *
- *    The domain is split into an x/y grid in projection space.
- *    Triangles are only compared to triangles in their bin to compute shadows. Thus, the smaller the value the
- *    more chance of missing a triangle intersection. It also decreases the number of comparisons and can dramatically
- *    decrease the computational time.
- *
- * .. confval:: x_AABB
+ *    :type: double
+ *    :default: 0
  *
- *    :type: int
- *    :default: 10
- *
- *    This is the size number of bins in the x direction.
- *
- *
- * .. confval:: y_AABB
- *
- *    :type: int
- *    :default: 10
- *
- *    This is the size number of bins in the y direction.
+ *    Size of a depth buffer cell in the projection plane [m]. Faces smaller than a cell may be missed as occluders.
+ *    ``0`` uses half of the square root of the mean face area. The cell size is increased if needed to keep the
+ *    buffer below 2^27 cells.
  *
  * \endrst
  * Reference:
@@ -115,9 +86,26 @@ REGISTER_MODULE_HPP(Marsh_shading_iswr);
         Marsh_shading_iswr(config_file cfg);
         ~Marsh_shading_iswr();
         virtual void run(mesh& domain);
+        virtual void init(mesh& domain);
+
+    private:
+        // depth buffer cell size, 0 for automatic
+        double resolution;
+
+        // projected vertices of each face, [face][vertex][x', y', z']
+        std::vector<double> prj;
+
+        // faces with the sun high enough to be considered
+        std::vector<char> active;
+
+        // depth buffer, z' of the surface closest to the sun in each cell
+        std::vector<double> zbuf;
+
+        // faces overlapping each band of raster rows, CSR
+        std::vector<size_t> band_ptr;
+        std::vector<size_t> band_faces;
 
-    int x_AABB;
-    int y_AABB;
+        var_handle h_shadow, h_z_prime, h_solar_az, h_solar_el;
 };
 
 /**
@@ -102,6 +102,9 @@ double my_fill_topo3(double x, void* p)
 
 PBSM3D::PBSM3D(config_file cfg) : module_base("PBSM3D", parallel::domain, cfg)
 {
+    // exchanges ghost halos in run()
+    barrier();
+
     depends("U_2m_above_srf");
     depends("vw_dir");
     depends("swe");
@@ -220,6 +223,66 @@ PBSM3D::PBSM3D(config_file cfg) : module_base("PBSM3D", parallel::domain, cfg)
 
 void PBSM3D::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_U_2m_above_srf = handle(domain, "U_2m_above_srf");
+    h_vw_dir = handle(domain, "vw_dir");
+    h_swe = handle(domain, "swe");
+    h_t = handle(domain, "t");
+    h_rh = handle(domain, "rh");
+    h_U_R = handle(domain, "U_R");
+    h_snowdepthavg = handle(domain, "snowdepthavg");
+
+    h_pbsm_more_than_avail = handle(domain, "pbsm_more_than_avail");
+    h_global_cell_id = handle(domain, "global_cell_id");
+    h_blowingsnow_probability = handle(domain, "blowingsnow_probability");
+    h_Qsubl = handle(domain, "Qsubl");
+    h_Qsubl_mass = handle(domain, "Qsubl_mass");
+    h_sum_subl = handle(domain, "sum_subl");
+    h_drift_mass = handle(domain, "drift_mass");
+    h_Qsusp = handle(domain, "Qsusp");
+    h_Qsalt = handle(domain, "Qsalt");
+    h_sum_drift = handle(domain, "sum_drift");
+
+    if (use_exp_fetch || use_tanh_fetch)
+        h_fetch = handle(domain, "fetch");
+    if (!(use_exp_fetch || use_tanh_fetch) || use_PomLi_probability)
+        h_p_snow_hours = handle(domain, "p_snow_hours");
+
+    if (debug_output)
+    {
+        h_is_drifting = handle(domain, "is_drifting");
+        h_Km_coeff = handle(domain, "Km_coeff");
+        h_Qsusp_pbsm = handle(domain, "Qsusp_pbsm");
+        h_height_diff = handle(domain, "height_diff");
+        h_w = handle(domain, "w");
+        h_hs = handle(domain, "hs");
+        h_ustar = handle(domain, "ustar");
+        h_l = handle(domain, "l");
+        h_z0 = handle(domain, "z0");
+        h_lambda = handle(domain, "lambda");
+        h_U_10m = handle(domain, "U_10m");
+        h_csalt = handle(domain, "csalt");
+        h_csalt_orig = handle(domain, "csalt_orig");
+        h_csalt_reset = handle(domain, "csalt_reset");
+        h_mass_qsalt = handle(domain, "mass_qsalt");
+        h_c_salt_fetch_big = handle(domain, "c_salt_fetch_big");
+        h_tau_n_ratio = handle(domain, "tau_n_ratio");
+        h_mm = handle(domain, "mm");
+    }
+
+    if (use_subgrid_topo || use_subgrid_topo_V2)
+    {
+        h_frac_contrib = handle(domain, "frac_contrib");
+        h_hold_topo = handle(domain, "hold_topo");
+    }
+    if (use_subgrid_topo)
+        h_frac_contrib_nosnw = handle(domain, "frac_contrib_nosnw");
+    if (use_subgrid_topo_V2)
+    {
+        h_test_int = handle(domain, "test_int");
+        h_tpi_lim = handle(domain, "tpi_lim");
+    }
+
     nLayer = cfg.get("nLayer", 10);
 
     susp_depth = 5;                      // 5m as per pomeroy
@@ -388,12 +451,18 @@ void PBSM3D::init(mesh& domain)
         d.sum_drift = 0;
         d.sum_subl = 0;
         d.csubl.resize(nLayer);
-        (*face)["sum_drift"_s]=0;
+        face->get(h_sum_drift)=0;
 
     }
 
-    suspension_NNP.reset(new math::LinearAlgebra::NearestNeighborProblem(domain,nLayer));
-    deposition_NNP.reset(new math::LinearAlgebra::NearestNeighborProblem(domain));
+    math::LinearAlgebra::SolverOptions solver_options;
+    solver_options.preconditioner = cfg.get<std::string>("preconditioner", "ilut");
+    solver_options.preconditioner_reuse = cfg.get("preconditioner_reuse", 1);
+    solver_options.reuse_iteration_growth = cfg.get("preconditioner_reuse_iteration_growth", 2.0);
+    solver_options.warm_start = cfg.get("warm_start", false);
+
+    suspension_NNP.reset(new math::LinearAlgebra::NearestNeighborProblem(domain, nLayer, solver_options));
+    deposition_NNP.reset(new math::LinearAlgebra::NearestNeighborProblem(domain, 1, solver_options));
 
 }
 
@@ -404,7 +473,6 @@ void PBSM3D::run(mesh& domain)
 
     // needed for linear system offsets
     size_t ntri = domain->size_faces();
-    size_t n_global_tri = domain->size_global_faces();
 
     suspension_NNP->zeroSystem();
     deposition_NNP->zeroSystem();
@@ -435,18 +503,18 @@ void PBSM3D::run(mesh& domain)
 
             double fetch = 1000;
             if (use_exp_fetch || use_tanh_fetch)
-                fetch = (*face)["fetch"_s];
+                fetch = face->get(h_fetch);
 
             double frac_contrib = 1.;       // Default value for the fraction of the grid contributing to snow transport
             double frac_contrib_nosnw = 1.; // Default value for the fraction of the grid contributing to snow transport
             double min_sd_trans_avg = min_sd_trans; // Grid-averaged value for the topographic subgrid holding capacity
 
             // get wind from the face
-            double uref = (*face)["U_R"_s];
-            double snow_depth = (*face)["snowdepthavg"_s];
+            double uref = face->get(h_U_R);
+            double snow_depth = face->get(h_snowdepthavg);
             snow_depth = is_nan(snow_depth) ? 0 : snow_depth;
 
-            double u2 = (*face)["U_2m_above_srf"_s];
+            double u2 = face->get(h_U_2m_above_srf);
             double z10; // 10-m height above the snow surface
             z10 = 10. + snow_depth;
 
@@ -463,9 +531,9 @@ void PBSM3D::run(mesh& domain)
             }
 
             if (debug_output)
-                (*face)["U_10m"_s] = u10;
+                face->get(h_U_10m) = u10;
 
-            double swe = (*face)["swe"_s]; // mm   -->    kg/m^2
+            double swe = face->get(h_swe); // mm   -->    kg/m^2
             swe = is_nan(swe) ? 0 : swe;   // handle the first timestep where swe won't have been
             // updated if we override the module order
 
@@ -474,7 +542,7 @@ void PBSM3D::run(mesh& domain)
             if (!enable_veg)
                 height_diff = 0;
             if (debug_output)
-                (*face)["height_diff"_s] = height_diff;
+                face->get(h_height_diff) = height_diff;
 
             // Topographic holding capacity associated with subgrid topographic features
             // This method combines the distribution of TPI with a filling function to obtain
@@ -545,7 +613,7 @@ void PBSM3D::run(mesh& domain)
                         int code = gsl_integration_qags(&d.F_fill, -50, 50, 0, 1e-7, 1000, w, &result, &error);
                         gsl_integration_workspace_free(w);
 
-                        (*face)["test_int"_s] = result;
+                        face->get(h_test_int) = result;
 
                         // Determine TPI threshold above which gullies are considered as filled.
                         auto frootFn = [&](double xx) -> double {
@@ -591,9 +659,9 @@ void PBSM3D::run(mesh& domain)
                     // Determine fraction of the triangle that contributes to snow transport
                     frac_contrib = gsl_cdf_gaussian_Q(tpi_lim - moy_tpi, std_tpi);
                 }
-                (*face)["tpi_lim"_s] = tpi_lim;
-                (*face)["frac_contrib"_s] = frac_contrib;
-                (*face)["hold_topo"_s] = min_sd_trans_avg;
+                face->get(h_tpi_lim) = tpi_lim;
+                face->get(h_frac_contrib) = frac_contrib;
+                face->get(h_hold_topo) = min_sd_trans_avg;
             }
 
             // Topographic holding capacity associated with subgrid topographic features
@@ -639,9 +707,9 @@ void PBSM3D::run(mesh& domain)
                         }
                     }
                 }
-                (*face)["frac_contrib"_s] = frac_contrib;
-                (*face)["frac_contrib_nosnw"_s] = frac_contrib_nosnw;
-                (*face)["hold_topo"_s] = min_sd_trans_avg;
+                face->get(h_frac_contrib) = frac_contrib;
+                face->get(h_frac_contrib_nosnw) = frac_contrib_nosnw;
+                face->get(h_hold_topo) = min_sd_trans_avg;
             }
 
             double ustar = 1.3; // placeholder
@@ -667,7 +735,7 @@ void PBSM3D::run(mesh& domain)
             // threshold friction velocity. Compute here as it's used below as well
             // Pomeroy and Li, 2000
             // Eqn 7
-            double T = (*face)["t"_s];
+            double T = face->get(h_t);
             double u_star_saltation_threshold =
                 0.35 + (1.0 / 150.0) * T + (1.0 / 8200.0) * T * T; // saltation threshold m/s
             if (debug_output)
@@ -686,7 +754,7 @@ void PBSM3D::run(mesh& domain)
                     lambda = d.N * d.dv * height_diff; // Pomeroy formulation
 
                 if (debug_output)
-                    (*face)["lambda"_s] = lambda;
+                    face->get(h_lambda) = lambda;
 
                 if (z0_ustar_coupling)
                 {
@@ -753,9 +821,9 @@ void PBSM3D::run(mesh& domain)
             d.z0 = std::max(Snow::Z0_SNOW, d.z0);
             ustar = std::max(0.01, ustar);
             if (debug_output)
-                (*face)["ustar"_s] = ustar;
+                face->get(h_ustar) = ustar;
             if (debug_output)
-                (*face)["z0"_s] = d.z0;
+                face->get(h_z0) = d.z0;
 
             // depth of saltation layer
             double hs = 0;
@@ -764,15 +832,15 @@ void PBSM3D::run(mesh& domain)
 
             d.hs = hs;
             if (debug_output)
-                (*face)["hs"_s] = hs;
+                face->get(h_hs) = hs;
             if (debug_output)
-                (*face)["is_drifting"_s] = 0;
+                face->get(h_is_drifting) = 0;
             if (debug_output)
-                (*face)["Qsusp_pbsm"_s] = 0; // for santiy checks against pbsm
+                face->get(h_Qsusp_pbsm) = 0; // for santiy checks against pbsm
 
             double Qsalt = 0;
             double c_salt = 0;
-            double t = (*face)["t"_s] + 273.15;
+            double t = face->get(h_t) + 273.15;
 
             // Check if we can blow snow in this triagnle
             // Are we above saltation threshold?
@@ -786,16 +854,16 @@ void PBSM3D::run(mesh& domain)
                             t); // air density kg/m^3, comment in mio is wrong.1.225;
 
                 if (debug_output)
-                    (*face)["blowingsnow_probability"_s] = 0; // default to 0%
+                    face->get(h_blowingsnow_probability) = 0; // default to 0%
 
                 if (debug_output)
                 {
                     double pbsm_qsusp = pow(u10, 4.13) / 674100.0;
-                    (*face)["Qsusp_pbsm"_s] = pbsm_qsusp;
+                    face->get(h_Qsusp_pbsm) = pbsm_qsusp;
                 }
 
                 if (debug_output)
-                    (*face)["is_drifting"_s] = 1;
+                    face->get(h_is_drifting) = 1;
 
                 // Pomeroy and Li 2000, eqn 8
                 double Beta = 202.0; // 170.0;
@@ -807,7 +875,7 @@ void PBSM3D::run(mesh& domain)
                 double tau_n_ratio = (m * Beta * lambda) / (1.0 + m * Beta * lambda);
 
                 if (debug_output)
-                    (*face)["tau_n_ratio"_s] = tau_n_ratio;
+                    face->get(h_tau_n_ratio) = tau_n_ratio;
 
                 // Pomeroy 1992, eqn 12, see note above for ustar_n calc, but ustar_n
                 // is correctly squared already
@@ -824,7 +892,7 @@ void PBSM3D::run(mesh& domain)
                 }
 
                 if (debug_output)
-                    (*face)["c_salt_fetch_big"_s] = c_salt;
+                    face->get(h_c_salt_fetch_big) = c_salt;
 
                 // exp decay of Liston, eq 10
                 // 95% of max saltation occurs at fetch = 500m
@@ -850,7 +918,7 @@ void PBSM3D::run(mesh& domain)
                 {
                     //    1.Essery, R., Li, L. & Pomeroy, J. A distributed model of blowing snow over complex terrain. Hydrological Processes 13, 2423–2438 (1999).
                     // Probability of blowing snow
-                    double A = (*face)["p_snow_hours"_s];                              // hours since last snowfall
+                    double A = face->get(h_p_snow_hours);                              // hours since last snowfall
                     double u_mean = 11.2 + 0.365 * T + 0.00706 * T * T + 0.9 * log(A); // eqn 10  T -> air temp, degC
                     double delta = 0.145 * T + 0.00196 * T * T + 4.3;                  // eqn 11
 
@@ -858,7 +926,7 @@ void PBSM3D::run(mesh& domain)
                     double us = u10 / sqrt((1+340.0*z0v));         // eqn 13
 
                     double Pu10 = 1.0 / (1.0 + exp((sqrt(M_PI) * (u_mean - us)) / delta)); // eqn 12
-                    (*face)["blowingsnow_probability"_s] = Pu10;
+                    face->get(h_blowingsnow_probability) = Pu10;
 
                     // decrease the saltation by the probability amount
                     c_salt *= Pu10;
@@ -877,7 +945,7 @@ void PBSM3D::run(mesh& domain)
                 Qsalt = c_salt * uhs * hs; // integrate over the depth of the saltation layer, kg/(m*s)
 
                 double mass = 0;
-                double phi = (*face)["vw_dir"_s];
+                double phi = face->get(h_vw_dir);
                 Vector_2 v = -math::gis::bearing_to_cartesian(phi);
 
                 // setup wind vector
@@ -903,8 +971,8 @@ void PBSM3D::run(mesh& domain)
 
                 if (debug_output)
                 {
-                    (*face)["csalt_orig"_s] = c_salt;
-                    (*face)["mass_qsalt"_s] = mass;
+                    face->get(h_csalt_orig) = c_salt;
+                    face->get(h_mass_qsalt) = mass;
                 }
 
                 if (mass < 0 && std::fabs(mass) > swe)
@@ -915,16 +983,16 @@ void PBSM3D::run(mesh& domain)
                     Qsalt = c_salt * uhs * hs; // integrate over the depth of the saltation layer, kg/(m*s)
 
                     if (debug_output)
-                        (*face)["csalt_reset"_s] = c_salt;
+                        face->get(h_csalt_reset) = c_salt;
                 }
             }
 
             if (debug_output)
-                (*face)["csalt"_s] = c_salt;
+                face->get(h_csalt) = c_salt;
 
-            (*face)["Qsalt"_s] = Qsalt;
+            face->get(h_Qsalt) = Qsalt;
 
-            double rh = (*face)["rh"_s] / 100.;
+            double rh = face->get(h_rh) / 100.;
             double es = Atmosphere::saturatedVapourPressure(t);
             double ea = rh * es / 1000.; // ea needs to be in kpa
 
@@ -1016,7 +1084,7 @@ void PBSM3D::run(mesh& domain)
                 // mean radius of mean mass particle
                 double r_z = pow((3.0 * mm) / (4 * M_PI * rho_p), 0.3333333); // 50 in p&g 1995
                 if (debug_output)
-                    (*face)["mm"_s] = mm;
+                    face->get(h_mm) = mm;
 
                 double xrz = 0.005 * pow(u_z, 1.36); // eqn 16
 
@@ -1126,7 +1194,7 @@ void PBSM3D::run(mesh& domain)
                     (*face)["dm/dt"_s] = dmdtz;
 
                 if (debug_output)
-                    (*face)["mm"_s] = mm;
+                    face->get(h_mm) = mm;
                 double csubl = dmdtz / mm; // EQN 21 POMEROY 1993 (PBSM)
 
                 // eddy diffusivity (m^2/s)
@@ -1155,11 +1223,11 @@ void PBSM3D::run(mesh& domain)
                 // Li and Pomeroy 2000
                 double l = PhysConst::kappa * (cz + d.z0) * l__max / (PhysConst::kappa * (cz + d.z0) + l__max);
                 if (debug_output)
-                    (*face)["l"_s] = l;
+                    face->get(h_l) = l;
 
                 double w = omega; // settling_velocity;
                 if (debug_output)
-                    (*face)["w"_s] = w;
+                    face->get(h_w) = w;
 
                 double diffusion_coeff = snow_diffusion_const; // snow_diffusion_const is a shared param so
                 // need a seperate copy here we can
@@ -1171,7 +1239,7 @@ void PBSM3D::run(mesh& domain)
                     diffusion_coeff = dc; // nope, snow_diffusion_const is shared, use a new
                 }
                 if (debug_output)
-                    (*face)["Km_coeff"_s] = diffusion_coeff;
+                    face->get(h_Km_coeff) = diffusion_coeff;
 
                 // snow_diffusion_const is pretty much a calibration constant. At 1 it
                 // seems to over predict transports.
@@ -1186,7 +1254,7 @@ void PBSM3D::run(mesh& domain)
                 // bottom
                 alpha[4] = d.A[4] * K[4] / v_edge_height;
 
-                double phi = (*face)["vw_dir"_s]; // wind direction
+                double phi = face->get(h_vw_dir); // wind direction
                 Vector_2 vwind = -math::gis::bearing_to_cartesian(phi);
 
                 // setup wind vector
@@ -1216,8 +1284,11 @@ void PBSM3D::run(mesh& domain)
                 {
                     udotm[j] = arma::dot(uvw, m[j]);
                 }
-                // lateral
-                int idx = n_global_tri * z + face->cell_global_id;
+                // this face owns all of its rows, so the row is accumulated here and added to the
+                // matrix in one lock-free call at the end of the layer
+                auto row = suspension_NNP->localRow(face, z);
+                math::LinearAlgebra::NearestNeighborProblem::StencilRow stencil;
+                double rhs = 0;
 
                 double V = face->get_area() * v_edge_height;
                 // the sink term is added on for each edge check, which isn't right
@@ -1240,13 +1311,10 @@ void PBSM3D::run(mesh& domain)
 
                         if (d.face_neigh[f])
                         {
-                            int nidx = n_global_tri * z + face->neighbor(f)->cell_global_id;
-
                             // Diagonal value
-                            suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                    (V * csubl - d.A[f] * udotm[f] - alpha[f]));
+                            stencil.self += V * csubl - d.A[f] * udotm[f] - alpha[f];
                             // Off diagonal value
-                            suspension_NNP->matrixSumIntoGlobalValues(idx, nidx, (alpha[f]));
+                            stencil.neighbor[f] += alpha[f];
                         }
                         else // missing neighbor case
                         {
@@ -1254,21 +1322,17 @@ void PBSM3D::run(mesh& domain)
                             //                            elements[ idx_idx_off ] += V*csubl-d.A[f]*udotm[f]-alpha[f];
 
                             // allow mass into the domain from ghost cell
-                            suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                    (-0.1e-1 * alpha[f] - 1. * d.A[f] * udotm[f] + csubl * V));
+                            stencil.self += -0.1e-1 * alpha[f] - 1. * d.A[f] * udotm[f] + csubl * V;
                         }
                     }
                     else
                     {
                         if (d.face_neigh[f])
                         {
-                            int nidx = n_global_tri * z + face->neighbor(f)->cell_global_id;
                             // Diagonal entry
-                            suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                    V * csubl - alpha[f]);
+                            stencil.self += V * csubl - alpha[f];
                             // Off diagonal entry
-                            suspension_NNP->matrixSumIntoGlobalValues(idx, nidx,
-                                    -d.A[f] * udotm[f] + alpha[f]);
+                            stencil.neighbor[f] += -d.A[f] * udotm[f] + alpha[f];
                         }
                         else
                         {
@@ -1276,8 +1340,7 @@ void PBSM3D::run(mesh& domain)
                             //                            elements[ idx_idx_off ] +=  V*csubl-alpha[f];
 
                             // allow mass in
-                            suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                    -0.1e-1 * alpha[f] - .99 * d.A[f] * udotm[f] + csubl * V);
+                            stencil.self += -0.1e-1 * alpha[f] - .99 * d.A[f] * udotm[f] + csubl * V;
                         }
                     }
                 }
@@ -1292,32 +1355,25 @@ void PBSM3D::run(mesh& domain)
                     //              elements[idx_idx_off] += V * csubl - alpha4;
 
                     // includes advection term
-                    suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                            V * csubl - d.A[4] * udotm[4] - alpha4);
+                    stencil.self += V * csubl - d.A[4] * udotm[4] - alpha4;
                     // RHS
                     double val = -alpha4 * c_salt;
-                    suspension_NNP->rhsSumIntoGlobalValue(idx,val);
-
-                    // ntri * (z + 1) + face->cell_local_id
-                    int nidx = n_global_tri*(z+1) + face->cell_global_id;
+                    rhs += val;
 
                     if (udotm[3] > 0)
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                V * csubl - d.A[3] * udotm[3] - alpha[3]);
+                        stencil.self += V * csubl - d.A[3] * udotm[3] - alpha[3];
                         // Off diagonal
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, nidx, alpha[3]);
+                        stencil.above += alpha[3];
 
                     }
                     else
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                V * csubl - alpha[3]);
+                        stencil.self += V * csubl - alpha[3];
                         // Off diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, (nidx),
-                                -d.A[3] * udotm[3] + alpha[3]);
+                        stencil.above += -d.A[3] * udotm[3] + alpha[3];
                     }
                 }
                 else if (z == nLayer - 1) // top z layer
@@ -1331,78 +1387,74 @@ void PBSM3D::run(mesh& domain)
                     if (udotm[3] > 0)
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                V * csubl - d.A[3] * udotm[3] - alpha[3]);
+                        stencil.self += V * csubl - d.A[3] * udotm[3] - alpha[3];
                         // RHS
                         double val = -alpha[3] * cprecip;
-                        suspension_NNP->rhsSumIntoGlobalValue(idx,val);
+                        rhs += val;
                     }
                     else
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                V * csubl - alpha[3]);
+                        stencil.self += V * csubl - alpha[3];
                         // RHS
                         double val = d.A[3] * cprecip * udotm[3] - alpha[3] * cprecip;
-                        suspension_NNP->rhsSumIntoGlobalValue(idx,val);
+                        rhs += val;
                     }
 
-                    // ntri * (z - 1) + face->cell_local_id
-                    int nidx = n_global_tri*(z-1)+face->cell_global_id;
                     if (udotm[4] > 0)
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx,
-                                V * csubl - d.A[4] * udotm[4] - alpha[4]);
+                        stencil.self += V * csubl - d.A[4] * udotm[4] - alpha[4];
 
                         // Off diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, nidx, alpha[4]);
+                        stencil.below += alpha[4];
                     }
                     else
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx, V * csubl - alpha[4]);
+                        stencil.self += V * csubl - alpha[4];
                         // Off diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, nidx, -d.A[4] * udotm[4] + alpha[4]);
+                        stencil.below += -d.A[4] * udotm[4] + alpha[4];
                     }
                 }
                 else // middle layers
                 {
-                    // ntri * (z + 1) + face->cell_local_id (looking up)
-                    int nidx = n_global_tri*(z+1) + face->cell_global_id;
+                    // looking up
                     if (udotm[3] > 0)
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx, V * csubl - d.A[3] * udotm[3] - alpha[3]);
+                        stencil.self += V * csubl - d.A[3] * udotm[3] - alpha[3];
                         // Off diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, nidx, alpha[3]);
+                        stencil.above += alpha[3];
                     }
                     else
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx, V * csubl - alpha[3]);
+                        stencil.self += V * csubl - alpha[3];
                         // Off diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, nidx, -d.A[3] * udotm[3] + alpha[3]);
+                        stencil.above += -d.A[3] * udotm[3] + alpha[3];
                     }
 
-                    // ntri * (z + 1) + face->cell_local_id (looking down)
-                    nidx = n_global_tri*(z-1) + face->cell_global_id;
+                    // looking down
                     if (udotm[4] > 0)
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx, V * csubl - d.A[4] * udotm[4] - alpha[4]);
+                        stencil.self += V * csubl - d.A[4] * udotm[4] - alpha[4];
                         // Off diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, nidx, alpha[4]);
+                        stencil.below += alpha[4];
                     }
                     else
                     {
                         // Diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, idx, V * csubl - alpha[4]);
+                        stencil.self += V * csubl - alpha[4];
                         // Off diagonal entry
-                        suspension_NNP->matrixSumIntoGlobalValues(idx, nidx, -d.A[4] * udotm[4] + alpha[4]);
+                        stencil.below += -d.A[4] * udotm[4] + alpha[4];
                     }
                 }
 
+                suspension_NNP->matrixSumIntoLocalRow(row, stencil);
+                suspension_NNP->rhsSumIntoLocalValue(row, rhs);
+
             } // end z iter
 
         } // end face iter
@@ -1432,7 +1484,8 @@ void PBSM3D::run(mesh& domain)
         try
         {
             auto suspension_results = suspension_NNP->Solve();
-            SPDLOG_DEBUG("  suspension (isolated) iterations: {} residual: {} ", suspension_results.numIters, suspension_results.residual);
+            SPDLOG_DEBUG("  suspension (isolated) iterations: {} residual: {} setup: {}ms{} solve: {}ms", suspension_results.numIters, suspension_results.residual,
+                         suspension_results.setupTime, suspension_results.recomputedPreconditioner ? "" : " (reused)", suspension_results.solveTime);
         } catch(const Belos::StatusTestError& e)
         {
             int rank = 0;
@@ -1493,12 +1546,12 @@ void PBSM3D::run(mesh& domain)
             }
             Qsubl += d.csubl[z] * c * v_edge_height; //  kg/(m^2 *s)=> per unit area of snowcover
         }
-        (*face)["Qsusp"_s] = Qsusp;
+        face->get(h_Qsusp) = Qsusp;
 
-        (*face)["Qsubl"_s] = Qsubl;
-        (*face)["Qsubl_mass"_s] = Qsubl * global_param->dt(); // kg/m^2 or mm
-        d.sum_subl += (*face)["Qsubl_mass"_s];
-        (*face)["sum_subl"_s] = d.sum_subl;
+        face->get(h_Qsubl) = Qsubl;
+        face->get(h_Qsubl_mass) = Qsubl * global_param->dt(); // kg/m^2 or mm
+        d.sum_subl += face->get(h_Qsubl_mass);
+        face->get(h_sum_subl) = d.sum_subl;
 
     }
 
@@ -1506,21 +1559,17 @@ void PBSM3D::run(mesh& domain)
        Communicate necessary (neighbor) vars for deposition linear system setup
        */
     // LOG_DEBUG << "Qsusp"_s << "     " << "Qsalt"_s;
-    domain->ghost_neighbors_communicate_variable("Qsusp"_s);
-    domain->ghost_neighbors_communicate_variable("Qsalt"_s);
 
     /*
        Setup and solve the linear system for deposition
        */
 
-#pragma omp parallel for
-    for (size_t i = 0; i < domain->size_faces(); i++)
+    auto assemble_deposition = [&](mesh_elem face)
     {
-        auto face = domain->face(i);
         auto& d = face->get_module_data<data>(ID);
         auto& m = d.m;
 
-        double phi = (*face)["vw_dir"_s];
+        double phi = face->get(h_vw_dir);
         Vector_2 v = -math::gis::bearing_to_cartesian(phi);
 
         // setup wind vector
@@ -1535,15 +1584,17 @@ void PBSM3D::run(mesh& domain)
 
         double V = face->get_area(); // V for consistency but actually an area
 
-        int global_row, local_col, global_col;
-        global_row = static_cast<int>(face->cell_global_id);
+        // each face owns its row, so it is accumulated here and added lock-free once all edges are done
+        auto row = deposition_NNP->localRow(face);
+        math::LinearAlgebra::NearestNeighborProblem::StencilRow stencil;
+        double rhs = 0;
 
         if(is_nan(V))
         {
             SPDLOG_DEBUG("Triangle {} area is nan", face->cell_global_id);
         }
         // Diagonal element
-        deposition_NNP->matrixReplaceGlobalValues(global_row, global_row, V);
+        stencil.self = V;
 
         // iterate over edges
         for (int j = 0; j < 3; j++)
@@ -1558,8 +1609,8 @@ void PBSM3D::run(mesh& domain)
             // Pointing same way, we advect downwind
             if (udotm[j] > 0)
             {
-                Qtj = (*face)["Qsusp"_s];
-                Qsj = (*face)["Qsalt"_s];
+                Qtj = face->get(h_Qsusp);
+                Qsj = face->get(h_Qsalt);
 
                 if(is_nan(Qtj))
                 {
@@ -1581,8 +1632,8 @@ void PBSM3D::run(mesh& domain)
                     //   LOG_DEBUG << "Ghost global_id " << neigh->cell_global_id << " ghost_Qsalt: " << (*neigh)["Qsalt"_s];
                     // }
 
-                    Qtj = (*neigh)["Qsusp"_s];
-                    Qsj = (*neigh)["Qsalt"_s];
+                    Qtj = neigh->get(h_Qsusp);
+                    Qsj = neigh->get(h_Qsalt);
                     if(is_nan(Qsj))
                     
                     {
@@ -1594,8 +1645,8 @@ void PBSM3D::run(mesh& domain)
                 else
                 {
                     // neighbor doesn't exist, i.e., we're on an actual boundary, treat as duplicate node outside of domain
-                    Qtj = (*face)["Qsusp"_s];
-                    Qsj = (*face)["Qsalt"_s];
+                    Qtj = face->get(h_Qsusp);
+                    Qsj = face->get(h_Qsalt);
 
                     if(is_nan(Qsj))
                     {
@@ -1609,7 +1660,6 @@ void PBSM3D::run(mesh& domain)
             if (d.face_neigh[j])
             {
                 auto neigh = face->neighbor(j);
-                global_col = static_cast<int>(neigh->cell_global_id);
                 dx[j] = math::gis::distance(face->center(), neigh->center());
 
                 if(is_nan(eps))
@@ -1621,10 +1671,10 @@ void PBSM3D::run(mesh& domain)
                     SPDLOG_DEBUG("dx is nan!");
                 }
                 // diagonal entry
-                deposition_NNP->matrixSumIntoGlobalValues(global_row, global_row, eps * E[j] / dx[j]);
+                stencil.self += eps * E[j] / dx[j];
 
                 // off diagonal entry
-                deposition_NNP->matrixSumIntoGlobalValues(global_row, global_col, -eps * E[j] / dx[j]);
+                stencil.neighbor[j] += -eps * E[j] / dx[j];
             }
 
             // RHS
@@ -1637,7 +1687,7 @@ void PBSM3D::run(mesh& domain)
                 SPDLOG_DEBUG("\tSusp: {} salt: {}", Qtj, Qsj);
 
                 SPDLOG_DEBUG("\ttri global id: {}",face->cell_global_id);
-                (*face)["global_cell_id"_s] = face->cell_global_id;
+                face->get(h_global_cell_id) = face->cell_global_id;
                 SPDLOG_DEBUG("\tlocal_cell_id: {}",face->cell_local_id);
                 SPDLOG_DEBUG("\tis_ghost: {}",face->is_ghost);
                 SPDLOG_DEBUG("\towner: {}",face->owner);
@@ -1653,9 +1703,15 @@ void PBSM3D::run(mesh& domain)
                 }
                 SPDLOG_DEBUG("-------------------------------------------------");
             }
-            deposition_NNP->rhsSumIntoGlobalValue(global_row,val);
+            rhs += val;
         }
-    } // end face iteration
+
+        deposition_NNP->matrixSumIntoLocalRow(row, stencil);
+        deposition_NNP->rhsSumIntoLocalValue(row, rhs);
+    }; // end face assembly
+
+    // faces without ghost neighbors are assembled while Qsusp and Qsalt are in flight to the neighboring ranks
+    domain->overlap_halo_exchange({"Qsusp"_s, "Qsalt"_s}, assemble_deposition);
 
     // Check if we exceed the threshold for blowing snow
     auto deposition_rhs_max = deposition_NNP->getRhsMax();
@@ -1686,7 +1742,8 @@ void PBSM3D::run(mesh& domain)
         try
         {
             auto deposition_results = deposition_NNP->Solve();
-            SPDLOG_DEBUG("  deposition (isolated) iterations: {} residual: {}", deposition_results.numIters, deposition_results.residual);
+            SPDLOG_DEBUG("  deposition (isolated) iterations: {} residual: {} setup: {}ms{} solve: {}ms", deposition_results.numIters, deposition_results.residual,
+                         deposition_results.setupTime, deposition_results.recomputedPreconditioner ? "" : " (reused)", deposition_results.solveTime);
         } catch(Belos::StatusTestError& e)
         {
             int rank = 0;
@@ -1719,12 +1776,12 @@ void PBSM3D::run(mesh& domain)
             mass = qdep * global_param->dt(); // kg/m^2*s *dt -> kg/m^2
 
             // could we have eroded more mass than what exists? cap it
-             double swe = (*face)["swe"_s]; // mm   -->    kg/m^2
+             double swe = face->get(h_swe); // mm   -->    kg/m^2
              swe = is_nan(swe) ? 0 : swe;   // handle the first timestep where swe won't have been
             // updated if we override the module order
             if( mass < 0 && std::fabs(mass) > swe )
             {
-                (*face)["pbsm_more_than_avail"_s] = 1;
+                face->get(h_pbsm_more_than_avail) = 1;
                 mass = -swe;
             }
 
@@ -1735,8 +1792,8 @@ void PBSM3D::run(mesh& domain)
                 mass = 0;
             }
 
-            (*face)["drift_mass"_s] = mass;
-            (*face)["sum_drift"_s] += mass;
+            face->get(h_drift_mass) = mass;
+            face->get(h_sum_drift) += mass;
         }
 
     } // if deposition_present fails
@@ -1754,20 +1811,13 @@ void PBSM3D::checkpoint(mesh& domain,  netcdf& chkpt)
 {
     chkpt.create_variable1D("PBSM3D:sum_drift", domain->size_faces());
 
-    for (size_t i = 0; i < domain->size_faces(); i++)
-    {
-        auto face = domain->face(i);
-        chkpt.put_var1D("PBSM3D:sum_drift", i,
-                        (*face)["sum_drift"_s]);
-    }
+    put_checkpoint_var(domain, chkpt, "PBSM3D:sum_drift",
+                       [&](mesh_elem& face) { return face->get(h_sum_drift); });
 
 }
 
 void PBSM3D::load_checkpoint(mesh& domain,  netcdf& chkpt)
 {
-    for (size_t i = 0; i < domain->size_faces(); i++)
-    {
-        auto face = domain->face(i);
-        (*face)["sum_drift"_s] = chkpt.get_var1D("PBSM3D:sum_drift", i);
-    }
+    get_checkpoint_var(domain, chkpt, "PBSM3D:sum_drift",
+                       [&](mesh_elem& face, double value) { face->get(h_sum_drift) = value; });
 }
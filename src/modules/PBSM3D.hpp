@@ -128,7 +128,10 @@
  *       "rouault_diffusion_coef": false,
  *       "enable_veg": true,
  *       "iterative_subl": false,
- *
+ *       "preconditioner": "ilut",
+ *       "preconditioner_reuse": 1,
+ *       "preconditioner_reuse_iteration_growth": 2.0,
+ *       "warm_start": false
  *    }
  *
  *
@@ -292,6 +295,38 @@
  *    Use the Pomeroy and Li (2000) iterative solution for Schimdt's sublimation equation. This code path has not had
  *    extensive testing and should not be used at the moment.
  *
+ * .. confval:: preconditioner
+ *
+ *    :type: string
+ *    :default: ilut
+ *
+ *    Preconditioner for the suspension and deposition GMRES solves. One of ``ilut``, ``riluk``, ``jacobi``, ``sgs``
+ *    (symmetric Gauss-Seidel), or ``none``. The relaxation preconditioners are much cheaper to set up but usually need
+ *    more iterations.
+ *
+ * .. confval:: preconditioner_reuse
+ *
+ *    :type: int
+ *    :default: 1
+ *
+ *    Recompute the preconditioner at least every this many solves. The sparsity pattern is fixed and the coefficients
+ *    change slowly between timesteps, so reusing a factorization for a few timesteps can save the setup cost on large domains.
+ *    The default recomputes it every solve.
+ *
+ * .. confval:: preconditioner_reuse_iteration_growth
+ *
+ *    :type: double
+ *    :default: 2.0
+ *
+ *    When reusing the preconditioner, recompute it early if the iteration count grows past this multiple of the iterations
+ *    needed right after it was last computed.
+ *
+ * .. confval:: warm_start
+ *
+ *    :default: false
+ *
+ *    Use the previous timestep's solution as the initial guess for the solver.
+ *
  *
  *
  * \endrst
@@ -420,6 +455,18 @@ private:
   std::unique_ptr<math::LinearAlgebra::NearestNeighborProblem> deposition_NNP;
   std::unique_ptr<math::LinearAlgebra::NearestNeighborProblem> suspension_NNP;
 
+  // variable handles, resolved in init
+  var_handle h_U_2m_above_srf, h_vw_dir, h_swe, h_t, h_rh, h_U_R, h_snowdepthavg,
+             h_pbsm_more_than_avail, h_global_cell_id, h_blowingsnow_probability, h_Qsubl, h_Qsubl_mass, h_sum_subl,
+             h_drift_mass, h_Qsusp, h_Qsalt, h_sum_drift, h_fetch, h_p_snow_hours;
+
+  // only resolved if debug_output
+  var_handle h_is_drifting, h_Km_coeff, h_Qsusp_pbsm, h_height_diff, h_w, h_hs, h_ustar, h_l, h_z0, h_lambda,
+             h_U_10m, h_csalt, h_csalt_orig, h_csalt_reset, h_mass_qsalt, h_c_salt_fetch_big, h_tau_n_ratio, h_mm;
+
+  // only resolved if use_subgrid_topo or use_subgrid_topo_V2
+  var_handle h_frac_contrib, h_hold_topo, h_frac_contrib_nosnw, h_test_int, h_tpi_lim;
+
 };
 
 /**
@@ -46,20 +46,14 @@ void Richard_albedo::checkpoint(mesh& domain,  netcdf& chkpt)
 
     chkpt.create_variable1D("Richard_albedo:albedo", domain->size_faces());
 
-    for (size_t i = 0; i < domain->size_faces(); i++)
-    {
-        auto face = domain->face(i);
-        chkpt.put_var1D("Richard_albedo:albedo",i,face->get_module_data<Richard_albedo::data>(ID).albedo);
-    }
+    put_checkpoint_var(domain, chkpt, "Richard_albedo:albedo",
+                       [&](mesh_elem& face) { return face->get_module_data<Richard_albedo::data>(ID).albedo; });
 }
 
 void Richard_albedo::load_checkpoint(mesh& domain,  netcdf& chkpt)
 {
-    for (size_t i = 0; i < domain->size_faces(); i++)
-    {
-        auto face = domain->face(i);
-        face->get_module_data<Richard_albedo::data>(ID).albedo = chkpt.get_var1D("Richard_albedo:albedo",i);
-    }
+    get_checkpoint_var(domain, chkpt, "Richard_albedo:albedo",
+                       [&](mesh_elem& face, double value) { face->get_module_data<Richard_albedo::data>(ID).albedo = value; });
 }
 
 void Richard_albedo::run(mesh_elem &face)
@@ -70,16 +70,16 @@ void Simple_Canopy::run(mesh_elem &face)
     auto& data = face->get_module_data<Simple_Canopy::data>(ID);
 
     // Get meteorological data for current face
-    double ta           = (*face)["t"_s];
-    double rh           = (*face)["rh"_s];
-    double U_R          = (*face)["U_R"_s];
-    double iswr         = (*face)["iswr"_s]; // SW in above canopy
-    double Qdfo         = (*face)["iswr_diffuse"_s]; // "clear-sky diffuse", "(W/m^2)"
-    double ilwr         = (*face)["ilwr"_s]; // LW in above canopy
-    double p_rain       = (*face)["p_rain"_s]; // rain (mm/timestep) above canopy
-    double p_snow       = (*face)["p_snow"_s]; // snow (mm/timestep) above canopy
-    double snowdepthavg = (*face)["snowdepthavg"_s];
-    double Albedo       = (*face)["snow_albedo"_s]; // Broad band snow albedo
+    double ta           = face->get(h_t);
+    double rh           = face->get(h_rh);
+    double U_R          = face->get(h_U_R);
+    double iswr         = face->get(h_iswr); // SW in above canopy
+    double Qdfo         = face->get(h_iswr_diffuse); // "clear-sky diffuse", "(W/m^2)"
+    double ilwr         = face->get(h_ilwr); // LW in above canopy
+    double p_rain       = face->get(h_p_rain); // rain (mm/timestep) above canopy
+    double p_snow       = face->get(h_p_snow); // snow (mm/timestep) above canopy
+    double snowdepthavg = face->get(h_snowdepthavg);
+    double Albedo       = face->get(h_snow_albedo); // Broad band snow albedo
     double air_pressure = 915; //(*face)["air_pressure"_s]; //"Average surface pressure", "(kPa)" TODO: Get from face_data
 
     // Checks on boundary conditions
@@ -151,8 +151,8 @@ void Simple_Canopy::run(mesh_elem &face)
     double Zvent            = 0.75; //", "0.0", "1.0", "ventilation wind speed height (z/Ht)", "()", &Zvent);
     double unload_t         = 1.0; //", "-10.0", "20.0", "if ice-bulb temp >= t : canopy snow is unloaded as snow", "(°C)", &unload_t);
     double unload_t_water   = 4.0; //", "-10.0", "20.0", "if ice-bulb temp >= t: canopy snow is unloaded as water", "(°C)", &unload_t_water);
-    double SolAng           = (*face)["solar_el"_s] * mio::Cst::to_rad; // degrees to radians (assumed horizontal)
-    double cosxs            = (*face)["solar_angle"_s]; // "cosine of the angle of incidence on the slope", "()"
+    double SolAng           = face->get(h_solar_el) * mio::Cst::to_rad; // degrees to radians (assumed horizontal)
+    double cosxs            = face->get(h_solar_angle); // "cosine of the angle of incidence on the slope", "()"
     double cosxsflat        = cos(SolAng); // "cosine of the angle of incidence on the horizontal"
     double Surrounding_Ht   = data.CanopyHeight; //""[0.1, 0.25, 1.0]", "0.001", "100.0", "surrounding canopy height", "()", &Surrounding_Ht);
     double Gap_diameter     = 100; // "[100]", "10", "1000", "representative gap diameter", "(m)", &Gap_diameter); TODO: hardcod gap diamter, need to get from lidar if available
@@ -560,23 +560,48 @@ void Simple_Canopy::run(mesh_elem &face)
 
 
     // Output computed canopy states and fluxes downward to snowpack and upward to atmosphere
-    (*face)["snow_load"_s]=data.Snow_load;
-    (*face)["rain_load"_s]=data.rain_load;
-    (*face)["ts_canopy"_s]=Ts;
-    (*face)["ta_subcanopy"_s]=ta;
-    (*face)["rh_subcanopy"_s]=rh;
-    (*face)["iswr_subcanopy"_s]=Qsisn; // (W/m^2)
-    (*face)["ilwr_subcanopy"_s]=Qlisn; // (W/m^2)
-    (*face)["p_rain_subcanopy"_s]=net_rain; // (mm/int)
-    (*face)["p_snow_subcanopy"_s]=net_snow; // (mm/int)
-    (*face)["p_subcanopy"_s]=net_p; // Total precip (mm/int)
-    (*face)["frac_precip_rain_subcanopy"_s]=net_rain/net_p; // Fraction rain (-)
-    (*face)["frac_precip_snow_subcanopy"_s]=net_snow/net_p; // Fraction snow (-)
+    face->get(h_snow_load)=data.Snow_load;
+    face->get(h_rain_load)=data.rain_load;
+    face->get(h_ts_canopy)=Ts;
+    face->get(h_ta_subcanopy)=ta;
+    face->get(h_rh_subcanopy)=rh;
+    face->get(h_iswr_subcanopy)=Qsisn; // (W/m^2)
+    face->get(h_ilwr_subcanopy)=Qlisn; // (W/m^2)
+    face->get(h_p_rain_subcanopy)=net_rain; // (mm/int)
+    face->get(h_p_snow_subcanopy)=net_snow; // (mm/int)
+    face->get(h_p_subcanopy)=net_p; // Total precip (mm/int)
+    face->get(h_frac_precip_rain_subcanopy)=net_rain/net_p; // Fraction rain (-)
+    face->get(h_frac_precip_snow_subcanopy)=net_snow/net_p; // Fraction snow (-)
 
 }
 
 void Simple_Canopy::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_t = handle(domain, "t");
+    h_rh = handle(domain, "rh");
+    h_U_R = handle(domain, "U_R");
+    h_iswr = handle(domain, "iswr");
+    h_iswr_diffuse = handle(domain, "iswr_diffuse");
+    h_ilwr = handle(domain, "ilwr");
+    h_p_rain = handle(domain, "p_rain");
+    h_p_snow = handle(domain, "p_snow");
+    h_snowdepthavg = handle(domain, "snowdepthavg");
+    h_snow_albedo = handle(domain, "snow_albedo");
+    h_solar_el = handle(domain, "solar_el");
+    h_solar_angle = handle(domain, "solar_angle");
+    h_snow_load = handle(domain, "snow_load");
+    h_rain_load = handle(domain, "rain_load");
+    h_ts_canopy = handle(domain, "ts_canopy");
+    h_ta_subcanopy = handle(domain, "ta_subcanopy");
+    h_rh_subcanopy = handle(domain, "rh_subcanopy");
+    h_iswr_subcanopy = handle(domain, "iswr_subcanopy");
+    h_ilwr_subcanopy = handle(domain, "ilwr_subcanopy");
+    h_p_rain_subcanopy = handle(domain, "p_rain_subcanopy");
+    h_p_snow_subcanopy = handle(domain, "p_snow_subcanopy");
+    h_p_subcanopy = handle(domain, "p_subcanopy");
+    h_frac_precip_rain_subcanopy = handle(domain, "frac_precip_rain_subcanopy");
+    h_frac_precip_snow_subcanopy = handle(domain, "frac_precip_snow_subcanopy");
 
     #pragma omp parallel for
     // For each face
@@ -680,43 +705,42 @@ void Simple_Canopy::checkpoint(mesh& domain,  netcdf& chkpt)
     chkpt.create_variable1D("Simple_Canopy:cum_SUnload_H2O", domain->size_faces());
 
 
-    //netcdf puts are not threadsafe.
-    for (size_t i = 0; i < domain->size_faces(); i++)
+    // gather each field into one array and write it in a single call
+    auto put = [&](const std::string& var, auto fn)
     {
-        auto face = domain->face(i);
-        auto& d = face->get_module_data<data>(ID);
-
-        chkpt.put_var1D("Simple_Canopy:LAI", i, d.LAI);
-        chkpt.put_var1D("Simple_Canopy:CanopyHeight", i, d.CanopyHeight);
-        chkpt.put_var1D("Simple_Canopy:canopyType", i, d.canopyType);
-        chkpt.put_var1D("Simple_Canopy:rain_load", i, d.rain_load);
-        chkpt.put_var1D("Simple_Canopy:Snow_load", i, d.Snow_load);
-        chkpt.put_var1D("Simple_Canopy:cum_net_snow", i, d.cum_net_snow);
-        chkpt.put_var1D("Simple_Canopy:cum_net_rain", i, d.cum_net_rain);
-        chkpt.put_var1D("Simple_Canopy:cum_Subl_Cpy", i, d.cum_Subl_Cpy);
-        chkpt.put_var1D("Simple_Canopy:cum_intcp_evap", i, d.cum_intcp_evap);
-        chkpt.put_var1D("Simple_Canopy:cum_SUnload_H2O", i, d.cum_SUnload_H2O);
-
-    }
+        put_checkpoint_var(domain, chkpt, "Simple_Canopy:" + var,
+                           [&](mesh_elem& face) -> double { return fn(face->get_module_data<data>(ID)); });
+    };
+
+    put("LAI", [](data& d) { return d.LAI; });
+    put("CanopyHeight", [](data& d) { return d.CanopyHeight; });
+    put("canopyType", [](data& d) { return d.canopyType; });
+    put("rain_load", [](data& d) { return d.rain_load; });
+    put("Snow_load", [](data& d) { return d.Snow_load; });
+    put("cum_net_snow", [](data& d) { return d.cum_net_snow; });
+    put("cum_net_rain", [](data& d) { return d.cum_net_rain; });
+    put("cum_Subl_Cpy", [](data& d) { return d.cum_Subl_Cpy; });
+    put("cum_intcp_evap", [](data& d) { return d.cum_intcp_evap; });
+    put("cum_SUnload_H2O", [](data& d) { return d.cum_SUnload_H2O; });
 }
 
 void Simple_Canopy::load_checkpoint(mesh& domain, netcdf& chkpt)
 {
-    for (size_t i = 0; i < domain->size_faces(); i++)
+    // one read per field
+    auto get = [&](const std::string& var, auto fn)
     {
-        auto face = domain->face(i);
-        auto& d = face->get_module_data<data>(ID);
-
-        d.LAI = chkpt.get_var1D("Simple_Canopy:LAI", i);
-        d.CanopyHeight = chkpt.get_var1D("Simple_Canopy:CanopyHeight", i);
-        d.canopyType = chkpt.get_var1D("Simple_Canopy:canopyType", i);
-        d.rain_load = chkpt.get_var1D("Simple_Canopy:rain_load", i);
-        d.Snow_load = chkpt.get_var1D("Simple_Canopy:Snow_load", i);
-        d.cum_net_snow = chkpt.get_var1D("Simple_Canopy:cum_net_snow", i);
-        d.cum_net_rain = chkpt.get_var1D("Simple_Canopy:cum_net_rain", i);
-        d.cum_Subl_Cpy = chkpt.get_var1D("Simple_Canopy:cum_Subl_Cpy", i);
-        d.cum_SUnload_H2O = chkpt.get_var1D("Simple_Canopy:cum_SUnload_H2O", i);
-
-    }
+        get_checkpoint_var(domain, chkpt, "Simple_Canopy:" + var,
+                           [&](mesh_elem& face, double value) { fn(face->get_module_data<data>(ID), value); });
+    };
+
+    get("LAI", [](data& d, double v) { d.LAI = v; });
+    get("CanopyHeight", [](data& d, double v) { d.CanopyHeight = v; });
+    get("canopyType", [](data& d, double v) { d.canopyType = v; });
+    get("rain_load", [](data& d, double v) { d.rain_load = v; });
+    get("Snow_load", [](data& d, double v) { d.Snow_load = v; });
+    get("cum_net_snow", [](data& d, double v) { d.cum_net_snow = v; });
+    get("cum_net_rain", [](data& d, double v) { d.cum_net_rain = v; });
+    get("cum_Subl_Cpy", [](data& d, double v) { d.cum_Subl_Cpy = v; });
+    get("cum_SUnload_H2O", [](data& d, double v) { d.cum_SUnload_H2O = v; });
 
 }
\ No newline at end of file
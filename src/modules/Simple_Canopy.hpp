@@ -89,6 +89,9 @@ public:
         double cum_SUnload_H2O;
     };
 
-
-
+    // variable handles, resolved in init
+    var_handle h_t, h_rh, h_U_R, h_iswr, h_iswr_diffuse, h_ilwr,
+               h_p_rain, h_p_snow, h_snowdepthavg, h_snow_albedo, h_solar_el, h_solar_angle,
+               h_snow_load, h_rain_load, h_ts_canopy, h_ta_subcanopy, h_rh_subcanopy, h_iswr_subcanopy,
+               h_ilwr_subcanopy, h_p_rain_subcanopy, h_p_snow_subcanopy, h_p_subcanopy, h_frac_precip_rain_subcanopy, h_frac_precip_snow_subcanopy;
 };
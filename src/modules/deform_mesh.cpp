@@ -27,7 +27,8 @@ REGISTER_MODULE_CPP(deform_mesh);
 deform_mesh::deform_mesh(config_file cfg)
         : module_base("deform_mesh", parallel::domain, cfg)
 {
-
+    // moves the mesh vertices and updates the face geometry in run()
+    barrier();
 }
 
 deform_mesh::~deform_mesh()
@@ -59,4 +60,7 @@ void deform_mesh::run(mesh& domain)
 
 
     domain->_terrain_deformed = true;
+
+    // slope, aspect, etc. are precomputed so need to be updated for the new vertex positions
+    domain->update_face_geometry();
 }
@@ -33,12 +33,8 @@
  * @{
  * \class deform_mesh
  *
- * Example of how to deform the mesh's z-coords.
- * \rst
- * .. warning::
- *    There is currently no way for CHM to be updated that the mesh z has changed to recompute slopes/aspect/etc.
- *
- * \endrst
+ * Example of how to deform the mesh's z-coords. The precomputed face geometry (slope, aspect, etc.) is updated in place
+ * after the vertices are moved.
  * @}
  */
 class deform_mesh : public module_base
@@ -39,6 +39,21 @@ fast_shadow::fast_shadow(config_file cfg)
 
     //size of the step to take
     size_of_step = max_distance / steps;
+
+    azimuth_bins = cfg.get("azimuth_bins", 36);
+
+    // the horizon is searched once from the initial terrain, so it would go stale as deform_mesh moves the vertices
+    if (azimuth_bins > 0)
+        conflicts("deform_mesh", "The precomputed horizon is not updated as the mesh deforms. Set fast_shadow "
+                                 "azimuth_bins to 0 to search every timestep");
+    horizon = nullptr;
+}
+
+void fast_shadow::init(mesh& domain)
+{
+    // terrain is static, so search each azimuth once up front
+    if (azimuth_bins > 0)
+        horizon = &domain->horizon(azimuth_bins, steps, max_distance);
 }
 
 fast_shadow::~fast_shadow()
@@ -59,6 +74,14 @@ void fast_shadow::run(mesh_elem& face)
 
     double solar_az = (*face)["solar_az"_s] ;
 
+    if (horizon)
+    {
+        if (horizon->at(face->cell_local_id, solar_az) > solar_el)
+            (*face)["shadow"_s]= 1;
+
+        return;
+    }
+
     Point_3 me = face->center();
 
     double phi = 0.;
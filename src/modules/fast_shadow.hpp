@@ -69,6 +69,16 @@
  *
  *    Maximum search distance to look for a higher point
  *
+ * .. confval:: azimuth_bins
+ *
+ *    :type: int
+ *    :default: 36
+ *
+ *    Number of azimuths the horizon is precomputed for at startup. Each timestep the horizon in the direction of the
+ *    sun is interpolated between the two nearest azimuths instead of being searched for. ``0`` disables the
+ *    precomputation and searches along the exact solar azimuth every timestep. The horizon is computed from the
+ *    initial terrain and is not updated, so a non-zero value cannot be used with ``deform_mesh``.
+ *
  * \endrst
  *
  * **References:**
@@ -90,6 +100,8 @@ public:
 
     virtual void run(mesh_elem& face);
 
+    virtual void init(mesh& domain);
+
 //number of steps along the search vector to check for a higher point
     int steps;
     //max distance to search
@@ -98,4 +110,8 @@ public:
     //size of the step to take
     double size_of_step;
 
+    // number of azimuths in the precomputed horizon, 0 if searched every timestep
+    size_t azimuth_bins;
+    const azimuth_table* horizon;
+
 };
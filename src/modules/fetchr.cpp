@@ -46,6 +46,13 @@ fetchr::fetchr(config_file cfg)
 
     h_IBL = 5;
 
+    azimuth_bins = cfg.get("azimuth_bins", 36);
+
+    // the fetch is searched once from the initial terrain, so it would go stale as deform_mesh moves the vertices
+    if (azimuth_bins > 0)
+        conflicts("deform_mesh", "The precomputed fetch is not updated as the mesh deforms. Set fetchr "
+                                 "azimuth_bins to 0 to search every timestep");
+
 }
 
 fetchr::~fetchr()
@@ -54,15 +61,27 @@ fetchr::~fetchr()
 
 }
 
-void fetchr::run(mesh_elem& face)
+void fetchr::init(mesh& domain)
 {
+    if (azimuth_bins == 0)
+        return;
 
+    // terrain and vegetation are static, so search each azimuth once up front
+    fetch.init(domain->size_faces(), azimuth_bins);
 
-    (*face)["fetch"_s]= max_distance;
-
-    //direction it is from, need upwind fetch
-    double wind_dir = (*face)["vw_dir"_s] ;
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto face = domain->face(i);
+        for (size_t k = 0; k < azimuth_bins; k++)
+        {
+            fetch(i, k) = search(face, fetch.bin_azimuth(k));
+        }
+    }
+}
 
+void fetchr::run(mesh_elem& face)
+{
     //if we are using vegetation and the current face is covered in veg, set the fetch to 0
     if(incl_veg && face->has_vegetation())
     {
@@ -76,12 +95,23 @@ void fetchr::run(mesh_elem& face)
 
     }
 
-    // search along wind_dir azimuth in j step increments
+    //direction it is from, need upwind fetch
+    double wind_dir = (*face)["vw_dir"_s] ;
+
+    if (azimuth_bins > 0)
+        (*face)["fetch"_s]= fetch.at(face->cell_local_id, wind_dir);
+    else
+        (*face)["fetch"_s]= search(face, wind_dir);
+}
+
+double fetchr::search(mesh_elem& face, double azimuth)
+{
+    // search along the azimuth in j step increments
     for (int j = 1; j <= steps; ++j)
     {
         double distance = j * size_of_step;
 
-        auto f = face->find_closest_face(wind_dir, distance);
+        auto f = face->find_closest_face(azimuth, distance);
 
         double Z_CanTop = 0;
         if (incl_veg && f->has_vegetation())
@@ -109,12 +139,9 @@ void fetchr::run(mesh_elem& face)
         if(Z_test >= Z_core ||
                 (incl_veg && distance < x_sss) )
         {
-            (*face)["fetch"_s]= distance;
-            break;
+            return distance;
         }
     }
 
-
-
-
+    return max_distance;
 }
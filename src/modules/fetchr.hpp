@@ -74,6 +74,16 @@
  *
  *    Rise/run threshold to multiply against the distance of a test triangle.
  *
+ * .. confval:: azimuth_bins
+ *
+ *    :type: int
+ *    :default: 36
+ *
+ *    Number of azimuths the fetch is precomputed for at startup. Each timestep the fetch in the upwind direction is
+ *    interpolated between the two nearest azimuths instead of being searched for. ``0`` disables the precomputation
+ *    and searches along the exact wind direction every timestep. The fetch is computed from the initial terrain and is
+ *    not updated, so a non-zero value cannot be used with ``deform_mesh``.
+ *
  * \endrst
  *
  * **References:**
@@ -92,6 +102,14 @@ public:
 
     virtual void run(mesh_elem& face);
 
+    virtual void init(mesh& domain);
+
+    /// Upwind fetch of a face along an azimuth
+    /// @param face
+    /// @param azimuth [degrees]
+    /// @return [m]
+    double search(mesh_elem& face, double azimuth);
+
 //number of steps along the search vector to check for a higher point
     int steps;
     //max distance to search
@@ -106,4 +124,8 @@ public:
     //0.06 m/m corresponds to prarie shelter belts
     double I;
 
+    // number of azimuths in the precomputed fetch, 0 if searched every timestep
+    size_t azimuth_bins;
+    azimuth_table fetch;
+
 };
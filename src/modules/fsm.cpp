@@ -389,137 +389,94 @@ void FSM::checkpoint(mesh& domain,  netcdf& chkpt)
     chkpt.create_variable1D("fsm:Vsmc[0]", domain->size_faces());
     chkpt.create_variable1D("fsm:Vsmc[1]", domain->size_faces());
 
-    //netcdf puts are not threadsafe.
-    for (size_t i = 0; i < domain->size_faces(); i++)
+    // gather each field into one array and write it in a single call
+    auto put = [&](const std::string& var, auto fn)
     {
-        auto face = domain->face(i);
-        auto& d = face->get_module_data<data>(ID);
-
-        chkpt.put_var1D("fsm:snd", i, d.diag.snd);
-        chkpt.put_var1D("fsm:snw", i, d.diag.snw);
-        chkpt.put_var1D("fsm:sum_snowpack_subl", i, d.diag.sum_snowpack_subl);
+        put_checkpoint_var(domain, chkpt, "fsm:" + var,
+                           [&](mesh_elem& face) -> double { return fn(face->get_module_data<data>(ID)); });
+    };
 
-        chkpt.put_var1D("fsm:albs", i, d.state.albs);
-        chkpt.put_var1D("fsm:Tsrf", i, d.state.Tsrf);
+    put("snd", [](data& d) { return d.diag.snd; });
+    put("snw", [](data& d) { return d.diag.snw; });
+    put("sum_snowpack_subl", [](data& d) { return d.diag.sum_snowpack_subl; });
 
-        chkpt.put_var1D("fsm:Dsnw[0]", i, d.state.Dsnw[0]);
-        chkpt.put_var1D("fsm:Dsnw[1]", i, d.state.Dsnw[1]);
-        chkpt.put_var1D("fsm:Dsnw[2]", i, d.state.Dsnw[2]);
-        chkpt.put_var1D("fsm:Dsnw[3]", i, d.state.Dsnw[3]);
-        chkpt.put_var1D("fsm:Dsnw[4]", i, d.state.Dsnw[4]);
-        chkpt.put_var1D("fsm:Dsnw[5]", i, d.state.Dsnw[5]);
+    put("albs", [](data& d) { return d.state.albs; });
+    put("Tsrf", [](data& d) { return d.state.Tsrf; });
+    put("Nsnow", [](data& d) { return d.state.Nsnow; });
 
-        chkpt.put_var1D("fsm:Nsnow", i, d.state.Nsnow);
-
-        chkpt.put_var1D("fsm:Qcan[0]", i, d.state.Qcan[0]);
-        chkpt.put_var1D("fsm:Qcan[1]", i, d.state.Qcan[1]);
-
-//        chkpt.put_var1D("fsm:Rgrn", i, d.state.Rgrn);
-        chkpt.put_var1D("fsm:Sice[0]", i, d.state.Sice[0]);
-        chkpt.put_var1D("fsm:Sice[1]", i, d.state.Sice[1]);
-        chkpt.put_var1D("fsm:Sice[2]", i, d.state.Sice[2]);
-        chkpt.put_var1D("fsm:Sice[3]", i, d.state.Sice[3]);
-        chkpt.put_var1D("fsm:Sice[4]", i, d.state.Sice[4]);
-        chkpt.put_var1D("fsm:Sice[5]", i, d.state.Sice[5]);
+//    put("Rgrn", [](data& d) { return d.state.Rgrn; });
+    for (int k = 0; k < 6; k++)
+    {
+        auto idx = "[" + std::to_string(k) + "]";
+        put("Dsnw" + idx, [k](data& d) { return d.state.Dsnw[k]; });
+        put("Sice" + idx, [k](data& d) { return d.state.Sice[k]; });
+        put("Sliq" + idx, [k](data& d) { return d.state.Sliq[k]; });
+        put("Tsnow" + idx, [k](data& d) { return d.state.Tsnow[k]; });
+    }
 
-        chkpt.put_var1D("fsm:Sliq[0]", i, d.state.Sliq[0]);
-        chkpt.put_var1D("fsm:Sliq[1]", i, d.state.Sliq[1]);
-        chkpt.put_var1D("fsm:Sliq[2]", i, d.state.Sliq[2]);
-        chkpt.put_var1D("fsm:Sliq[3]", i, d.state.Sliq[3]);
-        chkpt.put_var1D("fsm:Sliq[4]", i, d.state.Sliq[4]);
-        chkpt.put_var1D("fsm:Sliq[5]", i, d.state.Sliq[5]);
+    for (int k = 0; k < 4; k++)
+    {
+        put("Tsoil[" + std::to_string(k) + "]", [k](data& d) { return d.state.Tsoil[k]; });
+    }
 
-        chkpt.put_var1D("fsm:Sveg[0]", i, d.state.Sveg[0]);
-        chkpt.put_var1D("fsm:Sveg[1]", i, d.state.Sveg[1]);
+    for (int k = 0; k < 2; k++)
+    {
+        auto idx = "[" + std::to_string(k) + "]";
+        put("Qcan" + idx, [k](data& d) { return d.state.Qcan[k]; });
+        put("Sveg" + idx, [k](data& d) { return d.state.Sveg[k]; });
+        put("Tcan" + idx, [k](data& d) { return d.state.Tcan[k]; });
+        put("Tveg" + idx, [k](data& d) { return d.state.Tveg[k]; });
+        put("Vsmc" + idx, [k](data& d) { return d.state.Vsmc[k]; });
+    }
+}
 
-        chkpt.put_var1D("fsm:Tcan[0]", i, d.state.Tcan[0]);
-        chkpt.put_var1D("fsm:Tcan[1]", i, d.state.Tcan[1]);
+void FSM::load_checkpoint(mesh& domain, netcdf& chkpt)
+{
+    // one read per field
+    auto get = [&](const std::string& var, auto fn)
+    {
+        get_checkpoint_var(domain, chkpt, "fsm:" + var,
+                           [&](mesh_elem& face, double value) { fn(face->get_module_data<data>(ID), value); });
+    };
 
-        chkpt.put_var1D("fsm:Tsnow[0]", i, d.state.Tsnow[0]);
-        chkpt.put_var1D("fsm:Tsnow[1]", i, d.state.Tsnow[1]);
-        chkpt.put_var1D("fsm:Tsnow[2]", i, d.state.Tsnow[2]);
-        chkpt.put_var1D("fsm:Tsnow[3]", i, d.state.Tsnow[3]);
-        chkpt.put_var1D("fsm:Tsnow[4]", i, d.state.Tsnow[4]);
-        chkpt.put_var1D("fsm:Tsnow[5]", i, d.state.Tsnow[5]);
+    get("snd", [](data& d, double v) { d.diag.snd = v; });
+    get("snw", [](data& d, double v) { d.diag.snw = v; });
+    get("sum_snowpack_subl", [](data& d, double v) { d.diag.sum_snowpack_subl = v; });
 
-        chkpt.put_var1D("fsm:Tsoil[0]", i, d.state.Tsoil[0]);
-        chkpt.put_var1D("fsm:Tsoil[1]", i, d.state.Tsoil[1]);
-        chkpt.put_var1D("fsm:Tsoil[2]", i, d.state.Tsoil[2]);
-        chkpt.put_var1D("fsm:Tsoil[3]", i, d.state.Tsoil[3]);
+    get("albs", [](data& d, double v) { d.state.albs = v; });
+    get("Tsrf", [](data& d, double v) { d.state.Tsrf = v; });
+    get("Nsnow", [](data& d, double v) { d.state.Nsnow = v; });
 
-        chkpt.put_var1D("fsm:Tveg[0]", i, d.state.Tveg[0]);
-        chkpt.put_var1D("fsm:Tveg[1]", i, d.state.Tveg[1]);
+    for (int k = 0; k < 6; k++)
+    {
+        auto idx = "[" + std::to_string(k) + "]";
+        get("Dsnw" + idx, [k](data& d, double v) { d.state.Dsnw[k] = v; });
+        get("Sice" + idx, [k](data& d, double v) { d.state.Sice[k] = v; });
+        get("Sliq" + idx, [k](data& d, double v) { d.state.Sliq[k] = v; });
+        get("Tsnow" + idx, [k](data& d, double v) { d.state.Tsnow[k] = v; });
+    }
 
-        chkpt.put_var1D("fsm:Vsmc[0]", i, d.state.Vsmc[0]);
-        chkpt.put_var1D("fsm:Vsmc[1]", i, d.state.Vsmc[1]);
+    for (int k = 0; k < 4; k++)
+    {
+        get("Tsoil[" + std::to_string(k) + "]", [k](data& d, double v) { d.state.Tsoil[k] = v; });
+    }
 
+    for (int k = 0; k < 2; k++)
+    {
+        auto idx = "[" + std::to_string(k) + "]";
+        get("Qcan" + idx, [k](data& d, double v) { d.state.Qcan[k] = v; });
+        get("Sveg" + idx, [k](data& d, double v) { d.state.Sveg[k] = v; });
+        get("Tcan" + idx, [k](data& d, double v) { d.state.Tcan[k] = v; });
+        get("Tveg" + idx, [k](data& d, double v) { d.state.Tveg[k] = v; });
+        get("Vsmc" + idx, [k](data& d, double v) { d.state.Vsmc[k] = v; });
     }
-}
 
-void FSM::load_checkpoint(mesh& domain, netcdf& chkpt)
-{
+#pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
         auto face = domain->face(i);
         auto& d = face->get_module_data<data>(ID);
 
-        d.diag.snd = chkpt.get_var1D("fsm:snd", i);
-        d.diag.snw = chkpt.get_var1D("fsm:snw", i);
-        d.diag.sum_snowpack_subl =  chkpt.get_var1D("fsm:sum_snowpack_subl", i);
-
-        d.state.albs = chkpt.get_var1D("fsm:albs", i);
-        d.state.Tsrf = chkpt.get_var1D("fsm:Tsrf", i);
-
-        d.state.Dsnw[0] = chkpt.get_var1D("fsm:Dsnw[0]", i);
-        d.state.Dsnw[1] = chkpt.get_var1D("fsm:Dsnw[1]", i);
-        d.state.Dsnw[2] = chkpt.get_var1D("fsm:Dsnw[2]", i);
-        d.state.Dsnw[3] = chkpt.get_var1D("fsm:Dsnw[3]", i);
-        d.state.Dsnw[4] = chkpt.get_var1D("fsm:Dsnw[4]", i);
-        d.state.Dsnw[5] = chkpt.get_var1D("fsm:Dsnw[5]", i);
-
-        d.state.Nsnow = chkpt.get_var1D("fsm:Nsnow", i);
-
-        d.state.Qcan[0] = chkpt.get_var1D("fsm:Qcan[0]", i);
-        d.state.Qcan[1] = chkpt.get_var1D("fsm:Qcan[1]", i);
-
-        d.state.Sice[0] = chkpt.get_var1D("fsm:Sice[0]", i);
-        d.state.Sice[1] = chkpt.get_var1D("fsm:Sice[1]", i);
-        d.state.Sice[2] = chkpt.get_var1D("fsm:Sice[2]", i);
-        d.state.Sice[3] = chkpt.get_var1D("fsm:Sice[3]", i);
-        d.state.Sice[4] = chkpt.get_var1D("fsm:Sice[4]", i);
-        d.state.Sice[5] = chkpt.get_var1D("fsm:Sice[5]", i);
-
-        d.state.Sliq[0] = chkpt.get_var1D("fsm:Sliq[0]", i);
-        d.state.Sliq[1] = chkpt.get_var1D("fsm:Sliq[1]", i);
-        d.state.Sliq[2] = chkpt.get_var1D("fsm:Sliq[2]", i);
-        d.state.Sliq[3] = chkpt.get_var1D("fsm:Sliq[3]", i);
-        d.state.Sliq[4] = chkpt.get_var1D("fsm:Sliq[4]", i);
-        d.state.Sliq[5] = chkpt.get_var1D("fsm:Sliq[5]", i);
-
-        d.state.Sveg[0] = chkpt.get_var1D("fsm:Sveg[0]", i);
-        d.state.Sveg[1] = chkpt.get_var1D("fsm:Sveg[1]", i);
-
-        d.state.Tcan[0] = chkpt.get_var1D("fsm:Tcan[0]", i);
-        d.state.Tcan[1] = chkpt.get_var1D("fsm:Tcan[1]", i);
-
-        d.state.Tsnow[0] = chkpt.get_var1D("fsm:Tsnow[0]", i);
-        d.state.Tsnow[1] = chkpt.get_var1D("fsm:Tsnow[1]", i);
-        d.state.Tsnow[2] = chkpt.get_var1D("fsm:Tsnow[2]", i);
-        d.state.Tsnow[3] = chkpt.get_var1D("fsm:Tsnow[3]", i);
-        d.state.Tsnow[4] = chkpt.get_var1D("fsm:Tsnow[4]", i);
-        d.state.Tsnow[5] = chkpt.get_var1D("fsm:Tsnow[5]", i);
-
-        d.state.Tsoil[0] = chkpt.get_var1D("fsm:Tsoil[0]", i);
-        d.state.Tsoil[1] = chkpt.get_var1D("fsm:Tsoil[1]", i);
-        d.state.Tsoil[2] = chkpt.get_var1D("fsm:Tsoil[2]", i);
-        d.state.Tsoil[3] = chkpt.get_var1D("fsm:Tsoil[3]", i);
-
-        d.state.Tveg[0] = chkpt.get_var1D("fsm:Tveg[0]", i);
-        d.state.Tveg[1] = chkpt.get_var1D("fsm:Tveg[1]", i);
-
-        d.state.Vsmc[0] = chkpt.get_var1D("fsm:Vsmc[0]", i);
-        d.state.Vsmc[1] = chkpt.get_var1D("fsm:Vsmc[1]", i);
-
         (*face)["swe"_s] = d.diag.snw;
         (*face)["snowdepthavg"_s] = d.diag.snd;
         (*face)["snowdepthavg_vert"_s] = d.diag.snd/std::max(0.001,cos(face->slope()));
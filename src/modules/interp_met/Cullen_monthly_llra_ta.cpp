@@ -41,6 +41,9 @@ Cullen_monthly_llra_ta::~Cullen_monthly_llra_ta()
 }
 void Cullen_monthly_llra_ta::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_t = handle(domain, "t");
+    h_t_lapse_rate = handle(domain, "t_lapse_rate");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -117,8 +120,8 @@ void Cullen_monthly_llra_ta::run(mesh_elem& face)
     //raise value back up to the face's elevation from sea level
     value =  value + lapse_rate * (0.0 - face->get_z());
 
-    (*face)["t"_s]=value;
+    face->get(h_t)=value;
 
-    (*face)["t_lapse_rate"_s]=lapse_rate;
+    face->get(h_t_lapse_rate)=lapse_rate;
 
 }
@@ -68,6 +68,9 @@ public:
     {
         interpolation interp;
     };
+
+    // variable handles, resolved in init
+    var_handle h_t, h_t_lapse_rate;
 };
 
 /**
@@ -38,6 +38,9 @@ Dodson_NSA_ta::~Dodson_NSA_ta()
 }
 void Dodson_NSA_ta::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_t = handle(domain, "t");
+    h_t_lapse_rate = handle(domain, "t_lapse_rate");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -95,6 +98,6 @@ void Dodson_NSA_ta::run(mesh_elem &face)
     double Ta = ( theta/pow(ratio,exp) );
     Ta -= 273.15;
 
-    (*face)["t"_s]=Ta;
-    (*face)["t_lapse_rate"_s]=lapse;
+    face->get(h_t)=Ta;
+    face->get(h_t_lapse_rate)=lapse;
 }
@@ -44,6 +44,10 @@ Kunkel_monthlyTd_rh::~Kunkel_monthlyTd_rh()
 }
 void Kunkel_monthlyTd_rh::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_t = handle(domain, "t");
+    h_rh = handle(domain, "rh");
+    h_Td_lapse_rate = handle(domain, "Td_lapse_rate");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -110,7 +114,7 @@ void Kunkel_monthlyTd_rh::run(mesh_elem& face)
     double Tdz0 = face->get_module_data<data>(ID).interp(lowered_values, query);//C
 
     //raise value back up to the face's elevation from sea level
-    double t = (*face)["t"_s] + 273.15;
+    double t = face->get(h_t) + 273.15;
     double C = t < 273.15 ? Ci : Cw;
     double B = t < 273.15 ? Bi : Bw;
 
@@ -122,7 +126,7 @@ void Kunkel_monthlyTd_rh::run(mesh_elem& face)
 
     double rh = mio::Atmosphere::DewPointtoRh(Td_z+273.15,t,false);
 
-    (*face)["rh"_s]= rh*100.0;
-    (*face)["Td_lapse_rate"_s]=lapse;
+    face->get(h_rh)= rh*100.0;
+    face->get(h_Td_lapse_rate)=lapse;
 
 }
@@ -71,4 +71,7 @@ public:
     {
         interpolation interp;
     };
+
+    // variable handles, resolved in init
+    var_handle h_t, h_rh, h_Td_lapse_rate;
 };
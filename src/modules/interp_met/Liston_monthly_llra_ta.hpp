@@ -64,4 +64,7 @@ public:
     {
         interpolation interp;
     };
+
+    // variable handles, resolved in init
+    var_handle h_t, h_t_lapse_rate;
 };
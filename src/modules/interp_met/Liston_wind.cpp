@@ -28,6 +28,9 @@ Liston_wind::Liston_wind(config_file cfg)
         : module_base("Liston_wind", parallel::domain, cfg)
 
 {
+    // exchanges ghost halos in run()
+    barrier();
+
     depends_from_met("U_R");
     depends_from_met("vw_dir");
 
@@ -54,6 +57,14 @@ Liston_wind::Liston_wind(config_file cfg)
 //Calculates the curvature required
 void Liston_wind::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_U_R_orig = handle(domain, "U_R_orig");
+    h_zonal_u = handle(domain, "zonal_u");
+    h_zonal_v = handle(domain, "zonal_v");
+    h_vw_dir_orig = handle(domain, "vw_dir_orig");
+    h_U_R = handle(domain, "U_R");
+    h_vw_dir = handle(domain, "vw_dir");
+    h_vw_dir_divergence = handle(domain, "vw_dir_divergence");
 
     ys = cfg.get("ys",0.5);
     yc = cfg.get("yc",0.5);
@@ -217,19 +228,19 @@ void Liston_wind::run(mesh& domain)
         face->get_module_data<lwinddata>(ID).corrected_theta = theta;
         face->get_module_data<lwinddata>(ID).W = W;
 
-        (*face)["U_R_orig"_s] = W;
+        face->get(h_U_R_orig) = W;
 
         // Write updated U and V wind components
         double U = -W  * sin(theta);
         double V = -W  * cos(theta);
-        (*face)["zonal_u"_s] = U;
-        (*face)["zonal_v"_s] = V;
+        face->get(h_zonal_u) = U;
+        face->get(h_zonal_v) = V;
 
         // Save original direction
         Vector_2 v_orig = math::gis::bearing_to_cartesian(theta* 180.0 / M_PI);
         Vector_3 v3_orig(-v_orig.x(),-v_orig.y(), 0); //negate as direction it's blowing instead of where it is from!!
         face->set_face_vector("wind_direction_original",v3_orig);
-        (*face)["vw_dir_orig"_s]= theta * 180.0 / M_PI;
+        face->get(h_vw_dir_orig)= theta * 180.0 / M_PI;
 
     }
 
@@ -285,13 +296,13 @@ void Liston_wind::run(mesh& domain)
         }
 
         W = std::max(W,0.1);
-        (*face)["U_R"_s]= W;
-        (*face)["vw_dir"_s]= theta * 180.0 / M_PI;
+        face->get(h_U_R)= W;
+        face->get(h_vw_dir)= theta * 180.0 / M_PI;
 
         Vector_2 v = math::gis::bearing_to_cartesian(theta* 180.0 / M_PI);
         Vector_3 v3(-v.x(),-v.y(), 0); //negate as direction it's blowing instead of where it is from!!
 
-        (*face)["vw_dir_divergence"_s]=fabs( -0.5 * omega_s * sin((2.0 * dirdiff)))*180.0/M_PI ;
+        face->get(h_vw_dir_divergence)=fabs( -0.5 * omega_s * sin((2.0 * dirdiff)))*180.0/M_PI ;
         face->set_face_vector("wind_direction",v3);
     }
 
@@ -308,10 +319,10 @@ void Liston_wind::run(mesh& domain)
         {
            auto neigh = face->neighbor(j);
            if (neigh != nullptr)
-             u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(), (*neigh)["U_R"_s]));
+             u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(), neigh->get(h_U_R)));
         }
 
-        double new_u = (*face)["U_R"_s];
+        double new_u = face->get(h_U_R);
         if(u.size() > 0)
         {
            auto query = boost::make_tuple(face->get_x(), face->get_y(), face->get_z());
@@ -328,7 +339,7 @@ void Liston_wind::run(mesh& domain)
     {
 
         auto face = domain->face(i);
-        (*face)["U_R"_s]=face->get_module_data<lwinddata>(ID).temp_u;
+        face->get(h_U_R)=face->get_module_data<lwinddata>(ID).temp_u;
 
     }
 
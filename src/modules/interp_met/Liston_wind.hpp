@@ -126,4 +126,8 @@ public:
     };
     double distance;
     double Ww_coeff;
+
+    // variable handles, resolved in init
+    var_handle h_U_R_orig, h_zonal_u, h_zonal_v, h_vw_dir_orig, h_U_R, h_vw_dir,
+               h_vw_dir_divergence;
 };
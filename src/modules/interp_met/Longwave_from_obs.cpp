@@ -40,6 +40,8 @@ Longwave_from_obs::~Longwave_from_obs()
 }
 void Longwave_from_obs::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_ilwr = handle(domain, "ilwr");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -72,6 +74,6 @@ void Longwave_from_obs::run(mesh_elem& face)
     //raise value back up to the face's elevation from sea level
     value =  value + lapse_rate * (0.0 - face->get_z());
 
-    (*face)["ilwr"_s]=value;
+    face->get(h_ilwr)=value;
 
 }
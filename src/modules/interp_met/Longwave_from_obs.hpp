@@ -68,4 +68,7 @@ public:
     {
         interpolation interp;
     };
+
+    // variable handles, resolved in init
+    var_handle h_ilwr;
 };
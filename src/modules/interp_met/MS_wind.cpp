@@ -28,6 +28,9 @@ MS_wind::MS_wind(config_file cfg)
         : module_base("MS_wind", parallel::domain, cfg)
 
 {
+    // exchanges ghost halos in run()
+    barrier();
+
     depends_from_met("U_R");
     depends_from_met("vw_dir");
 
@@ -54,6 +57,17 @@ MS_wind::MS_wind(config_file cfg)
 //Calculates the curvature required
 void MS_wind::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_interp_zonal_u = handle(domain, "interp_zonal_u");
+    h_interp_zonal_v = handle(domain, "interp_zonal_v");
+    h_lookup_d = handle(domain, "lookup_d");
+    h_W_speedup = handle(domain, "W_speedup");
+    h_U_R = handle(domain, "U_R");
+    h_vw_dir = handle(domain, "vw_dir");
+    h_2m_zonal_u = handle(domain, "2m_zonal_u");
+    h_2m_zonal_v = handle(domain, "2m_zonal_v");
+    h_vw_dir_orig = handle(domain, "vw_dir_orig");
+
     #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
@@ -63,6 +77,30 @@ void MS_wind::init(mesh& domain)
          d.interp.init(global_param->interp_algorithm,face->stations().size() );
          d.interp_smoothing.init(interp_alg::tpspline,3,{ {"reuse_LU","true"}});
     }
+
+    // Copy the speedup maps out of the face parameters once so that run() does not have to build and hash the
+    // parameter names for every face
+    std::vector< std::vector<std::string> > names(8);
+    if(!use_ryan_dir)
+    {
+        // MS0 (North) to MS7, speedup and the u, v components
+        for (int d = 0; d < 8; d++)
+        {
+            names[d] = {"MS" + std::to_string(d), "MS" + std::to_string(d) + "_U", "MS" + std::to_string(d) + "_V"};
+        }
+    }
+    else
+    {
+        // Ryan uses MS1 to MS8 (North) and only the speedup, direction d is stored at d-1
+        for (int d = 1; d <= 8; d++)
+        {
+            names[d - 1] = {"MS" + std::to_string(d)};
+
+            std::string name = "MS" + std::to_string(d);
+            speedup_hash[d - 1] = xxh64::hash(name.c_str(), name.length());
+        }
+    }
+    library.load(*domain, names);
 }
 
 
@@ -105,8 +143,8 @@ void MS_wind::run(mesh& domain)
 		     double zonal_u = face->get_module_data<data>(ID).interp(u, query);
 		     double zonal_v = face->get_module_data<data>(ID).interp(v, query);
 
-		     (*face)["interp_zonal_u"_s]= zonal_u;
-		     (*face)["interp_zonal_v"_s]= zonal_v;
+		     face->get(h_interp_zonal_u)= zonal_u;
+		     face->get(h_interp_zonal_v)= zonal_v;
 
 		     //Get back the interpolated wind direction
 		     // -- not sure if there is a better way to do this, but at least a first order to getting the right direction
@@ -119,17 +157,17 @@ void MS_wind::run(mesh& domain)
 
 		     if (d == 8) d = 0; // floor(360/45) = 8, which we don't have, as 0 is already North, so use that.
 
-		     (*face)["lookup_d"_s]= d;
+		     face->get(h_lookup_d)= d;
 
 		     // get the speedup for the interpolated direction
-		     double U_speedup = face->parameter("MS" + std::to_string(d) + "_U");
-		     double V_speedup = face->parameter("MS" + std::to_string(d) + "_V");
-		     double W_speedup = face->parameter("MS" + std::to_string(d));
+		     double U_speedup = library(i, d, lib_u);
+		     double V_speedup = library(i, d, lib_v);
+		     double W_speedup = library(i, d, lib_speedup);
 
 		     // Speed up interpolated zonal_u & zonal_v
 		     double W = sqrt(zonal_u * zonal_u + zonal_v * zonal_v) * W_speedup;
 		     W = std::max(W, 0.1);
-		     (*face)["W_speedup"_s]= W;
+		     face->get(h_W_speedup)= W;
 
 		     //Now recover a U and V from this to get a new direction
 		     double U = U_speedup * W;
@@ -144,11 +182,11 @@ void MS_wind::run(mesh& domain)
 						    Atmosphere::Z_U_R,  // UR is at our reference height
 						    0); // no canopy, no snow, but uses a snow roughness
 
-		     (*face)["U_R"_s]= W;
-		     (*face)["vw_dir"_s]= theta * 180.0 / M_PI;
+		     face->get(h_U_R)= W;
+		     face->get(h_vw_dir)= theta * 180.0 / M_PI;
 
-		     (*face)["2m_zonal_u"_s]= U; // these are still 2m
-		     (*face)["2m_zonal_v"_s]= V;
+		     face->get(h_2m_zonal_u)= U; // these are still 2m
+		     face->get(h_2m_zonal_v)= V;
 
 		     Vector_2 v_corr = math::gis::bearing_to_cartesian(theta * 180.0 / M_PI);
 		     Vector_3 v3(-v_corr.x(), -v_corr.y(), 0); //negate as direction it's blowing instead of where it is from!!
@@ -159,7 +197,7 @@ void MS_wind::run(mesh& domain)
 		     //        Vector_3 v3_orig(-v_orig.x(),-v_orig.y(), 0); //negate as direction it's blowing instead of where it is from!!
 		     //        face->set_face_vector("wind_direction_original",v3_orig);
 
-		     (*face)["vw_dir_orig"_s]= theta_orig * 180.0 / M_PI;
+		     face->get(h_vw_dir_orig)= theta_orig * 180.0 / M_PI;
 
         }
 
@@ -180,7 +218,7 @@ void MS_wind::run(mesh& domain)
             {
                 try
                 {
-                    u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(), (*neigh)["U_R"_s]));
+                    u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(), neigh->get(h_U_R)));
                 }
                 catch (...)
                 {
@@ -209,7 +247,7 @@ void MS_wind::run(mesh& domain)
 
           }
 
-          double new_u = (*face)["U_R"_s];
+          double new_u = face->get(h_U_R);
 
           if (u.size() > 0)
           {
@@ -228,7 +266,7 @@ void MS_wind::run(mesh& domain)
         {
             auto face = domain->face(i);
 
-		     (*face)["U_R"_s]= std::max(0.1, face->get_module_data<data>(ID).temp_u);
+		     face->get(h_U_R)= std::max(0.1, face->get_module_data<data>(ID).temp_u);
         }
 
     }else
@@ -254,7 +292,8 @@ void MS_wind::run(mesh& domain)
                //figure out which lookup map we need
                int d = int(theta*180/M_PI/45.);
                if (d == 0) d = 8;
-               double speedup = f->parameter("MS"+std::to_string(d));
+               // the closest face isn't necessarily a local face, so look it up by the parameter
+               double speedup = f->parameter(speedup_hash[d - 1]);
 
                double W = (*s)["U_R"_s] / speedup;
                W = std::max(W, 0.1);
@@ -341,7 +380,7 @@ void MS_wind::run(mesh& domain)
 		     int d = int(theta*180.0/M_PI/45.);
 		     if (d == 0) d = 8;
 
-		     double speedup = face->parameter("MS"+std::to_string(d));
+		     double speedup = library(i, d - 1, lib_speedup);
 		     W = W*speedup;
 
 		     W = std::max(W,0.1);
@@ -353,8 +392,8 @@ void MS_wind::run(mesh& domain)
 						    0); // no canopy, no snow, but uses a snow roughness
 
 
-		     (*face)["U_R"_s]= W;
-		     (*face)["vw_dir"_s]= theta * 180.0 / M_PI;
+		     face->get(h_U_R)= W;
+		     face->get(h_vw_dir)= theta * 180.0 / M_PI;
 
 
 		     Vector_2 v = math::gis::bearing_to_cartesian(theta* 180.0 / M_PI);
@@ -378,11 +417,11 @@ void MS_wind::run(mesh& domain)
 		     {
 		       auto neigh = face->neighbor(j);
 		       if (neigh != nullptr)
-			 u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(),(*neigh)["U_R"_s]));
+			 u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(),neigh->get(h_U_R)));
 		     }
 
 
-		     double new_u = (*face)["U_R"_s];
+		     double new_u = face->get(h_U_R);
 		     if (u.size() > 0)
 		     {
 		       auto query = boost::make_tuple(face->get_x(), face->get_y(), face->get_z());
@@ -398,7 +437,7 @@ void MS_wind::run(mesh& domain)
         {
             auto face = domain->face(i);
 
-		     (*face)["U_R"_s]= std::max(0.1,face->get_module_data<data>(ID).temp_u) ;
+		     face->get(h_U_R)= std::max(0.1,face->get_module_data<data>(ID).temp_u) ;
 
         }
 
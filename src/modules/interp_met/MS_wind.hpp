@@ -115,4 +115,17 @@ public:
     double distance;
     bool use_ryan_dir;
     double speedup_height; // height at which the speedup is for
+
+    // speedup library, [face][direction][component]
+    direction_library library;
+    static constexpr size_t lib_speedup = 0;
+    static constexpr size_t lib_u = 1;
+    static constexpr size_t lib_v = 2;
+
+    // parameter hash of the speedup for each direction, used for lookups on non-local faces
+    uint64_t speedup_hash[8];
+
+    // variable handles, resolved in init
+    var_handle h_interp_zonal_u, h_interp_zonal_v, h_lookup_d, h_W_speedup, h_U_R, h_vw_dir,
+               h_2m_zonal_u, h_2m_zonal_v, h_vw_dir_orig;
 };
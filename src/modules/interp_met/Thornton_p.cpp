@@ -41,6 +41,9 @@ Thornton_p::Thornton_p(config_file cfg)
 }
 void Thornton_p::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_p = handle(domain, "p");
+    h_p_no_slope = handle(domain, "p_no_slope");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -95,10 +98,10 @@ void Thornton_p::run(mesh_elem& face)
     }
 
     P_fin =  std::max(0.0,P_fin);
-    (*face)["p"_s]= P_fin;
+    face->get(h_p)= P_fin;
 
     P = std::max(0.0,P);
-    (*face)["p_no_slope"_s]= P;
+    face->get(h_p_no_slope)= P;
 
 }
 
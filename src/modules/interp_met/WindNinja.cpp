@@ -71,12 +71,38 @@ WindNinja::WindNinja(config_file cfg)
 
     }
 
+    ninja_recirc = cfg.get("ninja_recirc",false);
+    Sx_azimuth_bins = cfg.get("Sx_azimuth_bins", 72);
+
+    // our Winstral_parameters precomputes Sx from the initial terrain, which would go stale as deform_mesh moves the vertices
+    if(compute_Sx && ninja_recirc && Sx_azimuth_bins > 0)
+    {
+        conflicts("deform_mesh", "The precomputed Sx is not updated as the mesh deforms. Set WindNinja Sx_azimuth_bins "
+                                 "to 0 to search every timestep");
+    }
+
     SPDLOG_DEBUG("Successfully instantiated module {}",this->ID);
 }
 
 //Calculates the curvature required
 void WindNinja::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_interp_zonal_u = handle(domain, "interp_zonal_u");
+    h_interp_zonal_v = handle(domain, "interp_zonal_v");
+    h_vw_dir_orig = handle(domain, "vw_dir_orig");
+    h_lookup_d = handle(domain, "lookup_d");
+    h_U_R_orig = handle(domain, "U_R_orig");
+    h_vw_dir = handle(domain, "vw_dir");
+    if(compute_Sx)
+        h_Sx = handle(domain, "Sx");
+    h_W_transf = handle(domain, "W_transf");
+    h_Ninja_speed = handle(domain, "Ninja_speed");
+    h_U_R = handle(domain, "U_R");
+    h_zonal_u = handle(domain, "zonal_u");
+    h_zonal_v = handle(domain, "zonal_v");
+    h_vw_dir_divergence = handle(domain, "vw_dir_divergence");
+
     #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
@@ -201,58 +227,36 @@ void WindNinja::init(mesh& domain)
         }
     }
 
-    // Ensure that L_avg, either given or found, is valid
-    int valid_Lavg_params=0;
-
-    for(int theta = 0; theta<=2*M_PI;theta++)
+    // Copy the library out of the face parameters once so that run() does not have to build and hash the parameter
+    // names for every face. This also ensures that L_avg, either given or found, is valid
+    std::vector< std::vector<std::string> > names(N_windfield);
+    for (int d = 1; d <= N_windfield; d++)
     {
-        auto delta_angle = 360. / N_windfield;
-        auto d = int(theta * 180.0 / M_PI / delta_angle);
-        if (d == 0) d = N_windfield;
-        auto face = domain->face(0);
-
-        std::string param="";
-
-        if(L_avg == -1)
-        {
-            param = "Ninja" + std::to_string(d);
-        }else
-        {
-            param = "Ninja" + std::to_string(d) +'_' + std::to_string(L_avg);   // transfert function
-        }
-
-        if( !face->has_parameter(param))
-        {
-            CHM_THROW_EXCEPTION(module_error,"WindNinja: Missing parameter: " + param);
-        }
-
-        param = "Ninja" + std::to_string(d) + "_U";
-        if( !face->has_parameter(param))
-        {
-            CHM_THROW_EXCEPTION(module_error,"WindNinja: Missing parameter: " + param);
-        }
-
-        param = "Ninja" + std::to_string(d) + "_V";
-        if( !face->has_parameter(param))
-        {
-            CHM_THROW_EXCEPTION(module_error,"WindNinja: Missing parameter: " + param);
-        }
-
+        std::string transf = "Ninja" + std::to_string(d); // transfert function
+        if(L_avg != -1)
+            transf += '_' + std::to_string(L_avg);
+
+        auto& n = names.at(d - 1);
+        n.resize(3);
+        n[lib_transf] = transf;
+        n[lib_u] = "Ninja" + std::to_string(d) + "_U";  // zonal component
+        n[lib_v] = "Ninja" + std::to_string(d) + "_V";  // meridional component
     }
-
+    library.load(*domain, names);
 
     H_forc = cfg.get("H_forc",40.0);
     Max_spdup = cfg.get("Max_spdup",3.);
     Min_spdup = cfg.get("Min_spdup",0.1);
-    ninja_recirc = cfg.get("ninja_recirc",false);
     Sx_crit = cfg.get("Sx_crit", 30.);
 
-    if(compute_Sx)
+    // Sx is only read to find the recirculation zones, so don't pay for its search otherwise
+    if(compute_Sx && ninja_recirc)
     {
 
         config_file tmp;
         tmp.put("angular_window",30.);
         tmp.put("size_of_step",10.);
+        tmp.put("azimuth_bins",Sx_azimuth_bins);
 
         if(has_optional("snowdepthavg"))
         {
@@ -260,6 +264,9 @@ void WindNinja::init(mesh& domain)
         }
 
         Sx = boost::dynamic_pointer_cast<Winstral_parameters>(module_factory::create("Winstral_parameters",tmp));
+
+        // not scheduled by core, so precompute its Sx table here
+        Sx->init(domain);
     }
 }
 
@@ -310,7 +317,7 @@ void WindNinja::run(mesh& domain)
              * When we are reusing other modules' members they ofc need to be thread safe
              */
 //            if(compute_Sx)
-//                (*face)["Sx"_s]= Sx->Sx(domain,face);
+//                (*face)["Sx"_s]= Sx->Sx(domain,face,i);
 
             //http://mst.nerc.ac.uk/wind_vect_convs.html
 
@@ -319,8 +326,8 @@ void WindNinja::run(mesh& domain)
             double zonal_u = face->get_module_data<data>(ID).interp(u, query);
             double zonal_v = face->get_module_data<data>(ID).interp(v, query);
 
-            (*face)["interp_zonal_u"_s]= zonal_u;
-            (*face)["interp_zonal_v"_s]= zonal_v;
+            face->get(h_interp_zonal_u)= zonal_u;
+            face->get(h_interp_zonal_v)= zonal_v;
 
             //Get back the interpolated wind direction
             // -- not sure if there is a better way to do this, but at least a first order to getting the right direction
@@ -332,7 +339,7 @@ void WindNinja::run(mesh& domain)
             Vector_2 v_orig = math::gis::bearing_to_cartesian(theta_orig* 180.0 / M_PI);
             Vector_3 v3_orig(-v_orig.x(),-v_orig.y(), 0); //negate as direction it's blowing instead of where it is from!!
             face->set_face_vector("wind_direction_original",v3_orig);
-            (*face)["vw_dir_orig"_s]= theta_orig * 180.0 / M_PI;
+            face->get(h_vw_dir_orig)= theta_orig * 180.0 / M_PI;
 
             double U = 0.;
             double V = 0.;
@@ -344,18 +351,12 @@ void WindNinja::run(mesh& domain)
                 // Wind field are available each delta_angle deg.
                 int d = int(theta * 180.0 / M_PI / delta_angle);
                 if (d == 0) d = N_windfield;
-                (*face)["lookup_d"_s]= d;
+                face->get(h_lookup_d)= d;
 
                 // get the transfert function and associated wind component for the interpolated wind direction
-		if(L_avg == -1)
-                {
-			W_transf = face->parameter("Ninja" + std::to_string(d));   // transfert function
-		}else
-		{
-			W_transf = face->parameter("Ninja" + std::to_string(d) +'_' + std::to_string(L_avg));   // transfert function
-                }
-                U = face->parameter("Ninja" + std::to_string(d) + "_U");  // zonal component
-                V = face->parameter("Ninja" + std::to_string(d) + "_V");  // meridional component
+                W_transf = library(i, d - 1, lib_transf);
+                U = library(i, d - 1, lib_u);  // zonal component
+                V = library(i, d - 1, lib_v);  // meridional component
 
            }else // Linear interpolation between the closest 2 wind fields from the library
            {
@@ -364,43 +365,25 @@ void WindNinja::run(mesh& domain)
                 // Wind fields are available each 15 deg.
                 int d1 = int(theta * 180.0 / M_PI / delta_angle);
                 double theta1 = d1 * delta_angle * M_PI / 180.0;
-                if (d1 == 0) d1 = N_windfield;
 
                 int d2 = int((theta * 180.0 / M_PI + delta_angle) / delta_angle);
                 double theta2 = d2 * delta_angle *M_PI / 180.0;
+
+                // Field N_windfield is both 0 and 360 deg. Wrap so that theta = 2 pi, where d1 = N_windfield and
+                // d2 = N_windfield + 1, interpolates between the last and first fields instead of reading past the library
+                d1 %= N_windfield;
+                d2 %= N_windfield;
+                if (d1 == 0) d1 = N_windfield;
                 if (d2 == 0) d2 = N_windfield;
 
                 double d = d1*(theta2-theta)/(theta2-theta1)+d2*(theta-theta1)/(theta2-theta1);
-                (*face)["lookup_d"_s]= d;
-
-		double W_transf1 = 0.;
-                // get the transfert function and associated wind component for the interpolated wind direction
-		if(L_avg == -1)
-		{
-                	W_transf1 = face->parameter("Ninja" + std::to_string(d1));   // transfert function
-                }else
-		{
-			W_transf1 = face->parameter("Ninja" + std::to_string(d1)+'_' + std::to_string(L_avg));   // transfert function
-		}
-
-                double U_lib1 = face->parameter("Ninja" + std::to_string(d1) + "_U");  // zonal component
-                double V_lib1 = face->parameter("Ninja" + std::to_string(d1) + "_V");  // meridional component
-
-		double W_transf2 = 0.;
-		if(L_avg == -1)
-		{
-                	W_transf2 = face->parameter("Ninja" + std::to_string(d2));   // transfert function
-                }else
-		{
-			W_transf2 = face->parameter("Ninja" + std::to_string(d2)+'_' + std::to_string(L_avg));   // transfert function
-                }
-		double U_lib2 = face->parameter("Ninja" + std::to_string(d2) + "_U");  // zonal component
-                double V_lib2 = face->parameter("Ninja" + std::to_string(d2) + "_V");  // meridional component
+                face->get(h_lookup_d)= d;
 
-                // Determine wind component from the wind field library using a weighted mean
-                U = U_lib1*(theta2-theta)/(theta2-theta1)+U_lib2*(theta-theta1)/(theta2-theta1);
-                V = V_lib1*(theta2-theta)/(theta2-theta1)+V_lib2*(theta-theta1)/(theta2-theta1);
-                W_transf = W_transf1*(theta2-theta)/(theta2-theta1)+W_transf2*(theta-theta1)/(theta2-theta1);
+                // Determine the transfert function and wind components from the wind field library using a weighted mean
+                double w = (theta-theta1)/(theta2-theta1);
+                W_transf = library.lerp(i, d1 - 1, d2 - 1, w, lib_transf);
+                U = library.lerp(i, d1 - 1, d2 - 1, w, lib_u);
+                V = library.lerp(i, d1 - 1, d2 - 1, w, lib_v);
             }
 
             if(fabs(W_transf)> transf_max )
@@ -427,10 +410,10 @@ void WindNinja::run(mesh& domain)
             double W= face->get_module_data<data>(ID).W;
             double W_transf= face->get_module_data<data>(ID).W_transf;
 
-            (*face)["U_R_orig"_s]= W;   // Wind speed without downscaling
+            face->get(h_U_R_orig)= W;   // Wind speed without downscaling
 
 
-            (*face)["vw_dir"_s]= theta * 180.0 / M_PI;
+            face->get(h_vw_dir)= theta * 180.0 / M_PI;
             // Limit speed up value to Max_spdup
             // Can be used to avoid unrelistic values at crest top
             if(W_transf>1. and transf_max>Max_spdup)
@@ -441,19 +424,19 @@ void WindNinja::run(mesh& domain)
                if (ninja_recirc)
                {  // Need further test
 
-                  double sx_loc = Sx->Sx(domain,face);
-                  (*face)["Sx"_s] =sx_loc;
+                  double sx_loc = Sx->Sx(domain,face,i);
+                  face->get(h_Sx) =sx_loc;
                   if( sx_loc>Sx_crit )  //Reduce wind speed on the lee side of mountain crest identified by Sx>Sx_crit
                        W_transf = 0.25;
                 }
             }
 
-            (*face)["W_transf"_s]= W_transf;
+            face->get(h_W_transf)= W_transf;
 
             // NEW wind intensity from the wind field library
             W = W * W_transf;
             W = std::max(W, 0.1);
-            (*face)["Ninja_speed"_s]= W;    // Wind speed with downscaling
+            face->get(h_Ninja_speed)= W;    // Wind speed with downscaling
 
             // Update U and V wind components
             double U = -W  * sin(theta);
@@ -465,18 +448,18 @@ void WindNinja::run(mesh& domain)
                                            Atmosphere::Z_U_R,  // UR is at our reference height
                                            0); // no canopy, no snow, but uses a snow roughness
 
-            (*face)["U_R"_s]= W;
+            face->get(h_U_R)= W;
 
 
-            (*face)["zonal_u"_s]= U; // these are still H_forc
-            (*face)["zonal_v"_s]= V;
+            face->get(h_zonal_u)= U; // these are still H_forc
+            face->get(h_zonal_v)= V;
 
             Vector_2 v_corr = math::gis::bearing_to_cartesian(theta * 180.0 / M_PI);
             Vector_3 v3(-v_corr.x(), -v_corr.y(), 0); //negate as direction it's blowing instead of where it is from!!
             face->set_face_vector("wind_direction", v3);
 
-            double dtheta = (theta * 180.0 / M_PI) -  (*face)["vw_dir_orig"_s];
-           (*face)["vw_dir_divergence"_s] = fabs(dtheta);
+            double dtheta = (theta * 180.0 / M_PI) -  face->get(h_vw_dir_orig);
+           face->get(h_vw_dir_divergence) = fabs(dtheta);
         }
 
 	// Communicate U_R for neighbour access
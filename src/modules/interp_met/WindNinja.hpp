@@ -106,6 +106,15 @@
  *
  *    Enables the leeside slow down via ``compute_Sx``. Requires ``"compute_Sx":true``.
  *
+ * .. confval:: Sx_azimuth_bins
+ *
+ *    :type: int
+ *    :default: 72
+ *
+ *    Number of azimuths the Sx used by ``ninja_recirc`` is precomputed for at startup, see ``azimuth_bins`` in
+ *    :ref:`Winstral_parameters`. ``0`` searches every timestep. Sx is computed from the initial terrain and is not
+ *    updated, so a non-zero value cannot be used with ``deform_mesh``.
+ *
  * .. confval:: Sx_crit
  *
  *    :type: double
@@ -190,6 +199,18 @@ public:
     bool ninja_recirc; // Boolean to activate wind speed reduction on the leeside of mountainous terrain
 
     bool compute_Sx; // uses the Sx module to influence the windspeeds so Sx needs to be computed during the windspeed evaluation, instead of a seperate module
+    size_t Sx_azimuth_bins; // azimuths the Sx is precomputed for, 0 to search every timestep
     double Sx_crit;    // Critical values of the Winstral parameter to determine the occurence of flow separation.
     boost::shared_ptr<Winstral_parameters> Sx;
+
+    // wind field library, [face][direction][component] with direction d stored at d-1
+    direction_library library;
+    static constexpr size_t lib_transf = 0; // transfert function
+    static constexpr size_t lib_u = 1;      // zonal component
+    static constexpr size_t lib_v = 2;      // meridional component
+
+    // variable handles, resolved in init
+    var_handle h_interp_zonal_u, h_interp_zonal_v, h_vw_dir_orig, h_lookup_d, h_U_R_orig, h_vw_dir,
+               h_Sx, h_W_transf, h_Ninja_speed, h_U_R, h_zonal_u, h_zonal_v,
+               h_vw_dir_divergence;
 };
@@ -64,10 +64,40 @@ Winstral_parameters::Winstral_parameters(config_file cfg)
     // Option to compute the elevation of the point considered to compute Sx
     use_subgridz = cfg.get("use_subgridz",true);
 
+    azimuth_bins = cfg.get("azimuth_bins", 72);
+
+    // the snow depth changes each timestep so can't be searched once up front
+    if (incl_snw)
+        azimuth_bins = 0;
+
+    // Sx is searched once from the initial terrain, so it would go stale as deform_mesh moves the vertices
+    if (azimuth_bins > 0)
+        conflicts("deform_mesh", "The precomputed Sx is not updated as the mesh deforms. Set Winstral_parameters "
+                                 "azimuth_bins to 0 to search every timestep");
+
 
     SPDLOG_DEBUG("Successfully instantiated module {}",this->ID);
 }
 
+void Winstral_parameters::init(mesh& domain)
+{
+    if (azimuth_bins == 0)
+        return;
+
+    // terrain and vegetation are static, so search each azimuth once up front
+    sx_table.init(domain->size_faces(), azimuth_bins);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto face = domain->face(i);
+        for (size_t k = 0; k < azimuth_bins; k++)
+        {
+            sx_table(i, k) = Sx_direction(domain, face, sx_table.bin_azimuth(k));
+        }
+    }
+}
+
 void Winstral_parameters::run(mesh& domain)
 {
 
@@ -79,7 +109,7 @@ void Winstral_parameters::run(mesh& domain)
         auto face = domain->face(i);
 
         // Derive Sx averaged over the angular windows
-        double sx_mean = Sx(domain,face);
+        double sx_mean = Sx(domain,face,i);
 
         (*face)["Sx"_s]= sx_mean;
 
@@ -87,7 +117,30 @@ void Winstral_parameters::run(mesh& domain)
 
 }
 
-double Winstral_parameters::Sx(const mesh &domain, mesh_elem& face) const
+double Winstral_parameters::Sx(const mesh &domain, mesh_elem& face, size_t row) const
+{
+    double sx_mean  = 0.;
+
+    // Extract Wind direction
+    double wind_dir = (*face)["vw_dir"_s] ;
+
+    for (int i = 1; i <= this->nangle; ++i)
+    {
+        //direction it is from,i need upwind fetch
+        double wdir = wind_dir - this->angular_window / 2.0 + (i - 1) * this->delta_angle;
+
+        if (this->azimuth_bins > 0)
+            sx_mean = sx_mean + sx_table.at(row, wdir);
+        else
+            sx_mean = sx_mean + Sx_direction(domain, face, wdir);
+    }
+
+    // Derive Sx averaged over the angular windows
+    sx_mean = sx_mean / this->nangle;
+    return sx_mean*180/M_PI;
+}
+
+double Winstral_parameters::Sx_direction(const mesh &domain, mesh_elem& face, double wdir) const
 {
     // Reference point: center of the triangle
     auto face_centre = face->center();
@@ -104,65 +157,46 @@ double Winstral_parameters::Sx(const mesh &domain, mesh_elem& face) const
          Z_loc = Z_loc + (*face)["snowdepthavg"_s];
     }
 
-    double sx_mean  = 0.;
-
-    // Extract Wind direction
-    double wind_dir = (*face)["vw_dir"_s] ;
+    double max_tan_sx = 0.;
 
-    for (int i = 1; i <= this->nangle; ++i)
+   // search along wdir azimuth in j step increments
+    for (int j = 1; j <= this->steps; ++j)
     {
-
-        double sx = -9999.0;
-        double max_tan_sx = 0.;
-
-        //direction it is from,i need upwind fetch
-        double wdir = wind_dir - this->angular_window / 2.0 + (i - 1) * this->delta_angle;
-
-       // search along wdir azimuth in j step increments
-        for (int j = 1; j <= this->steps; ++j)
-        {
-           double distance = j * this->size_of_step;
-
-           // Select point along the line
-           Point_2 pref =  math::gis::point_from_bearing(face_centre, wdir, distance);
-           // Find corresponding triangle
-           auto f = domain->find_closest_face (pref );
-
-           double Z_dist = 0.;
-           if(this->use_subgridz)
-           {
-              Z_dist = f->get_subgrid_z(pref);
-           }
-           else
-           {
-              Z_dist = face_centre.z();
-           }
-
-           if (this->incl_veg && f->has_vegetation())
-           {
-               Z_dist = Z_dist + f->veg_attribute("CanopyHeight");
-            }
-
-           if (this->incl_snw)
-           {
-               Z_dist = Z_dist+ (*f)["snowdepthavg"_s];
-           }
-
-           double tan_sx = (Z_dist-Z_loc) / distance;
-           if(std::abs(tan_sx) > std::abs(max_tan_sx))
-           {
-              max_tan_sx = tan_sx;
-           }
+       double distance = j * this->size_of_step;
+
+       // Select point along the line
+       Point_2 pref =  math::gis::point_from_bearing(face_centre, wdir, distance);
+       // Find corresponding triangle
+       auto f = domain->find_closest_face (pref );
+
+       double Z_dist = 0.;
+       if(this->use_subgridz)
+       {
+          Z_dist = f->get_subgrid_z(pref);
+       }
+       else
+       {
+          Z_dist = face_centre.z();
+       }
+
+       if (this->incl_veg && f->has_vegetation())
+       {
+           Z_dist = Z_dist + f->veg_attribute("CanopyHeight");
         }
 
-        sx = atan(max_tan_sx);
-        sx_mean = sx_mean+sx;
+       if (this->incl_snw)
+       {
+           Z_dist = Z_dist+ (*f)["snowdepthavg"_s];
+       }
 
-     }
+       double tan_sx = (Z_dist-Z_loc) / distance;
+       if(std::abs(tan_sx) > std::abs(max_tan_sx))
+       {
+          max_tan_sx = tan_sx;
+       }
+    }
 
-    // Derive Sx averaged over the angular windows
-    sx_mean = sx_mean / this->nangle;
-    return sx_mean*180/M_PI;
+    return atan(max_tan_sx);
 }
 
 Winstral_parameters::~Winstral_parameters()
@@ -63,8 +63,9 @@
  *       "angular_window": 30.0,
  *       "delta_angle" : 5.0,
  *       "incl_veg": false,
- *       "incl_snw": false
- *       "use_subgridz": true
+ *       "incl_snw": false,
+ *       "use_subgridz": true,
+ *       "azimuth_bins": 72
  *    }
  *
  * .. confval:: dmax
@@ -122,6 +123,17 @@
  *
  *    Use an interpolated height within the triangle instead of just the triangle cell centre. Avoids step function results.
  *
+ * .. confval:: azimuth_bins
+ *
+ *    :type: int
+ *    :default: 72
+ *
+ *    Number of azimuths Sx is precomputed for at startup. Each timestep the Sx of each direction in the angular window
+ *    is interpolated between the two nearest azimuths instead of being searched for. ``0`` disables the precomputation
+ *    and searches along each direction every timestep. As the snow depth changes each timestep, the precomputation is
+ *    not used with ``incl_snw``. Sx is computed from the initial terrain and is not updated, so a non-zero value
+ *    cannot be used with ``deform_mesh``.
+ *
  * \endrst
  *
  * **References:**
@@ -139,6 +151,7 @@ public:
 
 
     virtual void run(mesh& domain);
+    virtual void init(mesh& domain);
 
     //number of steps along the search vector to check for a higher point
     int steps;
@@ -175,6 +188,13 @@ public:
     // Improve estimation of Sx when snow is accumulating during the snow season
     bool incl_snw;
 
-    // Calculates the Sx parameter
-    double Sx(const mesh &domain, mesh_elem& face) const;
+    // number of azimuths in the precomputed Sx, 0 if searched every timestep
+    size_t azimuth_bins;
+    azimuth_table sx_table;
+
+    // Calculates the Sx parameter averaged over the angular window. row is the face's row in sx_table
+    double Sx(const mesh &domain, mesh_elem& face, size_t row) const;
+
+    // Searches for the Sx [rad] in the single direction wdir [deg]
+    double Sx_direction(const mesh &domain, mesh_elem& face, double wdir) const;
 };
@@ -42,6 +42,8 @@ const_llra_ta::~const_llra_ta()
 
 void const_llra_ta::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_t = handle(domain, "t");
 
     #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -76,6 +78,6 @@ void const_llra_ta::run(mesh_elem& face)
     //raise value back up to the face's elevation from sea level
     value =  value + lapse_rate * (0.0 - face->get_z());
 
-    (*face)["t"_s]=value;
+    face->get(h_t)=value;
 
 }
@@ -66,5 +66,7 @@ public:
         interpolation interp;
     };
 
+    // variable handles, resolved in init
+    var_handle h_t;
 };
 
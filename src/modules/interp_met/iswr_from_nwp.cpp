@@ -43,6 +43,10 @@ iswr_from_nwp::~iswr_from_nwp()
 }
 void iswr_from_nwp::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_iswr_direct_no_slope = handle(domain, "iswr_direct_no_slope");
+    h_iswr_diffuse_no_slope = handle(domain, "iswr_diffuse_no_slope");
+    h_iswr_observed = handle(domain, "iswr_observed");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -83,8 +87,8 @@ void iswr_from_nwp::run(mesh_elem &face)
     split_dir = std::max(0.0,split_dir);
     split_diff = std::max(0.0,split_diff);
 
-    (*face)["iswr_direct_no_slope"_s]=split_dir;
-    (*face)["iswr_diffuse_no_slope"_s]=split_diff;
-    (*face)["iswr_observed"_s]=iswr_observed;
+    face->get(h_iswr_direct_no_slope)=split_dir;
+    face->get(h_iswr_diffuse_no_slope)=split_diff;
+    face->get(h_iswr_observed)=iswr_observed;
 
 }
@@ -59,4 +59,7 @@ public:
     {
         interpolation interp;
     };
+
+    // variable handles, resolved in init
+    var_handle h_iswr_direct_no_slope, h_iswr_diffuse_no_slope, h_iswr_observed;
 };
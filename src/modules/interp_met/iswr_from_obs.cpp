@@ -44,6 +44,12 @@ iswr_from_obs::~iswr_from_obs()
 }
 void iswr_from_obs::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_solar_el = handle(domain, "solar_el");
+    h_iswr_direct_no_slope = handle(domain, "iswr_direct_no_slope");
+    h_iswr_diffuse_no_slope = handle(domain, "iswr_diffuse_no_slope");
+    h_iswr_observed = handle(domain, "iswr_observed");
+    h_atm_trans = handle(domain, "atm_trans");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -79,7 +85,7 @@ void iswr_from_obs::run(mesh_elem &face)
     // compute the fraction of direct radiation using the parameterization of Nijssen and Lettenmaier (1999)
     double Frad_direct = 0.7000;
     double directScale = 0.0900;
-    double cosZenith = cos( M_PI/2.0 -  ((*face)["solar_el"_s]*mio::Cst::to_rad)) ; //zenith is from 90 vert -> 0 horz
+    double cosZenith = cos( M_PI/2.0 -  (face->get(h_solar_el)*mio::Cst::to_rad)) ; //zenith is from 90 vert -> 0 horz
     double scalarFractionDirect = 0;
 
     if(cosZenith > 0. )
@@ -91,9 +97,9 @@ void iswr_from_obs::run(mesh_elem &face)
     split_dir = std::max(0.0,split_dir);
     split_diff = std::max(0.0,split_diff);
 
-    (*face)["iswr_direct_no_slope"_s]=split_dir;
-    (*face)["iswr_diffuse_no_slope"_s]=split_diff;
-    (*face)["iswr_observed"_s]=iswr_observed;
+    face->get(h_iswr_direct_no_slope)=split_dir;
+    face->get(h_iswr_diffuse_no_slope)=split_diff;
+    face->get(h_iswr_observed)=iswr_observed;
 
-    (*face)["atm_trans"_s]=split_dir/1375.;
+    face->get(h_atm_trans)=split_dir/1375.;
 }
@@ -64,4 +64,7 @@ public:
     {
         interpolation interp;
     };
+
+    // variable handles, resolved in init
+    var_handle h_solar_el, h_iswr_direct_no_slope, h_iswr_diffuse_no_slope, h_iswr_observed, h_atm_trans;
 };
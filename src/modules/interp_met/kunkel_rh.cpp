@@ -40,6 +40,8 @@ kunkel_rh::~kunkel_rh()
 }
 void kunkel_rh::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_rh = handle(domain, "rh");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -91,6 +93,6 @@ void kunkel_rh::run(mesh_elem &face)
 
     rh = std::min(rh, 100.0);
     rh = std::max(10.0, rh);
-    (*face)["rh"_s]= rh;
+    face->get(h_rh)= rh;
 
 }
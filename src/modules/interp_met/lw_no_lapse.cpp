@@ -43,6 +43,8 @@ lw_no_lapse::~lw_no_lapse()
 
 void lw_no_lapse::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_ilwr = handle(domain, "ilwr");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -54,6 +56,35 @@ void lw_no_lapse::init(mesh& domain)
 
     }
 
+    // idw and nearest can interpolate every face at once with precomputed weights, which needs this to run domain parallel.
+    // Point mode only runs a single face, so stay data parallel there
+    use_weights = interp_weights::supports(global_param->interp_algorithm) && !global_param->is_point_mode();
+    if(use_weights)
+    {
+        weights.init(global_param->interp_algorithm, domain);
+        _parallel_type = parallel::domain;
+    }
+
+}
+
+void lw_no_lapse::run(mesh& domain)
+{
+    auto& stations = weights.stations();
+    station_values.resize(stations.size());
+    for (size_t j = 0; j < stations.size(); j++)
+    {
+        auto& s = stations[j];
+        station_values[j] = is_nan((*s)["Qli"_s]) ? std::numeric_limits<double>::quiet_NaN() : (*s)["Qli"_s];
+    }
+
+    weights.apply(station_values, face_values);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto face = domain->face(i);
+        face->get(h_ilwr)=face_values[i];
+    }
 }
 
 void lw_no_lapse::run(mesh_elem& face)
@@ -73,6 +104,6 @@ void lw_no_lapse::run(mesh_elem& face)
     auto query = boost::make_tuple(face->get_x(), face->get_y(), face->get_z());
     double value = face->get_module_data<data>(ID).interp(lowered_values, query);
 
-    (*face)["ilwr"_s]=value;
+    face->get(h_ilwr)=value;
 
 }
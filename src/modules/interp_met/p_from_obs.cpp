@@ -46,6 +46,9 @@ template <typename T> int signum(T val) {
 }
 void p_from_obs::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_p_lapse = handle(domain, "p_lapse");
+    h_p = handle(domain, "p");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -118,7 +121,7 @@ void p_from_obs::run(mesh_elem& face)
         last_update = global_param->posix_time();
     }
 
-    (*face)["p_lapse"_s]=lapse;
+    face->get(h_p_lapse)=lapse;
 
     //now do the full interpolation
     std::vector< boost::tuple<double, double, double> > ppt;
@@ -149,7 +152,7 @@ void p_from_obs::run(mesh_elem& face)
     double P = p0*( (1+f)/(1-f));
     P = std::max(0.0,P);
 
-    (*face)["p"_s]= P;
+    face->get(h_p)= P;
 
 
 }
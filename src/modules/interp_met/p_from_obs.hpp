@@ -58,4 +58,7 @@ public:
     {
         interpolation interp;
     };
+
+    // variable handles, resolved in init
+    var_handle h_p_lapse, h_p;
 };
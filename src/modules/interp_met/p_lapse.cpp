@@ -41,6 +41,10 @@ p_lapse::p_lapse(config_file cfg)
 }
 void p_lapse::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_p = handle(domain, "p");
+    h_p_no_slope = handle(domain, "p_no_slope");
+
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
@@ -107,10 +111,10 @@ void p_lapse::run(mesh_elem& face)
     }
 
     P_fin =  std::max(0.0,P_fin);
-    (*face)["p"_s]= P_fin;
+    face->get(h_p)= P_fin;
 
     P = std::max(0.0,P);
-    (*face)["p_no_slope"_s]= P;
+    face->get(h_p_no_slope)= P;
 
 }
 
@@ -93,4 +93,6 @@ public:
     // Correct precipitation input using triangle slope when input preciptation are given for the horizontally projected area.
     bool apply_cosine_correction;
 
+    // variable handles, resolved in init
+    var_handle h_p, h_p_no_slope;
 };
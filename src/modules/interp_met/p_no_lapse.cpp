@@ -39,6 +39,9 @@ p_no_lapse::p_no_lapse(config_file cfg)
 }
 void p_no_lapse::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_p = handle(domain, "p");
+    h_p_no_slope = handle(domain, "p_no_slope");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -48,7 +51,54 @@ void p_no_lapse::init(mesh& domain)
         d.interp.init(global_param->interp_algorithm,face->stations().size() );
     }
 
+    // idw and nearest can interpolate every face at once with precomputed weights, which needs this to run domain parallel.
+    // Point mode only runs a single face, so stay data parallel there
+    use_weights = interp_weights::supports(global_param->interp_algorithm) && !global_param->is_point_mode();
+    if(use_weights)
+    {
+        weights.init(global_param->interp_algorithm, domain);
+        _parallel_type = parallel::domain;
+    }
+
 }
+
+void p_no_lapse::run(mesh& domain)
+{
+    auto& stations = weights.stations();
+    station_values.resize(stations.size());
+    for (size_t j = 0; j < stations.size(); j++)
+    {
+        auto& s = stations[j];
+        station_values[j] = is_nan((*s)["p"_s]) ? std::numeric_limits<double>::quiet_NaN() : (*s)["p"_s];
+    }
+
+    weights.apply(station_values, face_values);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto face = domain->face(i);
+        double p0 = face_values[i];
+
+        double P_fin = -9999;
+
+        // Correct precipitation input using triangle slope when input preciptation are given for the horizontally projected area.
+        if(apply_cosine_correction)
+        {
+            double slp = face->slope();
+            P_fin = Atmosphere::corr_precip_slope(p0,slp);
+        } else
+        {
+            P_fin = p0;
+        }
+
+        P_fin =  std::max(0.0,P_fin);
+
+        face->get(h_p)= P_fin;
+        face->get(h_p_no_slope)= std::max(0.0,p0);
+    }
+}
+
 void p_no_lapse::run(mesh_elem& face)
 {
 
@@ -80,8 +130,8 @@ void p_no_lapse::run(mesh_elem& face)
 
     P_fin =  std::max(0.0,P_fin);
 
-    (*face)["p"_s]= P_fin;
-    (*face)["p_no_slope"_s]= std::max(0.0,p0);
+    face->get(h_p)= P_fin;
+    face->get(h_p_no_slope)= std::max(0.0,p0);
 
 }
 
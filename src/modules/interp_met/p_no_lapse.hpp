@@ -28,6 +28,7 @@
 #include "logger.hpp"
 #include "triangulation.hpp"
 #include "module_base.hpp"
+#include "interp_weights.hpp"
 
 #include <cstdlib>
 #include <string>
@@ -76,6 +77,7 @@ public:
     p_no_lapse(config_file cfg);
     ~p_no_lapse();
     virtual void run(mesh_elem& face);
+    virtual void run(mesh& domain);
     virtual void init(mesh& domain);
     struct data : public face_info
     {
@@ -85,5 +87,13 @@ public:
     // Correct precipitation input using triangle slope when input preciptation are given for the horizontally projected area.
     bool apply_cosine_correction;
 
+    // idw and nearest weights only depend on locations, so they are built once and all faces interpolated at once.
+    // If used, run(mesh&) replaces run(mesh_elem&)
+    interp_weights weights;
+    bool use_weights;
+    std::vector<double> station_values, face_values;
+
+    // variable handles, resolved in init
+    var_handle h_p, h_p_no_slope;
 };
 
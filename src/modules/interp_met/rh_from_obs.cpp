@@ -39,6 +39,9 @@ rh_from_obs::~rh_from_obs()
 }
 void rh_from_obs::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_t = handle(domain, "t");
+    h_rh = handle(domain, "rh");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -109,13 +112,13 @@ void rh_from_obs::run(mesh_elem& face)
     //raise it back up
     ea = ea + lapse*( face->get_z() - 0.0);
 
-    double es = mio::Atmosphere::vaporSaturationPressure((*face)["t"_s]+273.15);
+    double es = mio::Atmosphere::vaporSaturationPressure(face->get(h_t)+273.15);
     double rh = ea/es*100.0;
 
     rh = std::min(rh,100.0);
     rh = std::max(10.0,rh);
 
-    (*face)["rh"_s]=rh;
+    face->get(h_rh)=rh;
 
 
 }
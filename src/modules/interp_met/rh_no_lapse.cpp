@@ -40,6 +40,8 @@ rh_no_lapse::~rh_no_lapse()
 }
 void rh_no_lapse::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_rh = handle(domain, "rh");
 
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -48,6 +50,39 @@ void rh_no_lapse::init(mesh& domain)
         auto& d = face->make_module_data<rh_no_lapse::data>(ID);
         d.interp.init(global_param->interp_algorithm,face->stations().size() );
     }
+
+    // idw and nearest can interpolate every face at once with precomputed weights, which needs this to run domain parallel.
+    // Point mode only runs a single face, so stay data parallel there
+    use_weights = interp_weights::supports(global_param->interp_algorithm) && !global_param->is_point_mode();
+    if(use_weights)
+    {
+        weights.init(global_param->interp_algorithm, domain);
+        _parallel_type = parallel::domain;
+    }
+
+}
+
+void rh_no_lapse::run(mesh& domain)
+{
+    auto& stations = weights.stations();
+    station_values.resize(stations.size());
+    for (size_t j = 0; j < stations.size(); j++)
+    {
+        auto& s = stations[j];
+        station_values[j] = is_nan((*s)["rh"_s]) ? std::numeric_limits<double>::quiet_NaN() : (*s)["rh"_s];
+    }
+
+    weights.apply(station_values, face_values);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto face = domain->face(i);
+
+        double rh = std::min(face_values[i], 100.0);
+        rh = std::max(10.0, rh);
+        face->get(h_rh)= rh;
+    }
 }
 
 void rh_no_lapse::run(mesh_elem &face)
@@ -68,6 +103,6 @@ void rh_no_lapse::run(mesh_elem &face)
 
     rh = std::min(rh, 100.0);
     rh = std::max(10.0, rh);
-    (*face)["rh"_s]= rh;
+    face->get(h_rh)= rh;
 
 }
@@ -26,6 +26,7 @@
 #include "logger.hpp"
 #include "triangulation.hpp"
 #include "module_base.hpp"
+#include "interp_weights.hpp"
 
 /**
  * \ingroup modules met rh
@@ -53,11 +54,21 @@ public:
     ~rh_no_lapse();
 
     virtual void run(mesh_elem &face);
+    virtual void run(mesh& domain);
     virtual void init(mesh& domain);
     struct data : public face_info
     {
         interpolation interp;
     };
+
+    // idw and nearest weights only depend on locations, so they are built once and all faces interpolated at once.
+    // If used, run(mesh&) replaces run(mesh_elem&)
+    interp_weights weights;
+    bool use_weights;
+    std::vector<double> station_values, face_values;
+
+    // variable handles, resolved in init
+    var_handle h_rh;
 };
 
 
@@ -42,6 +42,10 @@ t_monthly_lapse::~t_monthly_lapse()
 }
 void t_monthly_lapse::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_t = handle(domain, "t");
+    h_t_lapse_rate = handle(domain, "t_lapse_rate");
+
 #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
@@ -66,6 +70,43 @@ void t_monthly_lapse::init(mesh& domain)
     MLR[10]=cfg.get("MLR_11",0.0049);
     MLR[11]=cfg.get("MLR_12",0.0049);
 
+    // idw and nearest can interpolate every face at once with precomputed weights, which needs this to run domain parallel.
+    // Point mode only runs a single face, so stay data parallel there
+    use_weights = interp_weights::supports(global_param->interp_algorithm) && !global_param->is_point_mode();
+    if(use_weights)
+    {
+        weights.init(global_param->interp_algorithm, domain);
+        _parallel_type = parallel::domain;
+    }
+
+}
+
+void t_monthly_lapse::run(mesh& domain)
+{
+    double lapse_rate = MLR[global_param->month()-1];
+
+    //lower all the station values to sea level prior to the interpolation
+    auto& stations = weights.stations();
+    station_values.resize(stations.size());
+    for (size_t j = 0; j < stations.size(); j++)
+    {
+        auto& s = stations[j];
+        station_values[j] = is_nan((*s)["t"_s]) ? std::numeric_limits<double>::quiet_NaN() : (*s)["t"_s] - lapse_rate * (0.0 - s->z());
+    }
+
+    weights.apply(station_values, face_values);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto face = domain->face(i);
+
+        //raise value back up to the face's elevation from sea level
+        double value = face_values[i] + lapse_rate * (0.0 - face->get_z());
+
+        face->get(h_t)=value;
+        face->get(h_t_lapse_rate)=lapse_rate;
+    }
 }
 void t_monthly_lapse::run(mesh_elem& face)
 {
@@ -89,8 +130,8 @@ void t_monthly_lapse::run(mesh_elem& face)
     //raise value back up to the face's elevation from sea level
     value =  value + lapse_rate * (0.0 - face->get_z());
 
-    (*face)["t"_s]=value;
+    face->get(h_t)=value;
 
-    (*face)["t_lapse_rate"_s]=lapse_rate;
+    face->get(h_t_lapse_rate)=lapse_rate;
 
 }
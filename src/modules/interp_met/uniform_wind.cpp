@@ -43,6 +43,9 @@ uniform_wind::uniform_wind(config_file cfg)
 //Calculates the curvature required
 void uniform_wind::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_U_R = handle(domain, "U_R");
+    h_vw_dir = handle(domain, "vw_dir");
 
     #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
@@ -116,8 +119,8 @@ void uniform_wind::run(mesh& domain)
         double W= face->get_module_data<lwinddata>(ID).W;
 
         W = std::max(W,0.1);
-        (*face)["U_R"_s]= W;
-        (*face)["vw_dir"_s]= corrected_theta * 180.0 / M_PI;
+        face->get(h_U_R)= W;
+        face->get(h_vw_dir)= corrected_theta * 180.0 / M_PI;
 
         Vector_2 v_corr = math::gis::bearing_to_cartesian(corrected_theta * 180.0 / M_PI);
         Vector_3 v3(-v_corr.x(), -v_corr.y(), 0); //negate as direction it's blowing instead of where it is from!!
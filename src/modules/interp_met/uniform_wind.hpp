@@ -68,5 +68,8 @@ public:
         double corrected_theta;
         double W;
     };
+
+    // variable handles, resolved in init
+    var_handle h_U_R, h_vw_dir;
 };
 
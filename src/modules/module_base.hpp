@@ -24,6 +24,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <map>
 #include <boost/shared_ptr.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
@@ -193,7 +195,7 @@ public:
     module_base(std::string name = "",
 		parallel type = parallel::data,
 		config_file input_cfg = pt::basic_ptree<std::string,std::string>())
-      :    ID(name), cfg(input_cfg), IDnum(0),_parallel_type(type)
+      :    ID(name), cfg(input_cfg), IDnum(0),_parallel_type(type), _barrier(false)
     {
         _provides = boost::make_shared<std::vector<variable_info>>();
         _provides_parameters = boost::make_shared<std::vector<std::string>>();
@@ -269,6 +271,14 @@ public:
         return _parallel_type;
     }
 
+    /**
+     * True if this module must run with no other module running concurrently. See barrier()
+     */
+    bool is_barrier()
+    {
+        return _barrier;
+    }
+
     /**
     * List of the variables that this module provides.
     */
@@ -363,6 +373,16 @@ public:
      */
     boost::shared_ptr<std::vector<variable_info>> depends() { return _depends; }
 
+    /**
+     * Declares that this module changes state shared by the whole mesh while it runs, e.g., moves vertices and updates
+     * the face geometry, or exchanges ghost halos. It is then always run in a stage by itself, so no other module runs
+     * concurrently with it when concurrent_modules is enabled. Must be used in the ctor.
+     */
+    void barrier()
+    {
+        _barrier = true;
+    }
+
     /**
     * Modules we conflict with and absolutely cannot run alongside. Use sparingly.
     */
@@ -374,11 +394,29 @@ public:
         _conflicts->push_back(variable);
     }
 
+    /**
+    * As conflicts(module), with the reason and how to avoid it reported in the error
+    */
+    void conflicts(const std::string& module, const std::string& reason)
+    {
+        conflicts(module);
+        _conflict_reasons[module] = reason;
+    }
+
     boost::shared_ptr<std::vector<std::string> > conflicts()
     {
         return _conflicts;
     }
 
+    /**
+    * Why we conflict with a module, empty if no reason was given
+    */
+    std::string conflict_reason(const std::string& module) const
+    {
+        auto itr = _conflict_reasons.find(module);
+        return itr == _conflict_reasons.end() ? "" : itr->second;
+    }
+
 
     /**
      * List of the optional depends variables from other modules that this module depends upon
@@ -449,6 +487,81 @@ public:
         return names;
     }
 
+    /**
+     * Resolve a variable to a handle for use with face->get(). Call once from init(mesh&) and store the result.
+     * Throws if the variable does not exist. With SAFE_CHECKS, also warns if the variable is not one that this module
+     * provides, depends on, or optionally depends on, as the dependency graph does not guarantee its ordering.
+     * This is the only validation done: access via the handle is unchecked.
+     * @param domain
+     * @param variable
+     * @return
+     */
+    var_handle handle(mesh& domain, const std::string& variable)
+    {
+#ifdef SAFE_CHECKS
+        auto declared = [&](const std::string& name)
+        {
+            for (auto& itr : *_provides)
+                if (itr.name == name) return true;
+            for (auto& itr : *_depends)
+                if (itr.name == name) return true;
+            return std::find(_optional->begin(), _optional->end(), name) != _optional->end();
+        };
+
+        if (!declared(variable))
+        {
+            SPDLOG_WARN("Module {} requested a handle to {} which it does not provide or depend upon", ID, variable);
+        }
+#endif
+        return domain->handle(variable);
+    }
+
+    /**
+     * Gathers fn(face) for every face into a contiguous array and writes it to the checkpoint in a single call.
+     * fn is evaluated in parallel so must be safe to call concurrently on different faces.
+     * The variable must already have been created with create_variable1D.
+     * @param domain
+     * @param chkpt
+     * @param var
+     * @param fn mesh_elem& -> double
+     */
+    template<typename Fn>
+    void put_checkpoint_var(mesh& domain, netcdf& chkpt, const std::string& var, Fn fn)
+    {
+        std::vector<double> values(domain->size_faces());
+
+#pragma omp parallel for
+        for (size_t i = 0; i < domain->size_faces(); i++)
+        {
+            auto face = domain->face(i);
+            values[i] = fn(face);
+        }
+
+        chkpt.put_var1D(var, values);
+    }
+
+    /**
+     * Reads a checkpoint variable for every face in a single call and hands each face its value via fn(face, value).
+     * fn is evaluated in parallel so must be safe to call concurrently on different faces.
+     * @param domain
+     * @param chkpt
+     * @param var
+     * @param fn (mesh_elem&, double)
+     */
+    template<typename Fn>
+    void get_checkpoint_var(mesh& domain, netcdf& chkpt, const std::string& var, Fn fn)
+    {
+        std::vector<double> values(domain->size_faces());
+        chkpt.get_var1D(var, values);
+
+#pragma omp parallel for
+        for (size_t i = 0; i < domain->size_faces(); i++)
+        {
+            auto face = domain->face(i);
+            fn(face, values[i]);
+        }
+    }
+
     /**
      * If you want to skip evaluating this current face, call this to set all provides outputs to nan
      * E.g., called if the is_water, is_glacier, etc is true
@@ -504,12 +617,14 @@ public:
 
 protected:
     parallel _parallel_type;
+    bool _barrier;
     boost::shared_ptr<std::vector<variable_info>> _provides;
     boost::shared_ptr<std::vector<std::string>> _provides_parameters;
     boost::shared_ptr<std::vector<variable_info>> _depends;
     boost::shared_ptr<std::vector<std::string>> _depends_from_met;
     boost::shared_ptr<std::vector<std::string>> _optional;
     boost::shared_ptr<std::vector<std::string>> _conflicts;
+    std::map<std::string, std::string> _conflict_reasons;
 
     // Currently not used to resolve dependencies
     // This is a list of variables that are stored as x,y,z vectors, such as wind velocities
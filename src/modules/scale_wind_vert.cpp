@@ -31,7 +31,8 @@ scale_wind_vert::scale_wind_vert(config_file cfg)
 // do that in this ctor as global isn't defined yet and we don't
 
 {
-
+    // exchanges ghost halos in run()
+    barrier();
 
     depends("U_R");
 
@@ -79,6 +79,57 @@ snobal::snobal(config_file cfg)
 
 void snobal::init(mesh& domain)
 {
+    // resolve the variable handles once so run() does not need a hash lookup per access
+    h_swe = handle(domain, "swe");
+    h_R_n = handle(domain, "R_n");
+    h_H = handle(domain, "H");
+    h_E = handle(domain, "E");
+    h_G = handle(domain, "G");
+    h_M = handle(domain, "M");
+    h_dQ = handle(domain, "dQ");
+    h_cc = handle(domain, "cc");
+    h_T_s = handle(domain, "T_s");
+    h_T_s_0 = handle(domain, "T_s_0");
+    h_T_s_l = handle(domain, "T_s_l");
+    h_iswr_net = handle(domain, "iswr_net");
+    h_isothermal = handle(domain, "isothermal");
+    h_ilwr_out = handle(domain, "ilwr_out");
+    h_snowmelt_int = handle(domain, "snowmelt_int");
+    h_sum_melt = handle(domain, "sum_melt");
+    h_sum_snowpack_runoff = handle(domain, "sum_snowpack_runoff");
+    h_sum_snowpack_subl = handle(domain, "sum_snowpack_subl");
+    h_sum_snowpack_pcp = handle(domain, "sum_snowpack_pcp");
+    h_snowdepthavg = handle(domain, "snowdepthavg");
+    h_snow_albedo = handle(domain, "snow_albedo");
+    h_ilwr = handle(domain, "ilwr");
+    h_rh = handle(domain, "rh");
+    h_t = handle(domain, "t");
+    h_iswr = handle(domain, "iswr");
+    h_U_2m_above_srf = handle(domain, "U_2m_above_srf");
+    h_p = handle(domain, "p");
+    h_frac_precip_snow = handle(domain, "frac_precip_snow");
+    h_dead = handle(domain, "dead");
+    h_snowdepthavg_vert = handle(domain, "snowdepthavg_vert");
+    if(has_optional("ilwr_subcanopy"))
+        h_ilwr_subcanopy = handle(domain, "ilwr_subcanopy");
+    if(has_optional("rh_subcanopy"))
+        h_rh_subcanopy = handle(domain, "rh_subcanopy");
+    if(has_optional("ta_subcanopy"))
+        h_ta_subcanopy = handle(domain, "ta_subcanopy");
+    if(has_optional("iswr_subcanopy"))
+        h_iswr_subcanopy = handle(domain, "iswr_subcanopy");
+    if(has_optional("T_g"))
+        h_T_g = handle(domain, "T_g");
+    if(has_optional("p_subcanopy"))
+        h_p_subcanopy = handle(domain, "p_subcanopy");
+    if(has_optional("frac_precip_snow_subcanopy"))
+        h_frac_precip_snow_subcanopy = handle(domain, "frac_precip_snow_subcanopy");
+    if(has_optional("drift_mass"))
+        h_drift_mass = handle(domain, "drift_mass");
+    if(has_optional("delta_avalanche_snowdepth"))
+        h_delta_avalanche_snowdepth = handle(domain, "delta_avalanche_snowdepth");
+    if(has_optional("delta_avalanche_mass"))
+        h_delta_avalanche_mass = handle(domain, "delta_avalanche_mass");
 
     drift_density = cfg.get("drift_density",300.);
     const_T_g = cfg.get("const_T_g",-4.0);
@@ -212,27 +263,27 @@ void snobal::init(mesh& domain)
 
        if (face->has_initial_condition("swe") &&  !is_nan(face->get_initial_condition("swe")))
        {
-           (*face)["swe"_s]= sbal->m_s;
-           (*face)["R_n"_s]= sbal->R_n;
-           (*face)["H"_s]= sbal->H;
-           (*face)["E"_s]= sbal->L_v_E;
-           (*face)["G"_s]= sbal->G;
-           (*face)["M"_s]= sbal->M;
-           (*face)["dQ"_s]= sbal->delta_Q;
-           (*face)["cc"_s]= sbal->cc_s;
-           (*face)["T_s"_s]= sbal->T_s;
-           (*face)["T_s_0"_s]= sbal->T_s_0;
-           (*face)["T_s_l"_s]= sbal->T_s_l;
-           (*face)["iswr_net"_s]= sbal->S_n;
-           (*face)["isothermal"_s]= sbal->isothermal;
-           (*face)["ilwr_out"_s]= sbal->R_n - sbal->S_n - sbal->I_lw;
-           (*face)["snowmelt_int"_s]= 0;
-           (*face)["sum_melt"_s]= g.sum_melt;
-           (*face)["sum_snowpack_runoff"_s]= g.sum_runoff;
-           (*face)["sum_snowpack_subl"_s]= g.sum_subl;
-           (*face)["sum_snowpack_pcp"_s]= g.sum_pcp_sno;
-
-           (*face)["snowdepthavg"_s]= sbal->z_s;
+           face->get(h_swe)= sbal->m_s;
+           face->get(h_R_n)= sbal->R_n;
+           face->get(h_H)= sbal->H;
+           face->get(h_E)= sbal->L_v_E;
+           face->get(h_G)= sbal->G;
+           face->get(h_M)= sbal->M;
+           face->get(h_dQ)= sbal->delta_Q;
+           face->get(h_cc)= sbal->cc_s;
+           face->get(h_T_s)= sbal->T_s;
+           face->get(h_T_s_0)= sbal->T_s_0;
+           face->get(h_T_s_l)= sbal->T_s_l;
+           face->get(h_iswr_net)= sbal->S_n;
+           face->get(h_isothermal)= sbal->isothermal;
+           face->get(h_ilwr_out)= sbal->R_n - sbal->S_n - sbal->I_lw;
+           face->get(h_snowmelt_int)= 0;
+           face->get(h_sum_melt)= g.sum_melt;
+           face->get(h_sum_snowpack_runoff)= g.sum_runoff;
+           face->get(h_sum_snowpack_subl)= g.sum_subl;
+           face->get(h_sum_snowpack_pcp)= g.sum_pcp_sno;
+
+           face->get(h_snowdepthavg)= sbal->z_s;
        }
     }
 
@@ -269,50 +320,50 @@ void snobal::run(mesh_elem &face)
 
     sbal->P_a = mio::Atmosphere::stdAirPressure( face->get_z());
 
-    double albedo = (*face)["snow_albedo"_s];
+    double albedo = face->get(h_snow_albedo);
 
     // Optional inputs if there is a canopy or not
     double ilwr;
     if(has_optional("ilwr_subcanopy")) {
-        ilwr = (*face)["ilwr_subcanopy"_s];
+        ilwr = face->get(h_ilwr_subcanopy);
     } else {
-        ilwr = (*face)["ilwr"_s];
+        ilwr = face->get(h_ilwr);
     }
 
     // Optional inputs if there is a canopy or not
     double rh;
     if(has_optional("rh_subcanopy")) {
-        rh = (*face)["rh_subcanopy"_s];
+        rh = face->get(h_rh_subcanopy);
     } else {
-        rh = (*face)["rh"_s];
+        rh = face->get(h_rh);
     }
 
     // Optional inputs if there is a canopy or not
     double t;
     if(has_optional("ta_subcanopy")) {
-        t = (*face)["ta_subcanopy"_s];
+        t = face->get(h_ta_subcanopy);
     } else {
-        t = (*face)["t"_s];
+        t = face->get(h_t);
     }
 
     double ea = mio::Atmosphere::vaporSaturationPressure(t+273.15)  * rh/100.;
 
     // Optional inputs if there is a canopy or not
     if(has_optional("iswr_subcanopy")) {
-        sbal->input_rec2.S_n = (1.0-albedo) * (*face)["iswr_subcanopy"_s];
+        sbal->input_rec2.S_n = (1.0-albedo) * face->get(h_iswr_subcanopy);
     } else {
-        sbal->input_rec2.S_n = (1.0-albedo) * (*face)["iswr"_s];
+        sbal->input_rec2.S_n = (1.0-albedo) * face->get(h_iswr);
     }
     sbal->input_rec2.I_lw = ilwr;
     sbal->input_rec2.T_a = t+FREEZE;
     sbal->input_rec2.e_a = ea;
 
     // Optional inputs if there is a canopy or not
-    sbal->input_rec2.u = (*face)["U_2m_above_srf"_s];
+    sbal->input_rec2.u = face->get(h_U_2m_above_srf);
     sbal->input_rec2.u = std::max(sbal->input_rec2.u,1.0);
 
     if(has_optional("T_g"))
-        sbal->input_rec2.T_g = (*face)["T_g"_s] + 273.15;
+        sbal->input_rec2.T_g = face->get(h_T_g) + 273.15;
     else
         sbal->input_rec2.T_g = const_T_g+FREEZE;
 
@@ -333,9 +384,9 @@ void snobal::run(mesh_elem &face)
     // Optional inputs if there is a canopy or not
     double p;
     if(has_optional("p_subcanopy")) {
-        p = (*face)["p_subcanopy"_s];
+        p = face->get(h_p_subcanopy);
     } else {
-        p = (*face)["p"_s];
+        p = face->get(h_p);
     }
 
     if(p >= 0.00025) //0.25mm swe
@@ -345,9 +396,9 @@ void snobal::run(mesh_elem &face)
 
         // Optional inputs if there is a canopy or not
         if(has_optional("frac_precip_snow_subcanopy")) {
-            sbal->percent_snow = (*face)["frac_precip_snow_subcanopy"_s];
+            sbal->percent_snow = face->get(h_frac_precip_snow_subcanopy);
         } else {
-            sbal->percent_snow = (*face)["frac_precip_snow"_s];
+            sbal->percent_snow = face->get(h_frac_precip_snow);
         }
         sbal->rho_snow = 100.; //http://ccc.atmos.colostate.edu/pdfs/SnowDensity_BAMS.pdf
         sbal->T_pp = t+FREEZE; // The comments are wrong this is definietly not in C and is K
@@ -363,7 +414,7 @@ void snobal::run(mesh_elem &face)
     if(has_optional("drift_mass"))
     {
 
-        double mass = (*face)["drift_mass"_s];
+        double mass = face->get(h_drift_mass);
         mass = is_nan(mass) ? 0 : mass;
 
         double transport_density;
@@ -389,10 +440,10 @@ void snobal::run(mesh_elem &face)
     // If snow avalanche variables are available
     bool snow_slide = false;
     if(has_optional("delta_avalanche_snowdepth")) {
-        g.delta_avalanche_snowdepth = (*face)["delta_avalanche_snowdepth"_s];
+        g.delta_avalanche_snowdepth = face->get(h_delta_avalanche_snowdepth);
     }
     if(has_optional("delta_avalanche_mass")) {
-        g.delta_avalanche_swe = (*face)["delta_avalanche_mass"_s];
+        g.delta_avalanche_swe = face->get(h_delta_avalanche_mass);
         snow_slide = true;
     }
 
@@ -463,33 +514,33 @@ void snobal::run(mesh_elem &face)
 
     double sd_ver = sbal->z_s/std::max(0.001,cos(face->slope()));
 
-    (*face)["dead"_s]=g.dead;
-
-    (*face)["swe"_s]=sbal->m_s;
-
-    (*face)["R_n"_s]=sbal->R_n;
-    (*face)["H"_s]=sbal->H;
-    (*face)["E"_s]=sbal->L_v_E;
-    (*face)["G"_s]=sbal->G;
-    (*face)["M"_s]=sbal->M;
-    (*face)["dQ"_s]=sbal->delta_Q;
-    (*face)["cc"_s]=sbal->cc_s;
-    (*face)["T_s"_s]=sbal->T_s;
-    (*face)["T_s_0"_s]=sbal->T_s_0;
-    (*face)["T_s_l"_s]=sbal->T_s_l;
-    (*face)["iswr_net"_s]=sbal->S_n;
-    (*face)["isothermal"_s]=sbal->isothermal;
-    (*face)["ilwr_out"_s]= sbal->R_n - sbal->S_n - sbal->I_lw;
-    (*face)["snowmelt_int"_s]=sbal->ro_predict;
+    face->get(h_dead)=g.dead;
+
+    face->get(h_swe)=sbal->m_s;
+
+    face->get(h_R_n)=sbal->R_n;
+    face->get(h_H)=sbal->H;
+    face->get(h_E)=sbal->L_v_E;
+    face->get(h_G)=sbal->G;
+    face->get(h_M)=sbal->M;
+    face->get(h_dQ)=sbal->delta_Q;
+    face->get(h_cc)=sbal->cc_s;
+    face->get(h_T_s)=sbal->T_s;
+    face->get(h_T_s_0)=sbal->T_s_0;
+    face->get(h_T_s_l)=sbal->T_s_l;
+    face->get(h_iswr_net)=sbal->S_n;
+    face->get(h_isothermal)=sbal->isothermal;
+    face->get(h_ilwr_out)= sbal->R_n - sbal->S_n - sbal->I_lw;
+    face->get(h_snowmelt_int)=sbal->ro_predict;
 
 //    (*face)["snowmelt_int"_s]=swe_diff;
-    (*face)["sum_melt"_s]=g.sum_melt;
-    (*face)["sum_snowpack_runoff"_s]=g.sum_runoff;
-    (*face)["sum_snowpack_subl"_s]=g.sum_subl;
-    (*face)["sum_snowpack_pcp"_s]=g.sum_pcp_sno;
+    face->get(h_sum_melt)=g.sum_melt;
+    face->get(h_sum_snowpack_runoff)=g.sum_runoff;
+    face->get(h_sum_snowpack_subl)=g.sum_subl;
+    face->get(h_sum_snowpack_pcp)=g.sum_pcp_sno;
 
-    (*face)["snowdepthavg"_s]=sbal->z_s;
-    (*face)["snowdepthavg_vert"_s]=sd_ver;
+    face->get(h_snowdepthavg)=sbal->z_s;
+    face->get(h_snowdepthavg_vert)=sd_ver;
 
     sbal->input_rec1.S_n =sbal->input_rec2.S_n;
     sbal->input_rec1.I_lw =sbal->input_rec2.I_lw;
@@ -523,90 +574,97 @@ void snobal::checkpoint(mesh& domain,  netcdf& chkpt)
     chkpt.create_variable1D("snobal:ro_pred_sum",domain->size_faces());
     chkpt.create_variable1D("snobal:h2o_total",domain->size_faces());
 
-//netcdf puts are not threadsafe.
-    for (size_t i = 0; i < domain->size_faces(); i++)
+    // gather each field into one array and write it in a single call
+    auto put = [&](const std::string& var, auto fn)
     {
-        auto face = domain->face(i);
-        auto& g = face->get_module_data<snodata>(ID);
-        auto *sbal = &(g.data);
-
-        chkpt.put_var1D("snobal:m_s",i,sbal->m_s);
-        chkpt.put_var1D("snobal:rho",i,sbal->rho);
-        chkpt.put_var1D("snobal:T_s",i,sbal->T_s);
-        chkpt.put_var1D("snobal:T_s_0",i,sbal->T_s_0);
-        chkpt.put_var1D("snobal:T_s_l",i,sbal->T_s_l);
-        chkpt.put_var1D("snobal:z_s",i, sbal->z_s);
-        chkpt.put_var1D("snobal:h2o_sat",i,sbal->h2o_sat);
-        chkpt.put_var1D("snobal:max_h2o_vol",i,sbal->max_h2o_vol);
-
-        chkpt.put_var1D("snobal:sum_runoff",i,g.sum_runoff);
-        chkpt.put_var1D("snobal:sum_melt",i,g.sum_melt);
-        chkpt.put_var1D("snobal:sum_subl",i,g.sum_subl);
-        chkpt.put_var1D("snobal:sum_pcp_sno",i,g.sum_pcp_sno);
-        chkpt.put_var1D("snobal:E_s_sum",i,sbal->E_s_sum);
-        chkpt.put_var1D("snobal:melt_sum",i,sbal->melt_sum);
-        chkpt.put_var1D("snobal:ro_pred_sum",i,sbal->ro_pred_sum);
-        chkpt.put_var1D("snobal:h2o_total",i,sbal->h2o_total);
-    }
+        put_checkpoint_var(domain, chkpt, "snobal:" + var,
+                           [&](mesh_elem& face) -> double { return fn(face->get_module_data<snodata>(ID)); });
+    };
+
+    put("m_s", [](snodata& g) { return g.data.m_s; });
+    put("rho", [](snodata& g) { return g.data.rho; });
+    put("T_s", [](snodata& g) { return g.data.T_s; });
+    put("T_s_0", [](snodata& g) { return g.data.T_s_0; });
+    put("T_s_l", [](snodata& g) { return g.data.T_s_l; });
+    put("z_s", [](snodata& g) { return g.data.z_s; });
+    put("h2o_sat", [](snodata& g) { return g.data.h2o_sat; });
+    put("max_h2o_vol", [](snodata& g) { return g.data.max_h2o_vol; });
+
+    put("sum_runoff", [](snodata& g) { return g.sum_runoff; });
+    put("sum_melt", [](snodata& g) { return g.sum_melt; });
+    put("sum_subl", [](snodata& g) { return g.sum_subl; });
+    put("sum_pcp_sno", [](snodata& g) { return g.sum_pcp_sno; });
+    put("E_s_sum", [](snodata& g) { return g.data.E_s_sum; });
+    put("melt_sum", [](snodata& g) { return g.data.melt_sum; });
+    put("ro_pred_sum", [](snodata& g) { return g.data.ro_pred_sum; });
+    put("h2o_total", [](snodata& g) { return g.data.h2o_total; });
 
 }
 
 void snobal::load_checkpoint(mesh& domain, netcdf& chkpt)
 {
+    // one read per field
+    auto get = [&](const std::string& var, auto fn)
+    {
+        get_checkpoint_var(domain, chkpt, "snobal:" + var,
+                           [&](mesh_elem& face, double value) { fn(face->get_module_data<snodata>(ID), value); });
+    };
+
+    get("m_s", [](snodata& g, double v) { g.data.m_s = v; });
+    get("rho", [](snodata& g, double v) { g.data.rho = v; });
+    get("T_s", [](snodata& g, double v) { g.data.T_s = v; });
+    get("T_s_0", [](snodata& g, double v) { g.data.T_s_0 = v; });
+    get("T_s_l", [](snodata& g, double v) { g.data.T_s_l = v; });
+    get("z_s", [](snodata& g, double v) { g.data.z_s = v; });
+    get("h2o_sat", [](snodata& g, double v) { g.data.h2o_sat = v; });
+    get("max_h2o_vol", [](snodata& g, double v) { g.data.max_h2o_vol = v; });
+
+    get("sum_runoff", [](snodata& g, double v) { g.sum_runoff = v; });
+    get("sum_melt", [](snodata& g, double v) { g.sum_melt = v; });
+    get("sum_subl", [](snodata& g, double v) { g.sum_subl = v; });
+    get("sum_pcp_sno", [](snodata& g, double v) { g.sum_pcp_sno = v; });
+    get("E_s_sum", [](snodata& g, double v) { g.data.E_s_sum = v; });
+    get("melt_sum", [](snodata& g, double v) { g.data.melt_sum = v; });
+    get("ro_pred_sum", [](snodata& g, double v) { g.data.ro_pred_sum = v; });
+    get("h2o_total", [](snodata& g, double v) { g.data.h2o_total = v; });
+
+#pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
         auto face = domain->face(i);
         auto& g = face->get_module_data<snodata>(ID);
         auto *sbal = &(g.data);
 
-        sbal->m_s = chkpt.get_var1D("snobal:m_s",i);
-        sbal->rho = chkpt.get_var1D("snobal:rho",i);
-        sbal->T_s = chkpt.get_var1D("snobal:T_s",i);
-        sbal->T_s_0 = chkpt.get_var1D("snobal:T_s_0",i);
-        sbal->T_s_l = chkpt.get_var1D("snobal:T_s_l",i);
-        sbal->z_s =  chkpt.get_var1D("snobal:z_s",i);
-        sbal->h2o_sat =  chkpt.get_var1D("snobal:h2o_sat",i);
-        sbal->max_h2o_vol = chkpt.get_var1D("snobal:max_h2o_vol",i);
-
-        g.sum_runoff = chkpt.get_var1D("snobal:sum_runoff",i);
-        g.sum_melt = chkpt.get_var1D("snobal:sum_melt",i);
-        g.sum_subl = chkpt.get_var1D("snobal:sum_subl",i);
-        g.sum_pcp_sno = chkpt.get_var1D("snobal:sum_pcp_sno",i);
-        sbal->E_s_sum = chkpt.get_var1D("snobal:E_s_sum",i);
-        sbal->melt_sum = chkpt.get_var1D("snobal:melt_sum",i);
-        sbal->ro_pred_sum = chkpt.get_var1D("snobal:ro_pred_sum",i);
-        sbal->h2o_total = chkpt.get_var1D("snobal:h2o_total",i);
-
         sbal->init_snow();
 
-        (*face)["dead"_s]=g.dead;
+        face->get(h_dead)=g.dead;
 
-        (*face)["swe"_s]=sbal->m_s;
+        face->get(h_swe)=sbal->m_s;
 
-        (*face)["R_n"_s]=sbal->R_n;
-        (*face)["H"_s]=sbal->H;
-        (*face)["E"_s]=sbal->L_v_E;
-        (*face)["G"_s]=sbal->G;
-        (*face)["M"_s]=sbal->M;
-        (*face)["dQ"_s]=sbal->delta_Q;
-        (*face)["cc"_s]=sbal->cc_s;
-        (*face)["T_s"_s]=sbal->T_s;
-        (*face)["T_s_0"_s]=sbal->T_s_0;
-        (*face)["T_s_l"_s]=sbal->T_s_l;
-        (*face)["iswr_net"_s]=sbal->S_n;
-        (*face)["isothermal"_s]=sbal->isothermal;
-        (*face)["ilwr_out"_s]= sbal->R_n - sbal->S_n - sbal->I_lw;
-        (*face)["snowmelt_int"_s]=sbal->ro_predict;
+        face->get(h_R_n)=sbal->R_n;
+        face->get(h_H)=sbal->H;
+        face->get(h_E)=sbal->L_v_E;
+        face->get(h_G)=sbal->G;
+        face->get(h_M)=sbal->M;
+        face->get(h_dQ)=sbal->delta_Q;
+        face->get(h_cc)=sbal->cc_s;
+        face->get(h_T_s)=sbal->T_s;
+        face->get(h_T_s_0)=sbal->T_s_0;
+        face->get(h_T_s_l)=sbal->T_s_l;
+        face->get(h_iswr_net)=sbal->S_n;
+        face->get(h_isothermal)=sbal->isothermal;
+        face->get(h_ilwr_out)= sbal->R_n - sbal->S_n - sbal->I_lw;
+        face->get(h_snowmelt_int)=sbal->ro_predict;
 
-        (*face)["sum_melt"_s]=g.sum_melt;
-        (*face)["sum_snowpack_runoff"_s]=g.sum_runoff;
-        (*face)["sum_snowpack_subl"_s]=g.sum_subl;
-        (*face)["sum_snowpack_pcp"_s]=g.sum_pcp_sno;
+        face->get(h_sum_melt)=g.sum_melt;
+        face->get(h_sum_snowpack_runoff)=g.sum_runoff;
+        face->get(h_sum_snowpack_subl)=g.sum_subl;
+        face->get(h_sum_snowpack_pcp)=g.sum_pcp_sno;
 
-        (*face)["snowdepthavg"_s]=sbal->z_s;
+        face->get(h_snowdepthavg)=sbal->z_s;
 
         double sd_ver = sbal->z_s/std::max(0.001,cos(face->slope()));
-        (*face)["snowdepthavg_vert"_s]=sd_ver;
+        face->get(h_snowdepthavg_vert)=sd_ver;
 
     }
 }
@@ -209,4 +209,12 @@ public:
     void checkpoint(mesh& domain, netcdf& chkpt);
     void load_checkpoint(mesh& domain, netcdf& chkpt);
 
+    // variable handles, resolved in init
+    var_handle h_swe, h_R_n, h_H, h_E, h_G, h_M,
+               h_dQ, h_cc, h_T_s, h_T_s_0, h_T_s_l, h_iswr_net,
+               h_isothermal, h_ilwr_out, h_snowmelt_int, h_sum_melt, h_sum_snowpack_runoff, h_sum_snowpack_subl,
+               h_sum_snowpack_pcp, h_snowdepthavg, h_snow_albedo, h_ilwr_subcanopy, h_ilwr, h_rh_subcanopy,
+               h_rh, h_ta_subcanopy, h_t, h_iswr_subcanopy, h_iswr, h_U_2m_above_srf,
+               h_T_g, h_p_subcanopy, h_p, h_frac_precip_snow_subcanopy, h_frac_precip_snow, h_drift_mass,
+               h_delta_avalanche_snowdepth, h_delta_avalanche_mass, h_dead, h_snowdepthavg_vert;
 };
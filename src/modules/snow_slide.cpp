@@ -27,6 +27,9 @@ REGISTER_MODULE_CPP(snow_slide);
 snow_slide::snow_slide(config_file cfg)
         : module_base("snow_slide", parallel::domain, cfg)
 {
+    // exchanges ghost halos in run()
+    barrier();
+
     depends("snowdepthavg",SpatialType::neighbor);
     depends("swe",SpatialType::neighbor);
 
@@ -65,30 +68,28 @@ void snow_slide::checkpoint(mesh& domain,  netcdf& chkpt)
     chkpt.create_variable1D("snow_slide:delta_avalanche_snowdepth_sum", domain->size_faces());
     chkpt.create_variable1D("snow_slide:delta_avalanche_mass_sum", domain->size_faces());
 
-    for (size_t i = 0; i < domain->size_faces(); i++)
-    {
-        auto face = domain->face(i);
-        chkpt.put_var1D("snow_slide:delta_avalanche_snowdepth",i,face->get_module_data<data>(ID).delta_avalanche_snowdepth);
-        chkpt.put_var1D("snow_slide:delta_avalanche_mass",i,face->get_module_data<data>(ID).delta_avalanche_mass);
-
-        chkpt.put_var1D("snow_slide:delta_avalanche_snowdepth_sum",i,  (*face)["delta_avalanche_snowdepth_sum"_s]);
-        chkpt.put_var1D("snow_slide:delta_avalanche_mass_sum",i, (*face)["delta_avalanche_mass_sum"_s]);
+    put_checkpoint_var(domain, chkpt, "snow_slide:delta_avalanche_snowdepth",
+                       [&](mesh_elem& face) { return face->get_module_data<data>(ID).delta_avalanche_snowdepth; });
+    put_checkpoint_var(domain, chkpt, "snow_slide:delta_avalanche_mass",
+                       [&](mesh_elem& face) { return face->get_module_data<data>(ID).delta_avalanche_mass; });
 
-    }
+    put_checkpoint_var(domain, chkpt, "snow_slide:delta_avalanche_snowdepth_sum",
+                       [&](mesh_elem& face) { return (*face)["delta_avalanche_snowdepth_sum"_s]; });
+    put_checkpoint_var(domain, chkpt, "snow_slide:delta_avalanche_mass_sum",
+                       [&](mesh_elem& face) { return (*face)["delta_avalanche_mass_sum"_s]; });
 }
 
 void snow_slide::load_checkpoint(mesh& domain,  netcdf& chkpt)
 {
-    for (size_t i = 0; i < domain->size_faces(); i++)
-    {
-        auto face = domain->face(i);
-        face->get_module_data<data>(ID).delta_avalanche_snowdepth = chkpt.get_var1D("snow_slide:delta_avalanche_snowdepth",i);
-        face->get_module_data<data>(ID).delta_avalanche_mass = chkpt.get_var1D("snow_slide:delta_avalanche_mass",i);
-
-        (*face)["delta_avalanche_snowdepth_sum"_s] = chkpt.get_var1D("snow_slide:delta_avalanche_snowdepth_sum",i);
-        (*face)["delta_avalanche_mass_sum"_s] = chkpt.get_var1D("snow_slide:delta_avalanche_mass_sum",i);
-
-    }
+    get_checkpoint_var(domain, chkpt, "snow_slide:delta_avalanche_snowdepth",
+                       [&](mesh_elem& face, double value) { face->get_module_data<data>(ID).delta_avalanche_snowdepth = value; });
+    get_checkpoint_var(domain, chkpt, "snow_slide:delta_avalanche_mass",
+                       [&](mesh_elem& face, double value) { face->get_module_data<data>(ID).delta_avalanche_mass = value; });
+
+    get_checkpoint_var(domain, chkpt, "snow_slide:delta_avalanche_snowdepth_sum",
+                       [&](mesh_elem& face, double value) { (*face)["delta_avalanche_snowdepth_sum"_s] = value; });
+    get_checkpoint_var(domain, chkpt, "snow_slide:delta_avalanche_mass_sum",
+                       [&](mesh_elem& face, double value) { (*face)["delta_avalanche_mass_sum"_s] = value; });
 }
 
 void snow_slide::run(mesh& domain)
@@ -170,8 +171,8 @@ void snow_slide::run(mesh& domain)
         }
 
 #ifdef USE_MPI
-        // update everyone's ghosts with our values
-        domain->ghost_neighbors_communicate_variable("ghost_ss_snowdepthavg_vert_copy"_s);
+        // update everyone's ghosts with our values. The sort only needs local values, so do it while this is in flight
+        domain->begin_exchange({"ghost_ss_snowdepthavg_vert_copy"_s});
 #endif
 
         // Sort faces by elevation + snowdepth
@@ -179,6 +180,10 @@ void snow_slide::run(mesh& domain)
                            [](const std::pair<double, mesh_elem>& a, const std::pair<double, mesh_elem>& b)
                            { return b.first < a.first; });
 
+#ifdef USE_MPI
+        domain->end_exchange();
+#endif
+
         // Loop through each face, from highest to lowest triangle surface
         for (size_t i = 0; i < sorted_z.size(); i++)
         {
@@ -332,10 +337,10 @@ void snow_slide::run(mesh& domain)
 #ifdef USE_MPI
         // At this point we've set values on the our ghost faces. These correspond with actual faces on other ranks
         // So we need to send these data back
-        domain->ghost_to_neighbors_communicate_variable("ghost_ss_snowdepthavg_to_xfer"_s);
-        domain->ghost_to_neighbors_communicate_variable("ghost_ss_swe_to_xfer"_s);
-        domain->ghost_to_neighbors_communicate_variable("ghost_ss_delta_avalanche_snowdepth"_s);
-        domain->ghost_to_neighbors_communicate_variable("ghost_ss_delta_avalanche_swe"_s);
+        domain->ghost_to_neighbors_communicate_variables({"ghost_ss_snowdepthavg_to_xfer"_s,
+                                                          "ghost_ss_swe_to_xfer"_s,
+                                                          "ghost_ss_delta_avalanche_snowdepth"_s,
+                                                          "ghost_ss_delta_avalanche_swe"_s});
 #endif
 
 
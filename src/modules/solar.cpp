@@ -36,22 +36,8 @@ solar::~solar()
 {
 
 }
-void solar::run(mesh_elem &face)
+solar::ephemeris solar::compute_ephemeris()
 {
-    double Lon = 0;
-    double Lat = 0;
-    if(global_param->is_geographic())
-    {
-        Lon = face->center().x();
-        Lat = face->center().y();
-    }
-    else{
-        auto& data = face->get_module_data<solar::data>(ID);
-        Lon = data.lng;
-        Lat = data.lat;
-    }
-
-
     //Following the RA DEC to Az Alt conversion sequence explained here:
     //http://www.stargazing.net/kepler/altaz.html
 
@@ -64,7 +50,6 @@ void solar::run(mesh_elem &face)
     double hour = tm.tm_hour; // 0 = midnight, ok
     double min = tm.tm_min; // 0, ok
     double sec = tm.tm_sec; // [0,60] in c++11, ok http://en.cppreference.com/w/cpp/chrono/c/tm
-    double Alt = face->center().z();//0.; //TODO: fix this?
 
     if (month <= 2.0)
     {
@@ -78,9 +63,8 @@ void solar::run(mesh_elem &face)
 
     double d = jd-2451543.5;
     // Keplerian Elements for the Sun (geocentric)
-    double w = 282.9404+4.70935*pow(10,-5)*d; //    (longitude of perihelion degrees)
-    double a = 1.000000;          //    (mean distance, a.u.)
-    double e = 0.016709- 1.151*pow(10.,-9.)*d;  //    (eccentricity)
+    double w = 282.9404+4.70935e-5*d; //    (longitude of perihelion degrees)
+    double e = 0.016709- 1.151e-9*d;  //    (eccentricity)
     double M = fmod(356.0470+0.9856002585*d,360.0); //  (mean anomaly degrees)
     double L = w + M;                     //(Sun's mean longitude degrees)
     double oblecl = 23.4393-3.563e-7*d;  //(Sun's obliquity of the ecliptic)
@@ -97,7 +81,6 @@ void solar::run(mesh_elem &face)
     double r = sqrt(x*x + y*y);
     double v = atan2(y,x)*(180./M_PI);
 
-
     //find the longitude of the sun
     double lon = v + w;
 
@@ -111,37 +94,83 @@ void solar::run(mesh_elem &face)
     double yequat = yeclip*cos(oblecl*(M_PI/180.))+zeclip*sin(oblecl*(M_PI/180.));
     double zequat = yeclip*sin(23.4406*(M_PI/180.))+zeclip*cos(oblecl*(M_PI/180.));
 
-    //convert equatorial rectangular coordinates to RA and Decl:
-    r = sqrt(xequat*xequat + yequat*yequat + zequat*zequat)-(Alt/149598000.0); //roll up the altitude correction
-    double RA = atan2(yequat,xequat)*(180./M_PI);
-    double delta = asin(zequat/r)*(180./M_PI);
+    ephemeris eph;
+    eph.r = sqrt(xequat*xequat + yequat*yequat + zequat*zequat);
+    eph.zequat = zequat;
 
-    //Find the J2000 value
-    double J2000 = jd - 2451545.0;
+    double RA = atan2(yequat,xequat)*(180./M_PI);
 
     double UTH = hour+min/60.0+sec/3600.0;   //Calculate local siderial time
     double GMST0=fmod(L+180.,360.)/15.;
-    double SIDTIME = GMST0 + UTH + Lon/15.;
 
-    //Replace RA with hour angle HA
-    double HA = (SIDTIME*15. - RA);
+    //hour angle, HA = siderial time - RA. The observer's longitude is added per face
+    eph.ha = (GMST0 + UTH)*15. - RA;
+
+    return eph;
+}
+
+void solar::position(const ephemeris& eph, double lng, double sin_lat, double cos_lat, double alt, double& az, double& el)
+{
+    //convert equatorial rectangular coordinates to Decl, rolling up the altitude correction
+    double r = eph.r - (alt/149598000.0);
+    double sin_delta = eph.zequat / r;
+    double cos_delta = sqrt(1. - sin_delta*sin_delta); // declination is in [-90, 90] so cos is >= 0
+
+    double HA = (eph.ha + lng)*(M_PI/180.);
 
     //convert to rectangular coordinate system
-    x = cos(HA*(M_PI/180.))*cos(delta*(M_PI/180.));
-    y = sin(HA*(M_PI/180.))*cos(delta*(M_PI/180.));
-    double z = sin(delta*(M_PI/180.));
+    double x = cos(HA)*cos_delta;
+    double y = sin(HA)*cos_delta;
+    double z = sin_delta;
 
-    //rotate this along an axis going east-west.
-    double xhor = x*cos((90.-Lat)*(M_PI/180.))-z*sin((90.-Lat)*(M_PI/180.));
+    //rotate this along an axis going east-west, by the colatitude (90 - lat)
+    double xhor = x*sin_lat - z*cos_lat;
     double yhor = y;
-    double zhor = x*sin((90.-Lat)*(M_PI/180.))+z*cos((90.-Lat)*(M_PI/180.));
+    double zhor = x*cos_lat + z*sin_lat;
 
     //Find the h and AZ
-    double Az = atan2(yhor,xhor)*(180./M_PI) + 180.;
-    double El = asin(zhor)*(180./M_PI);
+    az = atan2(yhor,xhor)*(180./M_PI) + 180.;
+    el = asin(zhor)*(180./M_PI);
+}
 
-    (*face)["solar_az"_s]=Az;
-    (*face)["solar_el"_s]=El;
+void solar::run(mesh& domain)
+{
+    auto eph = compute_ephemeris();
+
+    double* az = domain->face_variables().column_data(h_solar_az.column);
+    double* el = domain->face_variables().column_data(h_solar_el.column);
+
+    // local faces are the first size_faces() rows of the variable storage
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        position(eph, _lng[i], _sin_lat[i], _cos_lat[i], _alt[i], az[i], el[i]);
+    }
+}
+
+void solar::run(mesh_elem &face)
+{
+    double Lon = 0;
+    double Lat = 0;
+    if(global_param->is_geographic())
+    {
+        Lon = face->center().x();
+        Lat = face->center().y();
+    }
+    else{
+        auto& data = face->get_module_data<solar::data>(ID);
+        Lon = data.lng;
+        Lat = data.lat;
+    }
+
+    double Alt = face->center().z();//0.; //TODO: fix this?
+
+    double Az = 0;
+    double El = 0;
+    position(compute_ephemeris(), Lon, sin(Lat*(M_PI/180.)), cos(Lat*(M_PI/180.)), Alt, Az, El);
+
+    face->get(h_solar_az)=Az;
+    face->get(h_solar_el)=El;
 
 }
 void solar::init(mesh& domain)
@@ -152,9 +181,6 @@ void solar::init(mesh& domain)
     //max distance to search
     double max_distance = cfg.get("svf.max_distance",1000.0);
 
-    //size of the step to take
-    double size_of_step = max_distance / steps;
-
     //number of azimuthal sections
     int N = cfg.get("svf.nsectors", 12);
 
@@ -162,6 +188,19 @@ void solar::init(mesh& domain)
 
     bool svf_compute = cfg.get("svf.compute",true);
 
+    // horizon angle of each face in each of the N sectors
+    const azimuth_table* horizon = nullptr;
+    if (svf_compute)
+        horizon = &domain->horizon(N, steps, max_distance);
+
+    h_solar_az = handle(domain, "solar_az");
+    h_solar_el = handle(domain, "solar_el");
+
+    _lng.resize(domain->size_faces());
+    _sin_lat.resize(domain->size_faces());
+    _cos_lat.resize(domain->size_faces());
+    _alt.resize(domain->size_faces());
+
     #pragma omp parallel
     {
         OGRSpatialReference monUtm, monGeo;
@@ -186,11 +225,12 @@ void solar::init(mesh& domain)
 
             auto face = domain->face(i);
 
+            double x = face->center().x();
+            double y = face->center().y();
+
             // we are UTM and need to convert internally to lat long to calc the solar position
             if (!domain->is_geographic())
             {
-                double x = face->center().x();
-                double y = face->center().y();
 
                 // do the transform with the enforce x/y ordering
                 if(!coordTrans->Transform(1, &x, &y))
@@ -204,33 +244,23 @@ void solar::init(mesh& domain)
                 d.lng = x;
             }
 
+            // observer location for the domain parallel run
+            _lng[i] = x;
+            _sin_lat[i] = sin(y * M_PI / 180.);
+            _cos_lat[i] = cos(y * M_PI / 180.);
+            _alt[i] = face->center().z();
+
             double svf = 0.0;
 
             if (svf_compute)
             {
-                Point_3 me = face->center();
                 auto cosSlope = cos(face->slope());
                 auto sinSlope = sin(face->slope());
 
                 // for each search azimuthal sector
                 for (int k = 0; k < N; k++)
                 {
-                    double phi = 0.;
-                    // search along each azimuth in j step increments to find horizon angle
-                    for (int j = 1; j <= steps; ++j)
-                    {
-                        double distance = j * size_of_step;
-
-                        auto f =
-                            domain->find_closest_face(math::gis::point_from_bearing(me, k * azimuthal_width, distance));
-
-                        double z_diff = (f->center().z() - me.z());
-                        if (z_diff > 0)
-                        {
-                            double dist = math::gis::distance(f->center(), me);
-                            phi = std::max(atan(z_diff / dist), phi);
-                        }
-                    }
+                    double phi = (*horizon)(i, k);
 
                     auto cosPhi = cos(phi);
                     auto sinPhi = sin(phi);
@@ -252,6 +282,11 @@ void solar::init(mesh& domain)
         OGRCoordinateTransformation::DestroyCT(coordTrans);
     }
 
+    // The ephemeris is computed once per timestep and all the faces solved together. Point mode only runs a single
+    // face, so stay data parallel there
+    if(!global_param->is_point_mode())
+        _parallel_type = parallel::domain;
+
 
 
 }
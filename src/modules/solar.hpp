@@ -102,8 +102,38 @@ public:
         double lng;
     };
 
+    /// Position of the sun for the current timestep. This does not depend on the observer, so it is computed once
+    /// per timestep and shared by all the faces
+    struct ephemeris
+    {
+        double r;      // earth-sun distance, prior to the observer's altitude correction [au]
+        double zequat; // equatorial rectangular z coordinate of the sun [au]
+        double ha;     // hour angle of the sun at longitude 0 [degrees]
+    };
+
     solar(config_file cfg);
     ~solar();
     void run(mesh_elem &face);
+    void run(mesh& domain);
     void init(mesh& domain);
+
+    /// Computes the sun's ephemeris for the current model time
+    /// @return
+    ephemeris compute_ephemeris();
+
+    /// Solar position as seen by an observer
+    /// @param eph Ephemeris for the timestep
+    /// @param lng Observer longitude [degrees]
+    /// @param sin_lat sin of the observer latitude
+    /// @param cos_lat cos of the observer latitude
+    /// @param alt Observer altitude [m]
+    /// @param az Solar azimuth [degrees]
+    /// @param el Solar elevation [degrees]
+    static void position(const ephemeris& eph, double lng, double sin_lat, double cos_lat, double alt, double& az, double& el);
+
+  private:
+    // per local face observer location, in face(i) order, for the domain parallel run
+    std::vector<double> _lng, _sin_lat, _cos_lat, _alt;
+
+    var_handle h_solar_az, h_solar_el;
 };
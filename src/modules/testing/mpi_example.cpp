@@ -27,6 +27,9 @@ REGISTER_MODULE_CPP(mpi);
 mpi::mpi(config_file cfg)
         : module_base("mpi", parallel::domain, cfg)
 {
+    // exchanges ghost halos in run()
+    barrier();
+
     provides("mpi_rank");
     provides("mpi_ghost_test");
 }
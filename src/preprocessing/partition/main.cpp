@@ -782,15 +782,17 @@ class preprocessingTriangulation : public triangulation
                 SPDLOG_DEBUG("Writting partition.vtu");
                 // init the datastructs to hold information for outputting to VTU
                 std::set< std::string > vtu_outputs = { "owner", "is_ghost", "ghost_type", "global_id","local_id"};
+
+                _local_faces = _faces;
+                _face_variables.init(vtu_outputs, _faces.size());
 #pragma omp parallel for
                 for (size_t i = 0; i < _faces.size(); ++i)
                 {
                     auto f = _faces.at(i);
-                    f->init_time_series(vtu_outputs);
+                    f->attach_time_series(&_face_variables, i);
                     (*f)["owner"] = f->owner;
                 }
 
-                _local_faces = _faces;
                 write_vtu("partition.vtu",{"owner"});
             }
         }
@@ -0,0 +1,97 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "async_writer.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+TEST(AsyncWriter, SynchronousWhenDepthZero)
+{
+    async_writer writer;
+    int x = 0;
+    writer.submit([&] { x = 1; });
+    ASSERT_EQ(x, 1);
+}
+
+TEST(AsyncWriter, RunsInOrder)
+{
+    async_writer writer;
+    writer.set_depth(2);
+
+    std::vector<int> order;
+    for (int i = 0; i < 100; i++)
+        writer.submit([&order, i] { order.push_back(i); });
+
+    writer.flush();
+
+    ASSERT_EQ(order.size(), 100u);
+    for (int i = 0; i < 100; i++)
+        ASSERT_EQ(order[i], i);
+}
+
+TEST(AsyncWriter, BoundedQueue)
+{
+    async_writer writer;
+    writer.set_depth(2);
+
+    // queued + running jobs can never exceed depth + 1
+    std::atomic<int> outstanding{0};
+    std::atomic<int> max_outstanding{0};
+
+    for (int i = 0; i < 20; i++)
+    {
+        int n = ++outstanding;
+        max_outstanding = std::max(max_outstanding.load(), n);
+        writer.submit([&]
+                      {
+                          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                          --outstanding;
+                      });
+    }
+    writer.flush();
+
+    ASSERT_EQ(outstanding, 0);
+    ASSERT_LE(max_outstanding, 4);
+    ASSERT_GT(writer.stall_time(), 0);
+}
+
+TEST(AsyncWriter, RethrowsJobError)
+{
+    async_writer writer;
+    writer.set_depth(1);
+
+    writer.submit([] { throw std::runtime_error("write failed"); });
+    ASSERT_THROW(writer.flush(), std::runtime_error);
+
+    // usable after the error has been reported
+    int x = 0;
+    writer.submit([&] { x = 1; });
+    writer.flush();
+    ASSERT_EQ(x, 1);
+}
@@ -0,0 +1,131 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "columnstorage.hpp"
+#include "gtest/gtest.h"
+
+class ColumnStorageTest : public testing::Test
+{
+  protected:
+
+    virtual void SetUp()
+    {
+        logging::core::get()->set_logging_enabled(false);
+
+        // some test variables
+        variables.insert("t");
+        variables.insert("rh");
+        variables.insert("vw");
+        variables.insert("p");
+    }
+
+    std::set< std::string> variables;
+    size_t rows = 10;
+};
+
+//basic default init sanity checks
+TEST_F(ColumnStorageTest, DefaultInit)
+{
+    columnstorage<double> c;
+    ASSERT_EQ(c.size() , 0);
+    ASSERT_EQ(c.rows() , 0);
+    ASSERT_EQ(c.variables().size() , 0);
+    ASSERT_FALSE(c.has("t"));
+    ASSERT_FALSE(c.has("t"_s));
+}
+
+// check if the ctor correctly inits every row of every column
+TEST_F(ColumnStorageTest, ctorInit)
+{
+    columnstorage<double> c(variables, rows);
+
+    ASSERT_EQ(c.size() , 4);
+    ASSERT_EQ(c.rows() , rows);
+    ASSERT_EQ(c.variables().size() , 4);
+
+    for(size_t r = 0; r < rows; r++)
+    {
+        ASSERT_EQ(c.at(r, "t") , -9999);
+        ASSERT_EQ(c.at(r, "rh") , -9999);
+        ASSERT_EQ(c.at(r, "vw"_s) , -9999);
+        ASSERT_EQ(c.at(r, "p"_s) , -9999);
+    }
+}
+
+TEST_F(ColumnStorageTest, valueAccess)
+{
+    columnstorage<double> c(variables, rows);
+
+    for(size_t r = 0; r < rows; r++)
+    {
+        c.at(r, "t") = r;
+        c.at(r, "rh"_s) = 2.0 * r;
+    }
+
+    for(size_t r = 0; r < rows; r++)
+    {
+        ASSERT_EQ(c.at(r, "t"_s) , r);
+        ASSERT_EQ(c.at(r, "rh") , 2.0 * r);
+        ASSERT_EQ(c.at(r, "p") , -9999);
+    }
+}
+
+// columns are contiguous and the resolved column index agrees with the name lookup
+TEST_F(ColumnStorageTest, columnAccess)
+{
+    columnstorage<double> c(variables, rows);
+
+    size_t col = c.column("vw"_s);
+    ASSERT_EQ(col, c.column("vw"));
+
+    double* data = c.column_data(col);
+    for(size_t r = 0; r < rows; r++)
+    {
+        data[r] = r + 0.5;
+    }
+
+    for(size_t r = 0; r < rows; r++)
+    {
+        ASSERT_EQ(c(r, col) , r + 0.5);
+        ASSERT_EQ(c.at(r, "vw") , r + 0.5);
+    }
+}
+
+TEST_F(ColumnStorageTest, has)
+{
+    columnstorage<double> c(variables, rows);
+
+    ASSERT_TRUE(c.has("t"));
+    ASSERT_TRUE(c.has("rh"));
+    ASSERT_TRUE(c.has("vw"_s));
+    ASSERT_TRUE(c.has("p"_s));
+
+    ASSERT_FALSE(c.has("tttt"));
+    ASSERT_ANY_THROW(c.column("tttt"));
+}
+
+TEST_F(ColumnStorageTest, uninit)
+{
+    columnstorage<double> c;
+    ASSERT_ANY_THROW(c.at(0, "t") = 1);
+}
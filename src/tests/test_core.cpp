@@ -23,8 +23,11 @@
 
 
 #include "core.hpp"
+#include "deform_mesh.hpp"
+#include "fast_shadow.hpp"
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <stdlib.h>
 #include <string>
 #include <utility>
@@ -46,6 +49,29 @@ protected:
 
 //        ASSERT_NO_THROW(c0.init(argc,argv));
     }
+
+    // Stages the modules, given in build order, as core does with concurrent_modules. Returns the stage of each module
+    static std::vector<size_t> schedule(core& c, std::vector<module> modules, std::vector< std::set<size_t> > predecessors)
+    {
+        c._concurrent_modules = true;
+        c._modules.clear();
+        for (size_t i = 0; i < modules.size(); i++)
+        {
+            modules[i]->IDnum = i;
+            c._modules.push_back(std::make_pair(modules[i], i));
+        }
+        c._module_predecessors = predecessors;
+
+        c._schedule_modules();
+
+        std::vector<size_t> stage(modules.size());
+        for (size_t i = 0; i < c._chunked_modules.size(); i++)
+        {
+            for (auto& m : c._chunked_modules[i])
+                stage.at(m->IDnum) = c._chunk_stage.at(i);
+        }
+        return stage;
+    }
    // core c0;
 
 };
@@ -76,6 +102,59 @@ protected:
 //    ASSERT_ANY_THROW(c1.init(2,argv));
 //}
 
+// domain parallel module without dependencies that reads the face geometry
+class geometry_reader : public module_base
+{
+  public:
+    geometry_reader(std::string name) : module_base(name, parallel::domain, config_file()) {}
+
+    void run(mesh& domain)
+    {
+        double slope = 0;
+        for (size_t i = 0; i < domain->size_faces(); i++)
+            slope += domain->face(i)->slope();
+    }
+};
+
+TEST_F(CoreTest,BarrierModulesRunAlone)
+{
+    core c1;
+
+    auto deform = boost::make_shared<deform_mesh>(config_file());
+    auto r1 = boost::make_shared<geometry_reader>("r1");
+    auto r2 = boost::make_shared<geometry_reader>("r2");
+    auto r3 = boost::make_shared<geometry_reader>("r3");
+
+    // none of them have dependencies, so without the barrier they would all share stage 0
+    auto stage = schedule(c1, {r1, deform, r2, r3}, {{}, {}, {}, {}});
+
+    // deform_mesh moves the vertices and updates the geometry, so nothing else runs in its stage
+    ASSERT_LT(stage[0], stage[1]);
+    ASSERT_LT(stage[1], stage[2]);
+    ASSERT_EQ(stage[2], stage[3]); // independent readers are still concurrent
+    for (size_t i : {0, 2, 3})
+        ASSERT_NE(stage[i], stage[1]);
+
+    // also when it is first in the build order
+    stage = schedule(c1, {deform, r1, r2}, {{}, {}, {}});
+    ASSERT_LT(stage[0], stage[1]);
+    ASSERT_EQ(stage[1], stage[2]);
+}
+
+TEST_F(CoreTest,PrecomputedTablesConflictWithDeformMesh)
+{
+    // the horizon is only searched from the initial terrain, so it can't be used with a deforming mesh
+    fast_shadow precomputed(config_file{});
+    auto& c = *precomputed.conflicts();
+    ASSERT_NE(std::find(c.begin(), c.end(), "deform_mesh"), c.end());
+    ASSERT_FALSE(precomputed.conflict_reason("deform_mesh").empty());
+
+    config_file cfg;
+    cfg.put("azimuth_bins", 0);
+    fast_shadow searched(cfg);
+    ASSERT_TRUE(searched.conflicts()->empty());
+}
+
 TEST_F(CoreTest,ThrowsOnInvalidFile)
 {
 
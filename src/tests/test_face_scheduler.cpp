@@ -0,0 +1,81 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "face_scheduler.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cmath>
+
+TEST(FaceScheduler, VisitsEveryFaceOnce)
+{
+    size_t n = 5000;
+    face_scheduler scheduler;
+    scheduler.init(n);
+
+    std::vector< std::atomic<int> > hits(n);
+    for (auto& h : hits)
+        h = 0;
+
+    std::vector<double> out(n);
+
+    // faces at the start of the mesh are much more expensive so the blocks are re-partitioned between runs
+    for (int run = 0; run < 5; run++)
+    {
+        scheduler.run([&](size_t i)
+                      {
+                          hits[i]++;
+
+                          double x = 0;
+                          size_t work = i < n / 10 ? 5000 : 50;
+                          for (size_t k = 0; k < work; k++)
+                              x += std::sin(k * 1e-3 + i);
+                          out[i] = x;
+                      });
+
+        auto& blocks = scheduler.blocks();
+        ASSERT_EQ(blocks.front(), 0u);
+        ASSERT_EQ(blocks.back(), n);
+        for (size_t b = 1; b < blocks.size(); b++)
+            ASSERT_LT(blocks[b - 1], blocks[b]);
+
+        ASSERT_GE(scheduler.imbalance(), 0);
+    }
+
+    for (auto& h : hits)
+        ASSERT_EQ(h, 5);
+}
+
+TEST(FaceScheduler, MoreBlocksThanFaces)
+{
+    face_scheduler scheduler;
+    scheduler.init(3);
+
+    std::vector<int> hits(3, 0);
+    scheduler.run([&](size_t i) { hits[i]++; });
+
+    ASSERT_LE(scheduler.blocks().size() - 1, 3u);
+    for (auto h : hits)
+        ASSERT_EQ(h, 1);
+}
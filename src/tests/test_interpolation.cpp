@@ -106,6 +106,40 @@ TEST_F(InterpTest,spline_forcedsize)
 
 }
 
+TEST_F(InterpTest,spline_reuse)
+{
+    // one instance that keeps its decomposition between calls vs fresh instances
+    thin_plate_spline s;
+    std::vector<boost::tuple<double,double,double> > xy;
+
+    xy.push_back( boost::make_tuple(69.,76.,20.820));
+    xy.push_back( boost::make_tuple(59.,64.,10.910 ));
+    xy.push_back( boost::make_tuple(75.,52.,10.380 ));
+    xy.push_back( boost::make_tuple(86.,73.,14.600 ));
+    xy.push_back( boost::make_tuple(88.,53.,10.560 ));
+
+    auto query = boost::make_tuple(69.,67.,0.);
+
+    ASSERT_DOUBLE_EQ(s(xy,query), thin_plate_spline()(xy,query));
+
+    // new values at the same locations
+    for(auto& p : xy)
+        p.get<2>() += 1.5;
+    ASSERT_DOUBLE_EQ(s(xy,query), thin_plate_spline()(xy,query));
+
+    // a station dropping out changes the locations and needs a new decomposition
+    xy.pop_back();
+    ASSERT_DOUBLE_EQ(s(xy,query), thin_plate_spline()(xy,query));
+
+    // and a different query point
+    auto query2 = boost::make_tuple(70.,60.,0.);
+    ASSERT_DOUBLE_EQ(s(xy,query2), thin_plate_spline()(xy,query2));
+
+    // disabling reuse gives the same answer
+    thin_plate_spline no_reuse(4, {{"reuse_LU","false"}});
+    ASSERT_DOUBLE_EQ(s(xy,query2), no_reuse(xy,query2));
+}
+
 TEST_F(InterpTest,interpolation_class)
 {
     interpolation s(interp_alg::tpspline);
@@ -22,10 +22,12 @@
 //
 
 #include "metdata.hpp"
+#include "debias_lw.hpp"
 #include "gtest/gtest.h"
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <boost/make_shared.hpp>
 
 class MetdataTest : public testing::Test
 {
@@ -261,6 +263,62 @@ TEST_F(MetdataTest, ASCII_TestAccessData)
 
 }
 
+TEST_F(MetdataTest, ASCII_TestPackedFrames)
+{
+    metdata md(proj4str);
+
+    metdata::ascii_metdata station;
+    station.path = "test_met_data_longer1.txt";
+    station.latitude = 60.56726;
+    station.longitude = -135.184652;
+    station.elevation = 1559;
+    station.id = "station1";
+
+    metdata::ascii_metdata station2;
+    station2.path = "test_met_data_longer2.txt";
+    station2.latitude = 60.56726;
+    station2.longitude = -135.184652;
+    station2.elevation = 1559;
+    station2.id = "station2";
+
+    std::vector<metdata::ascii_metdata> s;
+    s.push_back(station);
+    s.push_back(station2);
+
+    ASSERT_NO_THROW(md.load_from_ascii(s, -8));
+
+    // the stations start an hour apart, so the packed frames must line up each file on the common start time
+    std::vector<timeseries> files(2);
+    files[0].open(station.path);
+    files[1].open(station2.path);
+
+    size_t n = 0;
+    while(md.next())
+    {
+        for(size_t i = 0; i < 2; i++)
+        {
+            auto row = files[i].find(md.current_time());
+            ASSERT_EQ(md.at(i)->get_posix(), md.current_time());
+
+            for(auto& v : files[i].list_variables())
+                ASSERT_DOUBLE_EQ((*md.at(i))[v], row->get(v));
+        }
+        n++;
+    }
+    ASSERT_EQ(n, md.n_timestep());
+
+    // a subset of the packed period reuses the frames, as the ascii timeseries have been freed
+    md.subset(boost::posix_time::from_iso_string("20101001T110000"), md.end_time());
+    ASSERT_TRUE(md.next());
+    ASSERT_DOUBLE_EQ(md.at(1)->operator[]("Qsi"_s), files[1].find(md.current_time())->get("Qsi"));
+    ASSERT_ANY_THROW(md.subset(md.start_time(), md.end_time() + md.dt()));
+
+    // the frames can't be rebuilt for fewer stations
+    std::unordered_set<std::string> remove = {"station1"};
+    md.prune_stations(remove);
+    ASSERT_ANY_THROW(md.next());
+}
+
 TEST_F(MetdataTest, ASCII_TestStartTimeStr)
 {
     metdata md(proj4str);
@@ -531,6 +589,40 @@ TEST_F(MetdataTest, NC_TestNext)
 }
 
 
+TEST_F(MetdataTest, NC_TestPrefetchFilters)
+{
+    config_file cfg;
+    cfg.put("variable", "t");
+    cfg.put("factor", 1.0);
+
+    std::map<std::string, boost::shared_ptr<filter_base> > filters;
+    filters["debias_lw"] = boost::make_shared<debias_lw>(cfg);
+    filters["debias_lw"]->init();
+
+    // filters run on the prefetch thread must give the same forcing as the synchronous reader
+    metdata prefetched(proj4str);
+    metdata sync(proj4str);
+    sync.set_prefetch_depth(0);
+
+    ASSERT_NO_THROW(prefetched.load_from_netcdf("GEM-CHM_2p5_snowcast_2018011506_2018011605.nc", nullptr, filters));
+    ASSERT_NO_THROW(sync.load_from_netcdf("GEM-CHM_2p5_snowcast_2018011506_2018011605.nc", nullptr, filters));
+
+    // the first call loads the first timestep
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_TRUE(prefetched.next());
+        ASSERT_TRUE(sync.next());
+    }
+
+    ASSERT_EQ(prefetched.current_time_str(), sync.current_time_str());
+    ASSERT_DOUBLE_EQ((*prefetched.at(0))["t"], -1.5229721069335938 + 1.0);
+
+    for (size_t i : {size_t(0), size_t(150 + 150 * 151)})
+    {
+        ASSERT_DOUBLE_EQ((*prefetched.at(i))["t"], (*sync.at(i))["t"]);
+    }
+}
+
 TEST_F(MetdataTest, NC_TestnTimeSteps)
 {
     metdata md(proj4str);
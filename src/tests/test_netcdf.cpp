@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <boost/filesystem.hpp>
 
 class NetCDFTest : public testing::Test
 {
@@ -117,4 +118,78 @@ TEST_F(NetCDFTest, access_time_offset)
     value = nc.get_var("t",time,150,150);
     ASSERT_DOUBLE_EQ(value, -11.3069305419921875);
 
-}
\ No newline at end of file
+}
+
+TEST(NetCDF1D, BulkPutGet)
+{
+    auto file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.nc")).string();
+
+    std::vector<double> values(1000);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = i * 0.5;
+
+    {
+        netcdf out;
+        out.create(file);
+        out.create_variable1D("a", values.size());
+        out.create_variable1D("b", values.size());
+        out.put_var1D("a", values);
+
+        // the per-index writes still work alongside the bulk ones
+        for (size_t i = 0; i < values.size(); i++)
+            out.put_var1D("b", i, -values[i]);
+    }
+
+    netcdf in;
+    in.open(file);
+
+    std::vector<double> a(values.size()), b(values.size());
+    in.get_var1D("a", a);
+    in.get_var1D("b", b);
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        ASSERT_DOUBLE_EQ(a[i], values[i]);
+        ASSERT_DOUBLE_EQ(b[i], -values[i]);
+        ASSERT_DOUBLE_EQ(in.get_var1D("a", i), values[i]);
+    }
+
+    ASSERT_ANY_THROW(in.get_var1D("not_a_variable", a));
+
+    boost::filesystem::remove(file);
+}
+
+TEST(NetCDF1D, SharedOffset)
+{
+    auto file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.nc")).string();
+
+    // this "rank" owns global ids [6, 10)
+    {
+        netcdf out;
+        out.create_shared(file, 10, 6);
+        out.create_variable1D("a", 4);
+
+        std::vector<double> values = {6, 7, 8, 9};
+        out.put_var1D("a", values);
+        out.close();
+    }
+
+    netcdf in;
+    in.open_shared(file);
+
+    // the whole dimension
+    std::vector<double> all(10);
+    in.get_var1D("a", all);
+    ASSERT_DOUBLE_EQ(all[6], 6);
+    ASSERT_DOUBLE_EQ(all[9], 9);
+
+    // read back with a different partitioning
+    std::vector<double> block(3);
+    in.set_offset1D(7);
+    in.get_var1D("a", block);
+    ASSERT_DOUBLE_EQ(block[0], 7);
+    ASSERT_DOUBLE_EQ(block[2], 9);
+    ASSERT_DOUBLE_EQ(in.get_var1D("a", 1), 8);
+
+    boost::filesystem::remove(file);
+}
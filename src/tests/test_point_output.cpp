@@ -0,0 +1,139 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "point_output.hpp"
+#include "gtest/gtest.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+using namespace boost::posix_time;
+
+class PointOutputTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        boost::filesystem::create_directories(dir);
+
+        points = {{"a", (dir / "a.txt").string(), -115.2, 50.9},
+                  {"b", (dir / "b.txt").string(), -115.3, 51.0}};
+    }
+
+    virtual void TearDown()
+    {
+        boost::filesystem::remove_all(dir);
+    }
+
+    std::vector<std::string> read_lines(const std::string& file)
+    {
+        std::ifstream in(file);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(in, line))
+            lines.push_back(line);
+        return lines;
+    }
+
+    boost::filesystem::path dir;
+    std::vector<point_output::point> points;
+    ptime t0 = ptime(boost::gregorian::date(2020, 1, 1));
+};
+
+TEST_F(PointOutputTest, CSVStreamsEveryFlushInterval)
+{
+    point_output out(point_output::format::csv, points, {"t", "swe"}, "", 2);
+
+    // header only until the first flush
+    ASSERT_EQ(read_lines(points[0].file).size(), 1u);
+    ASSERT_EQ(read_lines(points[0].file)[0], "datetime,t,swe");
+
+    for (int i = 0; i < 3; i++)
+    {
+        out.begin_row(t0 + hours(i));
+        out.row(0)[0] = i;
+        out.row(1)[1] = 10 * i;
+
+        if (out.end_row())
+            out.flush();
+    }
+
+    ASSERT_EQ(out.rows_written(), 2u);
+    ASSERT_EQ(read_lines(points[0].file).size(), 3u);
+
+    out.flush();
+    ASSERT_EQ(out.rows_written(), 3u);
+
+    auto a = read_lines(points[0].file);
+    ASSERT_EQ(a.size(), 4u);
+    ASSERT_EQ(a[1], "20200101T000000,0,-9999");
+    ASSERT_EQ(a[3], "20200101T020000,2,-9999");
+
+    auto b = read_lines(points[1].file);
+    ASSERT_EQ(b[2], "20200101T010000,-9999,10");
+}
+
+TEST_F(PointOutputTest, FlushOnDestruction)
+{
+    {
+        point_output out(point_output::format::csv, points, {"t"}, "", 100);
+        out.begin_row(t0);
+        out.row(0)[0] = 1;
+        ASSERT_FALSE(out.end_row());
+    }
+
+    ASSERT_EQ(read_lines(points[0].file).size(), 2u);
+}
+
+TEST_F(PointOutputTest, NetCDF)
+{
+    auto file = (dir / "points_0.nc").string();
+    {
+        point_output out(point_output::format::netcdf, points, {"t", "swe"}, file, 2);
+        for (int i = 0; i < 3; i++)
+        {
+            out.begin_row(t0 + hours(i));
+            out.row(1)[0] = i;
+
+            if (out.end_row())
+                out.flush();
+        }
+    }
+
+    netCDF::NcFile nc(file, netCDF::NcFile::read);
+    ASSERT_EQ(nc.getDim("time").getSize(), 3u);
+    ASSERT_EQ(nc.getDim("point").getSize(), 2u);
+
+    std::vector<float> t(6);
+    nc.getVar("t").getVar(t.data());
+    ASSERT_EQ(t[1], 0.f);
+    ASSERT_EQ(t[5], 2.f);
+    ASSERT_EQ(t[0], -9999.f);
+
+    long long seconds = 0;
+    nc.getVar("time").getVar({2}, &seconds);
+    ASSERT_EQ(seconds, (t0 + hours(2) - ptime(boost::gregorian::date(1970, 1, 1))).total_seconds());
+}
@@ -0,0 +1,200 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "triangulation.hpp"
+#include "Marsh_shading_iswr.hpp"
+#include "gtest/gtest.h"
+
+#include <boost/make_shared.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <map>
+#include <array>
+#include <cmath>
+
+namespace pt = boost::property_tree;
+
+/**
+ * Marsh_shading_iswr on a synthetic north-south ridge lit from the west. The ridge is h high with flanks a wide on flat
+ * ground, so the lee shadow should reach h / tan(el) east of the crest.
+ */
+class ShadingTest : public testing::Test
+{
+  protected:
+
+    virtual void SetUp()
+    {
+        logging::core::get()->set_logging_enabled(false);
+
+        // regular grid of vertices, 2 triangles per cell
+        const size_t nx = size_t(L / dx) + 1;
+        const size_t ny = size_t(W / dx) + 1;
+
+        pt::ptree vertex, elem, neigh;
+        auto row = [](std::initializer_list<double> values)
+        {
+            pt::ptree r;
+            for (auto v : values)
+            {
+                pt::ptree item;
+                item.put("", v);
+                r.push_back(std::make_pair("", item));
+            }
+            return r;
+        };
+
+        for (size_t j = 0; j < ny; j++)
+        {
+            for (size_t i = 0; i < nx; i++)
+            {
+                double x = i * dx;
+                double z = h * std::max(0.0, 1.0 - std::fabs(x - x0) / a);
+                vertex.push_back(std::make_pair("", row({x, j * dx, z})));
+            }
+        }
+
+        std::vector<std::array<size_t, 3>> tris;
+        for (size_t j = 0; j + 1 < ny; j++)
+        {
+            for (size_t i = 0; i + 1 < nx; i++)
+            {
+                size_t v = j * nx + i;
+                tris.push_back({v, v + 1, v + nx + 1});
+                tris.push_back({v, v + nx + 1, v + nx});
+            }
+        }
+
+        // neighbour k is across the edge opposite vertex k
+        std::map<std::pair<size_t, size_t>, std::vector<size_t>> edges;
+        for (size_t t = 0; t < tris.size(); t++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                size_t p = tris[t][(k + 1) % 3], q = tris[t][(k + 2) % 3];
+                edges[std::minmax(p, q)].push_back(t);
+            }
+        }
+
+        for (size_t t = 0; t < tris.size(); t++)
+        {
+            std::vector<double> n;
+            for (int k = 0; k < 3; k++)
+            {
+                size_t p = tris[t][(k + 1) % 3], q = tris[t][(k + 2) % 3];
+                auto& shared = edges[std::minmax(p, q)];
+                n.push_back(shared.size() == 2 ? double(shared[0] == t ? shared[1] : shared[0]) : -1);
+            }
+
+            elem.push_back(std::make_pair("", row({double(tris[t][0]), double(tris[t][1]), double(tris[t][2])})));
+            neigh.push_back(std::make_pair("", row({n[0], n[1], n[2]})));
+        }
+
+        pt::ptree json;
+        json.put("mesh.is_geographic", 0);
+        json.put("mesh.proj4", "+proj=utm +zone=8 +ellps=GRS80 +towgs84=0,0,0,0,0,0,0 +units=m +no_defs ");
+        json.put("mesh.nvertex", nx * ny);
+        json.put("mesh.nelem", tris.size());
+        json.add_child("mesh.vertex", vertex);
+        json.add_child("mesh.elem", elem);
+        json.add_child("mesh.neigh", neigh);
+
+        domain = boost::make_shared<triangulation>();
+        domain->from_json(json);
+        domain->init_timeseries({"shadow", "z_prime", "solar_az", "solar_el"});
+    }
+
+    // runs the module with the sun at the azimuth and elevation [deg]
+    void shade(double az, double el, double resolution)
+    {
+        auto h_az = domain->handle("solar_az");
+        auto h_el = domain->handle("solar_el");
+        for (size_t i = 0; i < domain->size_faces(); i++)
+        {
+            domain->face(i)->get(h_az) = az;
+            domain->face(i)->get(h_el) = el;
+        }
+
+        config_file cfg;
+        cfg.put("resolution", resolution);
+        Marsh_shading_iswr shading(cfg);
+        shading.init(domain);
+        shading.run(domain);
+    }
+
+    // checks the shadow of each face against the ridge geometry, ignoring faces within margin of the shadow edges
+    void check_ridge(double el, double margin)
+    {
+        auto h_shadow = domain->handle("shadow");
+        double end = x0 + h / std::tan(el * M_PI / 180.);
+
+        size_t lit = 0, shadowed = 0;
+        for (size_t i = 0; i < domain->size_faces(); i++)
+        {
+            auto f = domain->face(i);
+            double x = f->get_x();
+            bool expected = x > x0 && x < end;
+
+            if (std::fabs(x - x0) < margin || std::fabs(x - end) < margin)
+                continue;
+
+            ASSERT_EQ(f->get(h_shadow), expected ? 1. : 0.) << "face at x=" << x;
+            expected ? shadowed++ : lit++;
+        }
+
+        ASSERT_GT(shadowed, 0u);
+        ASSERT_GT(lit, 0u);
+    }
+
+    // a 50 m ridge, 10 m flanks, 5 m grid
+    const double L = 300, W = 200, dx = 5, x0 = 100, a = 10, h = 50;
+
+    mesh domain;
+};
+
+TEST_F(ShadingTest, RidgeShadowLength)
+{
+    // automatic cell size. The sun is due west, so the shadow ends at x0 + h / tan(30) ~ 187 m. Without the slope bias
+    // the flat faces either side of the ridge shadow themselves at this cell size
+    shade(270, 30, 0);
+    check_ridge(30, dx);
+}
+
+TEST_F(ShadingTest, RidgeShadowFineCells)
+{
+    // fine cells split the raster into many bands of rows, and each band must see every face binned to it
+    shade(270, 30, 0.2);
+    check_ridge(30, dx);
+
+    shade(270, 45, 0.5);
+    check_ridge(45, dx);
+}
+
+TEST_F(ShadingTest, RidgeLowSun)
+{
+    // below 5 degrees nothing is shadowed
+    shade(270, 3, 0);
+
+    auto h_shadow = domain->handle("shadow");
+    for (size_t i = 0; i < domain->size_faces(); i++)
+        ASSERT_EQ(domain->face(i)->get(h_shadow), 0.);
+}
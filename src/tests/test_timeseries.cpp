@@ -25,6 +25,8 @@
 
 #include "timeseries.hpp"
 #include "gtest/gtest.h"
+#include <boost/filesystem.hpp>
+#include <fstream>
 
 
 class TimeseriesTest : public testing::Test
@@ -306,6 +308,38 @@ TEST_F(TimeseriesTest, MissingTimeStep)
     ASSERT_ANY_THROW(s0.open("missing_timestep.txt"));
 }
 
+TEST_F(TimeseriesTest, Cache)
+{
+    namespace fs = boost::filesystem;
+    auto path = (fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.txt")).string();
+    fs::copy_file("test_met_data_longer1.txt", path);
+
+    timeseries parsed;
+    ASSERT_NO_THROW(parsed.open(path, true));
+    ASSERT_TRUE(fs::exists(path + ".chmcache"));
+
+    timeseries cached;
+    ASSERT_NO_THROW(cached.open(path, true));
+    ASSERT_EQ(cached.list_variables(), parsed.list_variables());
+    ASSERT_EQ(cached.get_date_timeseries(), parsed.get_date_timeseries());
+    ASSERT_EQ(cached.get_timeseries_length(), parsed.get_timeseries_length());
+    for (auto& v : parsed.list_variables())
+        ASSERT_EQ(cached.get_time_series(v), parsed.get_time_series(v));
+
+    // a changed file must not be loaded from the stale cache
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "datetime t\n20101001T090000 1.5\n20101001T100000 2.5\n";
+    }
+    timeseries changed;
+    ASSERT_NO_THROW(changed.open(path, true));
+    ASSERT_EQ(changed.get_date_timeseries().size(), 2u);
+    ASSERT_DOUBLE_EQ(changed.at("t", 1), 2.5);
+
+    fs::remove(path);
+    fs::remove(path + ".chmcache");
+}
+
 TEST_F(TimeseriesTest, Init)
 {
     timeseries s;
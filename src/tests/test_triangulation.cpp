@@ -24,9 +24,12 @@
 
 
 #include "triangulation.hpp"
+#include "mesh_h5_writer.hpp"
+#include "interp_weights.hpp"
 #include "gtest/gtest.h"
 #include "readjson.hpp"
 #include <boost/property_tree/ptree.hpp>
+#include <boost/filesystem.hpp>
 
 struct test_module_data : face_info
 {
@@ -135,6 +138,355 @@ TEST_F(TriangulationTest, VarReadWriteValue_s)
     ASSERT_EQ((*f)["u"_s],15.0);
 }
 
+TEST_F(TriangulationTest, VarHandle)
+{
+    auto h = mesh.handle("rh");
+    ASSERT_TRUE(h.valid());
+    ASSERT_ANY_THROW(mesh.handle("not_a_variable"));
+
+    auto f = mesh.face(1);
+    f->get(h) = 42.0;
+
+    ASSERT_EQ((*f)["rh"],42.0);
+    ASSERT_EQ(f->get(h),42.0);
+    ASSERT_EQ(mesh.face(0)->get(h),-9999.0);
+}
+
+TEST_F(TriangulationTest, FaceGeometry)
+{
+    auto& g = mesh.geometry();
+    ASSERT_EQ(g.size(), mesh.size_faces());
+
+    for (size_t i = 0; i < mesh.size_faces(); i++)
+    {
+        auto f = mesh.face(i);
+        auto c = CGAL::centroid(f->vertex(0)->point(), f->vertex(1)->point(), f->vertex(2)->point());
+
+        ASSERT_DOUBLE_EQ(f->get_x(), c.x());
+        ASSERT_DOUBLE_EQ(f->get_y(), c.y());
+        ASSERT_DOUBLE_EQ(f->get_z(), c.z());
+        ASSERT_EQ(f->get_x(), g.x[i]);
+        ASSERT_EQ(f->slope(), g.slope[i]);
+        ASSERT_EQ(f->aspect(), g.aspect[i]);
+        ASSERT_EQ(f->get_area(), g.area[i]);
+        ASSERT_EQ(f->normal(), Vector_3(g.nx[i], g.ny[i], g.nz[i]));
+
+        ASSERT_GE(f->slope(), 0);
+        ASSERT_LE(f->slope(), M_PI / 2.);
+        ASSERT_GT(f->get_area(), 0);
+    }
+}
+
+TEST_F(TriangulationTest, UpdateFaceGeometry)
+{
+    auto& g = mesh.geometry();
+    const double* slope = g.slope.data();
+
+    for (size_t i = 0; i < mesh.size_vertex(); i++)
+    {
+        auto v = mesh.vertex(i);
+        v->set_point(Point_3(v->point().x(), v->point().y(), v->point().z() * 0.5));
+    }
+    mesh.update_face_geometry();
+
+    // updated in place
+    ASSERT_EQ(g.slope.data(), slope);
+    ASSERT_EQ(g.size(), mesh.size_faces());
+
+    for (size_t i = 0; i < mesh.size_faces(); i++)
+    {
+        auto f = mesh.face(i);
+        auto c = CGAL::centroid(f->vertex(0)->point(), f->vertex(1)->point(), f->vertex(2)->point());
+        ASSERT_DOUBLE_EQ(f->get_z(), c.z());
+        ASSERT_EQ(f->slope(), g.slope[i]);
+    }
+}
+
+TEST_F(TriangulationTest, H5Output)
+{
+    auto h = mesh.handle("t");
+    for (size_t i = 0; i < mesh.size_faces(); i++)
+        mesh.face(i)->get(h) = i;
+
+    auto base = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+
+    {
+        mesh_h5_writer writer(&mesh, base, {"t", "u"}, true);
+        writer.write_timestep(100);
+        mesh.face(0)->get(h) = 42;
+        writer.write_timestep(200);
+        ASSERT_EQ(writer.timesteps(), 2u);
+
+        // the appended sidecar already has both timesteps, and end() rewrites it with the final extent
+        std::ifstream xdmf(base + ".xdmf");
+        std::string appended((std::istreambuf_iterator<char>(xdmf)), std::istreambuf_iterator<char>());
+        ASSERT_NE(appended.find("<Time Value=\"200\"/>"), std::string::npos);
+        ASSERT_EQ(appended.rfind("</Xdmf>\n"), appended.size() - 8);
+
+        writer.end();
+        std::ifstream final_xdmf(base + ".xdmf");
+        std::string full((std::istreambuf_iterator<char>(final_xdmf)), std::istreambuf_iterator<char>());
+        ASSERT_EQ(full.find("Dimensions=\"1 " + std::to_string(mesh.size_faces()) + "\" NumberType"), std::string::npos);
+        ASSERT_NE(full.find("<Time Value=\"100\"/>"), std::string::npos);
+    }
+
+    H5::H5File file(base + ".h5", H5F_ACC_RDONLY);
+
+    auto t = file.openDataSet("/variables/t");
+    hsize_t dims[2];
+    t.getSpace().getSimpleExtentDims(dims);
+    ASSERT_EQ(dims[0], 2u);
+    ASSERT_EQ(dims[1], mesh.size_faces());
+
+    std::vector<float> values(dims[0] * dims[1]);
+    t.read(values.data(), PredType::NATIVE_FLOAT);
+    ASSERT_EQ(values[0], 0.f);
+    ASSERT_EQ(values[1], 1.f);
+    ASSERT_EQ(values[dims[1]], 42.f);
+
+    // u was never set so is all missing
+    std::vector<float> u(dims[0] * dims[1]);
+    file.openDataSet("/variables/u").read(u.data(), PredType::NATIVE_FLOAT);
+    ASSERT_TRUE(std::isnan(u[0]));
+
+    auto elem = file.openDataSet("/geometry/elem");
+    elem.getSpace().getSimpleExtentDims(dims);
+    ASSERT_EQ(dims[0], mesh.size_faces());
+    ASSERT_EQ(dims[1], 3u);
+
+    ASSERT_TRUE(boost::filesystem::exists(base + ".xdmf"));
+
+    boost::filesystem::remove(base + ".h5");
+    boost::filesystem::remove(base + ".xdmf");
+}
+
+TEST_F(TriangulationTest, InterpWeights)
+{
+    auto domain = boost::make_shared<triangulation>();
+    domain->from_json(mesh_json);
+
+    auto f0 = domain->face(0);
+    auto s1 = std::make_shared<station>("s1", f0->get_x() + 10, f0->get_y(), 0);
+    auto s2 = std::make_shared<station>("s2", f0->get_x(), f0->get_y() - 30, 0);
+
+    auto set = domain->station_sets().insert({s1, s2}, s1);
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        domain->face(i)->set_station_set(set);
+    }
+
+    interp_weights w;
+    ASSERT_FALSE(interp_weights::supports(interp_alg::tpspline));
+    ASSERT_ANY_THROW(w.init(interp_alg::tpspline, domain));
+    ASSERT_NO_THROW(w.init(interp_alg::idw, domain));
+    ASSERT_EQ(w.rows(), domain->size_faces());
+    ASSERT_EQ(w.stations().size(), 2);
+
+    std::vector<double> values(2), out;
+    for (size_t j = 0; j < 2; j++)
+        values[j] = w.stations()[j] == s1 ? 5.0 : 10.0;
+
+    w.apply(values, out);
+
+    // same as the per-face interpolant
+    inv_dist idw;
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto f = domain->face(i);
+        std::vector<boost::tuple<double, double, double> > xy = {boost::make_tuple(s1->x(), s1->y(), 5.0),
+                                                                 boost::make_tuple(s2->x(), s2->y(), 10.0)};
+        auto query = boost::make_tuple(f->get_x(), f->get_y(), f->get_z());
+        ASSERT_NEAR(out[i], idw(xy, query), 1e-10);
+    }
+
+    // masked station is dropped and the remaining weights renormalised
+    for (size_t j = 0; j < 2; j++)
+        if(w.stations()[j] == s2)
+            values[j] = std::numeric_limits<double>::quiet_NaN();
+
+    w.apply(values, out);
+    for (auto v : out)
+        ASSERT_DOUBLE_EQ(v, 5.0);
+
+    // all masked
+    values.assign(2, std::numeric_limits<double>::quiet_NaN());
+    w.apply(values, out);
+    ASSERT_TRUE(std::isnan(out[0]));
+}
+
+TEST_F(TriangulationTest, InterpWeightsNearest)
+{
+    auto domain = boost::make_shared<triangulation>();
+    domain->from_json(mesh_json);
+
+    auto f0 = domain->face(0);
+    auto s1 = std::make_shared<station>("s1", f0->get_x() + 10, f0->get_y(), 0);
+    auto s2 = std::make_shared<station>("s2", f0->get_x(), f0->get_y() - 30, 0);
+
+    // a face with a larger station list still only takes its nearest station
+    auto set = domain->station_sets().insert({s1, s2}, s2);
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        domain->face(i)->set_station_set(set);
+    }
+
+    interp_weights w;
+    ASSERT_NO_THROW(w.init(interp_alg::nearest_sta, domain));
+    ASSERT_EQ(w.rows(), domain->size_faces());
+    ASSERT_EQ(w.stations().size(), 1);
+    ASSERT_EQ(w.stations()[0], s2);
+
+    std::vector<double> values = {10.0}, out;
+    w.apply(values, out);
+
+    // same as the per-face interpolant given the nearest station
+    nearest n;
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto f = domain->face(i);
+        std::vector<boost::tuple<double, double, double> > xy = {boost::make_tuple(s2->x(), s2->y(), 10.0)};
+        auto query = boost::make_tuple(f->get_x(), f->get_y(), f->get_z());
+        ASSERT_DOUBLE_EQ(out[i], n(xy, query));
+    }
+}
+
+TEST_F(TriangulationTest, StationSets)
+{
+    auto s1 = std::make_shared<station>("s1", 0, 0, 0);
+    auto s2 = std::make_shared<station>("s2", 10, 0, 0);
+
+    station_set_table table;
+    auto a = table.insert({s1, s2}, s1);
+    auto b = table.insert({s1}, s1);
+
+    // identical sets are interned
+    ASSERT_EQ(table.insert({s1, s2}, s1), a);
+    ASSERT_NE(a, b);
+
+    // same stations with a different nearest station is a different set
+    auto c = table.insert({s1, s2}, s2);
+    ASSERT_NE(a, c);
+
+    ASSERT_EQ(table.size(), 3u);
+    ASSERT_EQ(table.members(), 5u);
+
+    auto members = table.stations(a);
+    ASSERT_EQ(members.size(), 2u);
+    ASSERT_EQ(members[0], s1);
+    ASSERT_EQ(members[1], s2);
+    ASSERT_EQ(table.nearest(c), s2);
+
+    ASSERT_TRUE(table.stations(station_set_table::npos).empty());
+    ASSERT_EQ(table.nearest(station_set_table::npos), nullptr);
+
+    // faces default to no stations
+    auto f = mesh.face(0);
+    ASSERT_EQ(f->station_set(), station_set_table::npos);
+    ASSERT_TRUE(f->stations().empty());
+
+    auto id = mesh.station_sets().insert({s1, s2}, s2);
+    f->set_station_set(id);
+    ASSERT_EQ(f->stations().size(), 2u);
+    ASSERT_EQ(f->nearest_station(), s2);
+}
+
+TEST_F(TriangulationTest, AzimuthTable)
+{
+    azimuth_table t;
+    t.init(2, 4);
+    ASSERT_EQ(t.rows(), 2u);
+    ASSERT_EQ(t.bins(), 4u);
+    ASSERT_DOUBLE_EQ(t.bin_azimuth(1), 90.);
+
+    t(1, 0) = 1;
+    t(1, 1) = 3;
+    t(1, 3) = 5;
+
+    ASSERT_DOUBLE_EQ(t.at(1, 0), 1.);
+    ASSERT_DOUBLE_EQ(t.at(1, 45), 2.);
+    ASSERT_DOUBLE_EQ(t.at(1, 90), 3.);
+    ASSERT_DOUBLE_EQ(t.at(0, 45), 0.);
+
+    // wraps through north
+    ASSERT_DOUBLE_EQ(t.at(1, 315), 3.);
+    ASSERT_DOUBLE_EQ(t.at(1, 360), 1.);
+    ASSERT_DOUBLE_EQ(t.at(1, -45), 3.);
+}
+
+TEST_F(TriangulationTest, Horizon)
+{
+    auto& h = mesh.horizon(8, 5, 50.);
+    ASSERT_EQ(h.rows(), mesh.size_faces());
+
+    // shared between callers with the same search
+    ASSERT_EQ(&h, &mesh.horizon(8, 5, 50.));
+
+    for (size_t i = 0; i < mesh.size_faces(); i += 97)
+    {
+        auto f = mesh.face(i);
+        for (size_t k = 0; k < h.bins(); k++)
+        {
+            double phi = 0;
+            for (int j = 1; j <= 5; j++)
+            {
+                auto n = f->find_closest_face(h.bin_azimuth(k), j * 10.);
+                double z_diff = n->center().z() - f->center().z();
+                if (z_diff > 0)
+                    phi = std::max(phi, atan(z_diff / math::gis::distance(n->center(), f->center())));
+            }
+            ASSERT_NEAR(h(i, k), phi, 1e-6);
+        }
+    }
+}
+
+TEST_F(TriangulationTest, HorizonPointMode)
+{
+    auto& full = mesh.horizon(8, 5, 50.);
+
+    // point mode keeps only the output faces, which then need to be found by their row in the pruned mesh
+    triangulation points;
+    points.from_json(mesh_json);
+
+    std::vector<size_t> keep = {900, 3, 640};
+    std::vector<mesh_elem> faces;
+    for (auto i : keep)
+        faces.push_back(points.face(i));
+    points.prune_faces(faces);
+    ASSERT_EQ(points.size_faces(), keep.size());
+
+    auto& h = points.horizon(8, 5, 50.);
+    ASSERT_EQ(h.rows(), keep.size());
+
+    for (size_t i = 0; i < keep.size(); i++)
+    {
+        ASSERT_EQ(points.face(i)->cell_local_id, i);
+        for (size_t k = 0; k < h.bins(); k++)
+        {
+            ASSERT_NEAR(h.at(points.face(i)->cell_local_id, h.bin_azimuth(k)), full(keep[i], k), 1e-6);
+        }
+    }
+}
+
+TEST_F(TriangulationTest, DirectionLibrary)
+{
+    direction_library lib;
+    ASSERT_NO_THROW(lib.load(mesh, {{"MS0", "area"}, {"area", "MS0"}}));
+    ASSERT_EQ(lib.rows(), mesh.size_faces());
+    ASSERT_EQ(lib.directions(), 2u);
+    ASSERT_EQ(lib.components(), 2u);
+
+    auto f = mesh.face(1);
+    ASSERT_FLOAT_EQ(lib(1, 0, 0), f->parameter("MS0"));
+    ASSERT_FLOAT_EQ(lib(1, 0, 1), f->parameter("area"));
+    ASSERT_FLOAT_EQ(lib(1, 1, 1), f->parameter("MS0"));
+
+    double mid = 0.5 * (lib(1, 0, 0) + lib(1, 1, 0));
+    ASSERT_DOUBLE_EQ(lib.lerp(1, 0, 1, 0.5, 0), mid);
+    ASSERT_DOUBLE_EQ(lib.lerp(1, 0, 1, 0., 0), lib(1, 0, 0));
+
+    ASSERT_ANY_THROW(lib.load(mesh, {{"MS0"}, {"MS1"}}));
+}
+
 TEST_F(TriangulationTest, ParamReadValue)
 {
     auto f = mesh.face(0);
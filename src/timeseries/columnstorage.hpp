@@ -0,0 +1,338 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+// hash functions
+#include "utility/BBhash.h"
+#include "utility/wyhash.h"
+#include "utility/xxh64.hpp"
+
+
+#include "logger.hpp"
+#include "exception.hpp"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <limits>
+
+/**
+ * A variable resolved to its column in a columnstorage. Resolve once, e.g., in a module's init, then use for direct
+ * indexed access without any hash lookups.
+ */
+struct var_handle
+{
+    size_t column = std::numeric_limits<size_t>::max();
+
+    bool valid() const
+    {
+        return column != std::numeric_limits<size_t>::max();
+    }
+};
+
+/**
+ * Structure-of-arrays variable storage for an entire mesh.
+ * Each variable is held as one contiguous column of length rows(), and a single name->column
+ * map (mphf) is shared by every row. This replaces having one variablestorage per face, which duplicated the
+ * hash table on every triangle.
+ *
+ * A row corresponds to a face, a column to a variable.
+ */
+template<typename T = double>
+class columnstorage
+{
+  public:
+    columnstorage();
+
+    /// Initialize the storage with a set of variables and number of rows. Values default to -9999
+    /// @param variables
+    /// @param rows
+    columnstorage(std::set<std::string>& variables, size_t rows);
+    ~columnstorage();
+
+    /// Initialize the storage with a set of variables and number of rows. Values default to -9999
+    /// Any existing storage is discarded.
+    /// @param variables
+    /// @param rows
+    void init(std::set<std::string>& variables, size_t rows);
+
+    /// Resolve the column index of a variable. Use _s for compile-time hash.
+    /// Throws if not found or init/ctor not yet called.
+    /// @param hash
+    /// @return
+    size_t column(const uint64_t& hash) const;
+    /// Resolve the column index of a variable.
+    /// Throws if not found or init/ctor not yet called.
+    /// @param variable
+    /// @return
+    size_t column(const std::string& variable) const;
+
+    /// Direct, unchecked access to a (row, column) pair. Column should be obtained from column()
+    /// @param row
+    /// @param col
+    /// @return
+    inline T& operator()(const size_t& row, const size_t& col)
+    {
+        return _columns[col][row];
+    }
+
+    /// Get and set the variable for a given row. Use _s for compile-time hash.
+    /// Throws if not found or init/ctor not yet called.
+    /// @param row
+    /// @param hash
+    /// @return
+    T& at(const size_t& row, const uint64_t& hash);
+    /// Get and set the variable for a given row.
+    /// Throws if not found or init/ctor not yet called.
+    /// @param row
+    /// @param variable
+    /// @return
+    T& at(const size_t& row, const std::string& variable);
+
+    /// Pointer to the start of the contiguous column
+    /// @param col
+    /// @return
+    T* column_data(const size_t& col);
+
+    /// Determine if a variable is in the storage. Uses _s for compile time hash
+    /// @param hash
+    /// @return
+    bool has(const uint64_t& hash) const;
+    /// Determine if a variable is in the storage.
+    /// @param variable
+    /// @return
+    bool has(const std::string& variable) const;
+
+    /// Returns a list of the variables stored, in column order
+    /// @return
+    std::vector<std::string> variables() const;
+
+    /// Returns the number of variables (columns) stored
+    /// @return
+    size_t size() const;
+
+    /// Returns the number of rows in each column
+    /// @return
+    size_t rows() const;
+
+  private:
+
+    template <typename Item> class wyandFunctor
+    {
+      public:
+        uint64_t operator ()  (const Item& key, uint64_t seed = 2654435761U) const
+        {
+            return wyhash(&key, sizeof(Item), seed);
+        }
+
+    };
+    typedef wyandFunctor<uint64_t> hasher_t;
+    typedef boomphf::mphf< uint64_t, hasher_t  > boophf_t;
+
+    // sets the default value of newly created variables
+    T get_default_value();
+
+    // mphf returns an index for any key, so confirm the xxhash of the column matches what was asked for
+    // https://github.com/rizkg/BBHash/issues/12
+    // returns _size if not found
+    size_t lookup(const uint64_t& hash) const;
+
+    // perfect hashfn, built once for all rows
+    std::unique_ptr<boophf_t> _variable_bphf;
+
+    // per-column name and hash, indexed by the mphf result
+    std::vector<uint64_t> _xxhash;
+    std::vector<std::string> _names;
+
+    // one contiguous array per variable
+    std::vector< std::vector<T> > _columns;
+
+    // Total number of variables stored
+    size_t _size;
+
+    // length of each column
+    size_t _rows;
+};
+
+
+template<typename T>
+columnstorage<T>::columnstorage()
+{
+    _size = 0;
+    _rows = 0;
+    _variable_bphf = nullptr;
+}
+
+template<typename T>
+columnstorage<T>::columnstorage(std::set<std::string>& variables, size_t rows)
+    : columnstorage()
+{
+    init(variables, rows);
+}
+
+template<typename T>
+columnstorage<T>::~columnstorage()
+{
+
+}
+
+template<typename T>
+void columnstorage<T>::init(std::set<std::string>& variables, size_t rows)
+{
+    _variable_bphf = nullptr;
+    _xxhash.clear();
+    _names.clear();
+    _columns.clear();
+    _size = 0;
+    _rows = rows;
+
+    if(variables.empty())
+        return;
+
+    std::vector<u_int64_t> hash_vec;
+    for(auto& v : variables)
+    {
+        uint64_t hash = xxh64::hash (v.c_str(), v.length());
+        hash_vec.push_back(hash);
+    }
+
+    _variable_bphf = std::unique_ptr<boophf_t>(
+        new boophf_t(hash_vec.size(),hash_vec,1,2,false,false));
+
+    _xxhash.resize(variables.size());
+    _names.resize(variables.size());
+    _columns.resize(variables.size());
+
+    for(auto& v : variables)
+    {
+        uint64_t hash = xxh64::hash (v.c_str(), v.length());
+        uint64_t  idx = _variable_bphf->lookup(hash);
+
+        _xxhash[idx] = hash;
+        _names[idx] = v;
+        _columns[idx].assign(rows, get_default_value());
+    }
+
+    _size = variables.size();
+}
+
+template<typename T>
+size_t columnstorage<T>::lookup(const uint64_t& hash) const
+{
+    if(!_variable_bphf)
+        return _size;
+
+    uint64_t  idx = _variable_bphf->lookup(hash);
+
+    if( idx >= _size ||
+        _xxhash[idx] != hash)
+    {
+        return _size;
+    }
+
+    return idx;
+}
+
+template<typename T>
+size_t columnstorage<T>::column(const uint64_t& hash) const
+{
+    size_t idx = lookup(hash);
+    if(idx == _size)
+    {
+        CHM_THROW_EXCEPTION(module_error, "Variable " + std::to_string(hash) + " does not exist.");
+    }
+    return idx;
+}
+
+template<typename T>
+size_t columnstorage<T>::column(const std::string& variable) const
+{
+    size_t idx = lookup(xxh64::hash (variable.c_str(), variable.length()));
+    if(idx == _size)
+    {
+        CHM_THROW_EXCEPTION(module_error, "Variable " + variable + " does not exist.");
+    }
+    return idx;
+}
+
+template<typename T>
+T& columnstorage<T>::at(const size_t& row, const uint64_t& hash)
+{
+    return _columns[column(hash)][row];
+}
+
+template<typename T>
+T& columnstorage<T>::at(const size_t& row, const std::string& variable)
+{
+    return _columns[column(variable)][row];
+}
+
+template<typename T>
+T* columnstorage<T>::column_data(const size_t& col)
+{
+    return _columns[col].data();
+}
+
+template<typename T>
+bool columnstorage<T>::has(const uint64_t& hash) const
+{
+    return lookup(hash) != _size;
+}
+
+template<typename T>
+bool columnstorage<T>::has(const std::string& variable) const
+{
+    return has(xxh64::hash (variable.c_str(), variable.length()));
+}
+
+template<typename T>
+std::vector<std::string> columnstorage<T>::variables() const
+{
+    return _names;
+}
+
+template<typename T>
+size_t columnstorage<T>::size() const
+{
+    return _size;
+}
+
+template<typename T>
+size_t columnstorage<T>::rows() const
+{
+    return _rows;
+}
+
+template<typename T> inline
+T columnstorage<T>::get_default_value()
+{
+    return T{};
+}
+
+template<> inline
+double columnstorage<double>::get_default_value()
+{
+    return -9999;
+}
@@ -25,9 +25,20 @@
 
 #include "netcdf.hpp"
 
+#ifdef USE_MPI
+    #include <mpi.h>
+    #include <netcdf_meta.h>
+    #if NC_HAS_PARALLEL4
+        #include <netcdf_par.h>
+    #endif
+#endif
+
 netcdf::netcdf()
 {
     _is_open = false;
+    _shared = false;
+    _global_length1D = 0;
+    _offset1D = 0;
 }
 netcdf::~netcdf()
 {
@@ -43,7 +54,8 @@ void netcdf::create_variable1D( const std::string& var, size_t length)
     //only create the dim and variables once
     try
     {
-        add_dim1D("tri_id",length);
+        // a shared file holds every rank's block
+        add_dim1D("tri_id", _shared ? _global_length1D : length);
 
     }
     catch(netCDF::exceptions::NcNameInUse& e)
@@ -54,6 +66,12 @@ void netcdf::create_variable1D( const std::string& var, size_t length)
     try
     {
         auto nc_var = _data.addVar(var.c_str(), netCDF::ncDouble, _dimVector);
+        _vars[var] = nc_var;
+
+#if defined(USE_MPI) && NC_HAS_PARALLEL4
+        if (_shared)
+            nc_var_par_access(_data.getId(), nc_var.getId(), NC_COLLECTIVE);
+#endif
     }
     catch(netCDF::exceptions::NcNameInUse& e)
     {
@@ -70,17 +88,13 @@ netCDF::NcFile& netcdf::get_ncfile()
 
 void netcdf::put_var1D(const std::string& var, size_t index, double value)
 {
-    auto vars = _data.getVars();
-
-    auto itr = vars.find(var);
-
     std::vector<size_t> startp,countp;
-    startp.push_back(index);
+    startp.push_back(_offset1D + index);
     countp.push_back(1);
 
     try
     {
-        itr->second.putVar(startp,countp,&value);
+        get_ncvar(var).putVar(startp,countp,&value);
     }
     catch(netCDF::exceptions::NcBadId& e)
     {
@@ -91,19 +105,134 @@ void netcdf::put_var1D(const std::string& var, size_t index, double value)
 
 }
 
+void netcdf::put_var1D(const std::string& var, std::span<const double> values)
+{
+    std::vector<size_t> startp = {_offset1D};
+    std::vector<size_t> countp = {values.size()};
+
+    try
+    {
+        get_ncvar(var).putVar(startp, countp, values.data());
+    }
+    catch(netCDF::exceptions::NcBadId& e)
+    {
+        CHM_THROW_EXCEPTION(forcing_error, "Variable not initialized: " + var);
+    }
+}
+
 void netcdf::create(const std::string& file)
 {
     _data.open(file.c_str(), netCDF::NcFile::replace);
+    _vars.clear();
+    _fill_values.clear();
+    _shared = false;
+    _offset1D = 0;
 
 }
 void netcdf::open(const std::string &file)
 {
     _data.open(file.c_str(), netCDF::NcFile::read);
+
+    _vars.clear();
+    _fill_values.clear();
+    for (auto& itr : _data.getVars())
+        _vars.insert(std::make_pair(itr.first, itr.second));
+}
+
+void netcdf::create_shared(const std::string& file, size_t global_length, size_t offset)
+{
+#if defined(USE_MPI) && NC_HAS_PARALLEL4
+    int ncid = -1;
+    int ret = nc_create_par(file.c_str(), NC_NETCDF4 | NC_CLOBBER, MPI_COMM_WORLD, MPI_INFO_NULL, &ncid);
+    if (ret != NC_NOERR)
+    {
+        CHM_THROW_EXCEPTION(file_write_error, "Unable to create shared file " + file + ": " + nc_strerror(ret));
+    }
+    _data.attach(ncid);
+#elif defined(USE_MPI)
+    int nranks = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &nranks);
+    if (nranks > 1)
+    {
+        CHM_THROW_EXCEPTION(file_write_error, "netCDF was built without parallel support, cannot write shared file " + file);
+    }
+    _data.open(file.c_str(), netCDF::NcFile::replace);
+#else
+    _data.open(file.c_str(), netCDF::NcFile::replace);
+#endif
+
+    _vars.clear();
+    _fill_values.clear();
+    _dimVector.clear();
+
+    _shared = true;
+    _global_length1D = global_length;
+    _offset1D = offset;
+}
+
+void netcdf::open_shared(const std::string& file)
+{
+#if defined(USE_MPI) && NC_HAS_PARALLEL4
+    int ncid = -1;
+    int ret = nc_open_par(file.c_str(), NC_NOWRITE, MPI_COMM_WORLD, MPI_INFO_NULL, &ncid);
+    if (ret != NC_NOERR)
+    {
+        CHM_THROW_EXCEPTION(file_read_error, "Unable to open shared file " + file + ": " + nc_strerror(ret));
+    }
+    _data.attach(ncid);
+
+    _vars.clear();
+    _fill_values.clear();
+    for (auto& itr : _data.getVars())
+        _vars.insert(std::make_pair(itr.first, itr.second));
+#else
+    // read only, so each rank can independently open the same file
+    open(file);
+#endif
+
+    _shared = true;
+    _offset1D = 0;
+}
+
+void netcdf::set_offset1D(size_t offset)
+{
+    _offset1D = offset;
+}
+
+bool netcdf::has_parallel()
+{
+#if defined(USE_MPI) && !NC_HAS_PARALLEL4
+    return false;
+#else
+    return true;
+#endif
+}
+
+std::mutex& netcdf::library_mutex()
+{
+    static std::mutex m;
+    return m;
+}
+
+void netcdf::close()
+{
+    if (!_data.isNull())
+        _data.close();
+
+    _vars.clear();
+    _fill_values.clear();
+    _dimVector.clear();
 }
 void netcdf::open_GEM(const std::string &file)
 {
     _data.open(file.c_str(), netCDF::NcFile::read);
 
+    // cache the variable handles once, getVars() builds a copy of the entire variable map on every call
+    _vars.clear();
+    _fill_values.clear();
+    for (auto& itr : _data.getVars())
+        _vars.insert(std::make_pair(itr.first, itr.second));
+
     // gem netcdf files have 1 coordinate, datetime
 
 //    for (auto& itr : _data.getVars())
@@ -382,22 +511,50 @@ double netcdf::get_fillvalue(const netCDF::NcVar& var)
     return fill_value;
 }
 
+const netCDF::NcVar& netcdf::get_ncvar(const std::string& var)
+{
+    auto itr = _vars.find(var);
+    if(itr != _vars.end())
+        return itr->second;
+
+    // not cached, might have been added after open
+    auto v = _data.getVar(var);
+    if(v.isNull())
+    {
+        CHM_THROW_EXCEPTION(forcing_error, "Variable not initialized: " + var);
+    }
+
+    return _vars[var] = v;
+}
+
+double netcdf::get_fillvalue(const std::string& var)
+{
+    auto itr = _fill_values.find(var);
+    if(itr != _fill_values.end())
+        return itr->second;
+
+    return _fill_values[var] = get_fillvalue(get_ncvar(var));
+}
+
+size_t netcdf::get_offset(boost::posix_time::ptime timestep)
+{
+    auto diff = timestep - _start; // a duration
+
+    return diff.total_seconds() / _timestep.total_seconds();
+}
+
 double netcdf::get_var1D(std::string var, size_t index)
 {
     std::vector<size_t> startp, countp;
 
-    startp.push_back(index);
+    startp.push_back(_offset1D + index);
     countp.push_back(1);
 
-
-    auto vars = _data.getVars();
-
-    auto itr = vars.find(var);
     double data=-9999.0;
-    itr->second.getVar(startp,countp,&data);
+    get_ncvar(var).getVar(startp,countp,&data);
 
 
-    double fill_value = get_fillvalue(itr->second);
+    double fill_value = get_fillvalue(var);
 
     if( data == fill_value)
     {
@@ -407,6 +564,22 @@ double netcdf::get_var1D(std::string var, size_t index)
     return data;
 }
 
+void netcdf::get_var1D(const std::string& var, std::span<double> values)
+{
+    std::vector<size_t> startp = {_offset1D};
+    std::vector<size_t> countp = {values.size()};
+
+    get_ncvar(var).getVar(startp, countp, values.data());
+
+    double fill_value = get_fillvalue(var);
+
+    for (auto& v : values)
+    {
+        if (v == fill_value)
+            v = std::nan("nan");
+    }
+}
+
 netcdf::data netcdf::get_var2D(std::string var)
 {
     std::vector<size_t> startp, countp;
@@ -417,13 +590,10 @@ netcdf::data netcdf::get_var2D(std::string var)
     countp.push_back(ygrid);
     countp.push_back(xgrid);
 
-    auto vars = _data.getVars();
-
     netcdf::data array(boost::extents[ygrid][xgrid]);
-    auto itr = vars.find(var);
-    itr->second.getVar(startp,countp, array.data());
+    get_ncvar(var).getVar(startp,countp, array.data());
 
-    double fill_value = get_fillvalue(itr->second);
+    double fill_value = get_fillvalue(var);
 
     for(size_t i =0; i< array.shape()[0]; i++)
     {
@@ -447,14 +617,11 @@ double netcdf::get_var2D(std::string var, size_t x, size_t y)
     countp.push_back(1);
     countp.push_back(1);
 
-    auto vars = _data.getVars();
-
     double val=-9999;
 
-    auto itr = vars.find(var);
-    itr->second.getVar(startp,countp, &val);
+    get_ncvar(var).getVar(startp,countp, &val);
 
-    double fill_value = get_fillvalue(itr->second);
+    double fill_value = get_fillvalue(var);
 
     if(val == fill_value)
         val = std::nan("nan");
@@ -509,16 +676,14 @@ double netcdf::get_var(std::string var, size_t timestep, size_t x, size_t y)
     // Read the data one record at a time.
     startp[0] = timestep;
 
-    auto vars = _data.getVars();
-
     double val=-9999;
 
-    auto itr = vars.find(var);
+    double fill_value = 0;
 #pragma omp critical
     {
-        itr->second.getVar(startp, countp, &val);
+        get_ncvar(var).getVar(startp, countp, &val);
+        fill_value = get_fillvalue(var);
     }
-    double fill_value = get_fillvalue(itr->second);
 
     if(val == fill_value)
         val = std::nan("nan");
@@ -540,15 +705,11 @@ netcdf::data netcdf::get_var(std::string var, size_t timestep)
     // Read the data one record at a time.
     startp[0] = timestep;
 
-    auto vars = _data.getVars();
-
-
     netcdf::data array(boost::extents[ygrid][xgrid]);
 
-    auto itr = vars.find(var);
-    itr->second.getVar(startp,countp, array.data());
+    get_ncvar(var).getVar(startp,countp, array.data());
 
-    double fill_value = get_fillvalue(itr->second);
+    double fill_value = get_fillvalue(var);
 
 
     for(size_t i =0; i< array.shape()[0]; i++)
@@ -566,17 +727,32 @@ netcdf::data netcdf::get_var(std::string var, size_t timestep)
 
 double netcdf::get_var(std::string var, boost::posix_time::ptime timestep, size_t x, size_t y)
 {
-    auto diff = timestep - _start; // a duration
-
-    auto offset = diff.total_seconds() / _timestep.total_seconds();
-
-    return get_var(var, offset,x,y);
+    return get_var(var, get_offset(timestep), x, y);
 }
 netcdf::data netcdf::get_var(std::string var, boost::posix_time::ptime timestep)
 {
-    auto diff = timestep - _start; // a duration
+    return get_var(var, get_offset(timestep));
+}
+
+void netcdf::get_var_hyperslab(const std::string& var, size_t timestep,
+                               size_t x_start, size_t y_start, size_t nx, size_t ny, double* buffer)
+{
+    std::vector<size_t> startp = {timestep, y_start, x_start};
+    std::vector<size_t> countp = {1, ny, nx};
+
+    get_ncvar(var).getVar(startp, countp, buffer);
 
-    auto offset = diff.total_seconds() / _timestep.total_seconds();
+    double fill_value = get_fillvalue(var);
 
-    return get_var(var, offset);
+    for(size_t i = 0; i < nx * ny; i++)
+    {
+        if(buffer[i] == fill_value)
+            buffer[i] = std::nan("nan");
+    }
+}
+
+void netcdf::get_var_hyperslab(const std::string& var, boost::posix_time::ptime timestep,
+                               size_t x_start, size_t y_start, size_t nx, size_t ny, double* buffer)
+{
+    get_var_hyperslab(var, get_offset(timestep), x_start, y_start, nx, ny, buffer);
 }
\ No newline at end of file
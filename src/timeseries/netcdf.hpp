@@ -28,6 +28,9 @@
 #include <boost/date_time/posix_time/posix_time.hpp> // for boost::posix
 #include <netcdf>
 #include <string>
+#include <map>
+#include <span>
+#include <mutex>
 
 #include "logger.hpp"
 #include "exception.hpp"
@@ -55,6 +58,45 @@ public:
     void open(const std::string &file);
 
     void create(const std::string& file);
+
+    /**
+     * Creates a single file shared by all MPI ranks. 1D variables span global_length entries and this rank's 1D reads
+     * and writes address the block starting at offset, e.g., a rank's faces keyed by their global id.
+     * With MPI, this requires netCDF built with parallel netCDF-4 support and the file is written with collective I/O:
+     * every rank must create the same variables in the same order and should only use the bulk put_var1D.
+     * @param file
+     * @param global_length
+     * @param offset
+     */
+    void create_shared(const std::string& file, size_t global_length, size_t offset);
+
+    /**
+     * Opens a file written by create_shared. Call set_offset1D once this rank's block is known.
+     * Uses parallel access if available, otherwise every rank opens the file independently read-only.
+     * @param file
+     */
+    void open_shared(const std::string& file);
+
+    /**
+     * Sets the first entry of 1D variables addressed by put_var1D/get_var1D. 0 unless the file is shared between ranks.
+     * @param offset
+     */
+    void set_offset1D(size_t offset);
+
+    /**
+     * True if netCDF supports writing a single file collectively from every MPI rank. Always true without MPI.
+     * @return
+     */
+    static bool has_parallel();
+
+    /**
+     * The netCDF library, and the HDF5 library under it, are not thread safe. While another thread may be calling into
+     * either library, e.g., the forcing prefetch thread, every call into them must be made holding this lock.
+     * @return
+     */
+    static std::mutex& library_mutex();
+
+    void close();
     size_t get_xsize();
     size_t get_ysize();
     size_t get_ntimesteps();
@@ -83,9 +125,32 @@ public:
     double get_var(std::string var, size_t timestep, size_t x, size_t y);
     double get_var(std::string var, boost::posix_time::ptime timestep, size_t x, size_t y);
 
+    /**
+     * Reads a [y_start, y_start+ny) by [x_start, x_start+nx) window of a variable at a timestep with a single read.
+     * Values are stored row-major (y, x) in buffer, which must hold at least nx*ny values. _FillValue is replaced with NaN.
+     * @param var
+     * @param timestep
+     * @param x_start
+     * @param y_start
+     * @param nx
+     * @param ny
+     * @param buffer
+     */
+    void get_var_hyperslab(const std::string& var, size_t timestep,
+                           size_t x_start, size_t y_start, size_t nx, size_t ny, double* buffer);
+    void get_var_hyperslab(const std::string& var, boost::posix_time::ptime timestep,
+                           size_t x_start, size_t y_start, size_t nx, size_t ny, double* buffer);
+
     void add_dim1D(const std::string& var, size_t length);
     void create_variable1D(const std::string& var,  size_t length);
     void put_var1D(const std::string& var, size_t index, double value);
+    /**
+     * Writes an entire 1D variable, starting at index 0 (see set_offset1D), in a single call. Prefer this over the per-index put_var1D
+     * when writing a value for every face, e.g., checkpointing.
+     * @param var
+     * @param values
+     */
+    void put_var1D(const std::string& var, std::span<const double> values);
     /**
      * Some data, such as lat/long do not have a time component are only 2 data. This allows loading those data.
      * @param var
@@ -93,13 +158,54 @@ public:
      */
     data get_var2D(std::string var);
     double get_var1D(std::string var, size_t index);
+    /**
+     * Reads values.size() values of a 1D variable, starting at index 0 (see set_offset1D), in a single call. Fill values are returned as nan.
+     * @param var
+     * @param values
+     */
+    void get_var1D(const std::string& var, std::span<double> values);
 
     double get_var2D(std::string var, size_t x, size_t y);
 
     netCDF::NcFile& get_ncfile();
 private:
 
-    netCDF::NcFile _data; // main netcdf file
+    /**
+     * Returns the cached handle to a variable. Variables are cached on open, avoiding getVars() which copies the
+     * entire variable map on every call. Throws if the variable does not exist.
+     * @param var
+     * @return
+     */
+    const netCDF::NcVar& get_ncvar(const std::string& var);
+
+    /**
+     * Cached version of get_fillvalue
+     * @param var
+     * @return
+     */
+    double get_fillvalue(const std::string& var);
+
+    // converts a time to the offset into the datetime dimension
+    size_t get_offset(boost::posix_time::ptime timestep);
+
+    // NcFile that can also take over a file opened through the netCDF C API, as netCDF-cxx4 does not expose parallel access
+    class ncfile : public netCDF::NcFile
+    {
+      public:
+        void attach(int ncid)
+        {
+            if (!isNull())
+                close();
+
+            myId = ncid;
+            nullObject = false;
+        }
+    };
+
+    ncfile _data; // main netcdf file
+
+    std::map<std::string, netCDF::NcVar> _vars; // cached variable handles
+    std::map<std::string, double> _fill_values; // cached _FillValues
     std::string _datetime_field; // name of the datetime field, the unlimited dimension
     std::string _lat, _lon; //name of lat and long fields
     size_t xgrid, ygrid;
@@ -119,4 +225,9 @@ private:
     //if we are creating variables
     std::vector<netCDF::NcDim> _dimVector; //we need this dimension var to create new variables
 
+    // file is shared between ranks, see create_shared
+    bool _shared;
+    size_t _global_length1D; // length of the 1D dimension over all ranks
+    size_t _offset1D; // start of this rank's block in the 1D dimension
+
 };
\ No newline at end of file
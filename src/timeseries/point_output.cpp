@@ -0,0 +1,212 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "point_output.hpp"
+
+#include <fstream>
+
+point_output::point_output(format fmt,
+                           std::vector<point> points,
+                           std::vector<std::string> variables,
+                           const std::string& nc_file,
+                           size_t flush_interval)
+    : _format(fmt),
+      _points(points),
+      _variables(variables),
+      _flush_interval(std::max<size_t>(1, flush_interval)),
+      _written(0)
+{
+    _times.reserve(_flush_interval);
+    _values.reserve(_flush_interval * _points.size() * _variables.size());
+
+    if (_format == format::csv)
+    {
+        for (auto& p : _points)
+        {
+            std::ofstream out(p.file, std::ios::trunc);
+            if (!out.is_open())
+            {
+                CHM_THROW_EXCEPTION(file_write_error, "Unable to create point output " + p.file);
+            }
+
+            out << "datetime";
+            for (auto& v : _variables)
+                out << "," << v;
+            out << std::endl;
+        }
+    }
+    else
+    {
+        _nc = std::make_unique<netcdf>();
+        _nc->create(nc_file);
+        auto& nc = _nc->get_ncfile();
+
+        auto time_dim = nc.addDim("time"); // unlimited
+        auto point_dim = nc.addDim("point", _points.size());
+
+        auto time = nc.addVar("time", netCDF::ncInt64, time_dim);
+        time.putAtt("units", "seconds since 1970-01-01 00:00:00");
+        time.putAtt("calendar", "standard");
+
+        auto name = nc.addVar("point_name", netCDF::ncString, point_dim);
+        auto lon = nc.addVar("longitude", netCDF::ncDouble, point_dim);
+        lon.putAtt("units", "degrees_east");
+        auto lat = nc.addVar("latitude", netCDF::ncDouble, point_dim);
+        lat.putAtt("units", "degrees_north");
+
+        for (size_t i = 0; i < _points.size(); i++)
+        {
+            std::vector<size_t> idx = {i};
+            name.putVar(idx, _points[i].name);
+            lon.putVar(idx, _points[i].longitude);
+            lat.putVar(idx, _points[i].latitude);
+        }
+
+        std::vector<netCDF::NcDim> dims = {time_dim, point_dim};
+        std::vector<size_t> chunks = {_flush_interval, std::max<size_t>(1, _points.size())};
+        for (auto& v : _variables)
+        {
+            auto var = nc.addVar(v, netCDF::ncFloat, dims);
+            var.putAtt("_FillValue", netCDF::ncFloat, -9999.f);
+            var.setChunking(netCDF::NcVar::nc_CHUNKED, chunks);
+            var.setCompression(true, true, 4);
+        }
+    }
+}
+
+point_output::~point_output()
+{
+    try
+    {
+        flush();
+    }
+    catch (std::exception& e)
+    {
+        SPDLOG_ERROR("Unable to write point output: {}", e.what());
+    }
+}
+
+void point_output::begin_row(boost::posix_time::ptime t)
+{
+    _times.push_back(t);
+    _values.resize(_times.size() * _points.size() * _variables.size(), -9999.);
+}
+
+double* point_output::row(size_t point)
+{
+    return _values.data() + ((_times.size() - 1) * _points.size() + point) * _variables.size();
+}
+
+bool point_output::end_row()
+{
+    return _times.size() >= _flush_interval;
+}
+
+void point_output::flush()
+{
+    if (_times.empty())
+        return;
+
+    if (_format == format::csv)
+        flush_csv();
+    else
+        flush_netcdf();
+
+    _written += _times.size();
+    _times.clear();
+    _values.clear();
+}
+
+void point_output::flush_csv()
+{
+    size_t nvar = _variables.size();
+
+    for (size_t p = 0; p < _points.size(); p++)
+    {
+        std::ofstream out(_points[p].file, std::ios::app);
+        if (!out.is_open())
+        {
+            CHM_THROW_EXCEPTION(file_write_error, "Unable to write point output " + _points[p].file);
+        }
+
+        for (size_t r = 0; r < _times.size(); r++)
+        {
+            out << boost::posix_time::to_iso_string(_times[r]);
+
+            const double* v = _values.data() + (r * _points.size() + p) * nvar;
+            for (size_t j = 0; j < nvar; j++)
+                out << "," << v[j];
+
+            out << "\n";
+        }
+    }
+}
+
+void point_output::flush_netcdf()
+{
+    auto& nc = _nc->get_ncfile();
+
+    size_t nrows = _times.size();
+    size_t npoints = _points.size();
+    size_t nvar = _variables.size();
+
+    std::vector<size_t> start = {_written, 0};
+    std::vector<size_t> count = {nrows, npoints};
+
+    const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    std::vector<long long> seconds(nrows);
+    for (size_t r = 0; r < nrows; r++)
+        seconds[r] = (_times[r] - epoch).total_seconds();
+
+    nc.getVar("time").putVar({_written}, {nrows}, seconds.data());
+
+    if (npoints == 0)
+        return;
+
+    std::vector<float> buffer(nrows * npoints);
+    for (size_t j = 0; j < nvar; j++)
+    {
+        for (size_t i = 0; i < nrows * npoints; i++)
+            buffer[i] = _values[i * nvar + j];
+
+        nc.getVar(_variables[j]).putVar(start, count, buffer.data());
+    }
+
+    nc.sync();
+}
+
+bool point_output::uses_netcdf() const
+{
+    return _format == format::netcdf;
+}
+
+const std::vector<std::string>& point_output::variables() const
+{
+    return _variables;
+}
+
+size_t point_output::rows_written() const
+{
+    return _written;
+}
@@ -0,0 +1,121 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include "exception.hpp"
+#include "logger.hpp"
+#include "netcdf.hpp"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Streams point timeseries output to disk.
+ *
+ * Each timestep the values of every output point are appended as a row. Rows are buffered and written every
+ * flush_interval rows, so memory use no longer grows with the length of the run and the output up to the last
+ * flush survives if the run dies.
+ *
+ * Output is either one csv file per point, in the same format as timeseries::to_file, or a single NetCDF file
+ * holding all the points with an unlimited time dimension.
+ */
+class point_output
+{
+  public:
+    enum class format
+    {
+        csv,
+        netcdf
+    };
+
+    struct point
+    {
+        std::string name;
+        std::string file; // csv only
+        double longitude;
+        double latitude;
+    };
+
+    /// Creates the output files, truncating any that exist
+    /// @param fmt
+    /// @param points
+    /// @param variables Variables written for every point, in the order values are given to row()
+    /// @param nc_file NetCDF file to create when fmt is netcdf
+    /// @param flush_interval Number of rows to buffer before they are written
+    point_output(format fmt,
+                 std::vector<point> points,
+                 std::vector<std::string> variables,
+                 const std::string& nc_file,
+                 size_t flush_interval);
+
+    /// Flushes any buffered rows
+    ~point_output();
+
+    /// Starts a new row for time t
+    /// @param t
+    void begin_row(boost::posix_time::ptime t);
+
+    /// The current row's values for a point, in variables() order. Values default to -9999
+    /// @param point
+    /// @return
+    double* row(size_t point);
+
+    /// Finishes the current row
+    /// @return true if flush_interval rows are buffered and flush() should be called
+    bool end_row();
+
+    /// Writes all the buffered rows
+    void flush();
+
+    /// True if flush() calls into the NetCDF library
+    /// @return
+    bool uses_netcdf() const;
+
+    const std::vector<std::string>& variables() const;
+
+    /// Number of rows written to disk so far
+    /// @return
+    size_t rows_written() const;
+
+  private:
+    void flush_csv();
+    void flush_netcdf();
+
+    format _format;
+    std::vector<point> _points;
+    std::vector<std::string> _variables;
+    size_t _flush_interval;
+
+    // buffered rows. Values are [row][point][variable]
+    std::vector<boost::posix_time::ptime> _times;
+    std::vector<double> _values;
+
+    size_t _written;
+
+    std::unique_ptr<netcdf> _nc;
+};
@@ -24,6 +24,15 @@
 
 
 #include "timeseries.hpp"
+#include "utility/wyhash.h"
+
+#include <charconv>
+#include <cctype>
+#include <cstring>
+#include <string_view>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 void timeseries::push_back(double data, std::string variable)
 {
@@ -273,142 +282,385 @@ timeseries::iterator timeseries::find(boost::posix_time::ptime time)
     return step;
 }
 
-void timeseries::open(std::string path)
+namespace
 {
-    std::fstream file(path.c_str());
-    std::string line = "";
+    // delimiters between tokens, i.e., anything but whitespace or ,
+    inline bool is_delim(char c)
+    {
+        return c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
 
-    //tokenizer
-    regex_tokenizer token;
-    //contains the column headers
-    std::vector<std::string> header;
+    // splits a line into views of its tokens, reusing the storage of tokens
+    void tokenize(std::string_view line, std::vector<std::string_view>& tokens)
+    {
+        tokens.clear();
+
+        size_t i = 0;
+        while (i < line.size())
+        {
+            while (i < line.size() && is_delim(line[i]))
+                i++;
+
+            size_t start = i;
+            while (i < line.size() && !is_delim(line[i]))
+                i++;
+
+            if (i > start)
+                tokens.push_back(line.substr(start, i - start));
+        }
+    }
+
+    // the whole token must be a number. A leading + is allowed, but not inf or nan
+    bool parse_double(std::string_view token, double& value)
+    {
+        if (!token.empty() && token[0] == '+')
+            token.remove_prefix(1);
+
+        size_t first = (!token.empty() && token[0] == '-') ? 1 : 0;
+        if (token.size() <= first || !(std::isdigit(token[first]) || token[first] == '.'))
+            return false;
+
+        auto res = std::from_chars(token.data(), token.data() + token.size(), value);
+        return res.ec == std::errc() && res.ptr == token.data() + token.size();
+    }
+
+    // fixed width YYYYMMDDThhmmss
+    bool parse_iso_datetime(std::string_view token, boost::posix_time::ptime& time)
+    {
+        if (token.size() < 15 || token[8] != 'T')
+            return false;
+
+        int v = 0;
+        auto field = [&](size_t pos, size_t n) -> bool
+        {
+            v = 0;
+            for (size_t i = pos; i < pos + n; i++)
+            {
+                if (!std::isdigit(token[i]))
+                    return false;
+                v = v * 10 + (token[i] - '0');
+            }
+            return true;
+        };
+
+        int Y, M, D, h, m, sec;
+        if (!field(0, 4)) return false; Y = v;
+        if (!field(4, 2)) return false; M = v;
+        if (!field(6, 2)) return false; D = v;
+        if (!field(9, 2)) return false; h = v;
+        if (!field(11, 2)) return false; m = v;
+        if (!field(13, 2)) return false; sec = v;
+
+        time = boost::posix_time::ptime(boost::gregorian::date(Y, M, D), boost::posix_time::time_duration(h, m, sec));
+        return true;
+    }
+
+    const boost::posix_time::ptime cache_epoch(boost::gregorian::date(1970, 1, 1));
+
+    /*
+     * Binary cache of a parsed file. All fields are native endian, the file is
+     *  cache_header
+     *  variable names, each \0 terminated, padded to a multiple of 8 bytes
+     *  int64 seconds since the epoch for each row
+     *  double[rows] for each variable, in the order of the names
+     */
+    struct cache_header
+    {
+        char magic[8];
+        uint64_t byte_order;
+        uint64_t source_size;
+        int64_t source_mtime;
+        uint64_t source_hash;
+        uint64_t rows;
+        uint64_t cols; // columns in the source file, including the datetime
+        uint64_t lines; // lines in the source file after the header
+        uint64_t nvariables;
+        uint64_t names_bytes;
+    };
+
+    const char cache_magic[8] = {'C', 'H', 'M', 'T', 'S', 'C', '0', '1'};
+    const uint64_t cache_byte_order = 0x0102030405060708ULL;
+
+    uint64_t hash_source(const char* data, size_t size)
+    {
+        return wyhash(data, size, 2654435761U);
+    }
+}
+
+std::string timeseries::cache_path(const std::string& path)
+{
+    return path + ".chmcache";
+}
+
+bool timeseries::load_cache(const std::string& path)
+{
+    auto cache = cache_path(path);
+    if (!boost::filesystem::exists(cache))
+        return false;
+
+    try
+    {
+        boost::iostreams::mapped_file_source map(cache);
+        if (map.size() < sizeof(cache_header))
+            return false;
+
+        cache_header h;
+        std::memcpy(&h, map.data(), sizeof(cache_header));
+
+        if (std::memcmp(h.magic, cache_magic, sizeof(cache_magic)) != 0 || h.byte_order != cache_byte_order)
+            return false;
+
+        // cheap checks before hashing the source
+        if (h.source_size != boost::filesystem::file_size(path) ||
+            h.source_mtime != static_cast<int64_t>(boost::filesystem::last_write_time(path)))
+            return false;
+
+        size_t expected = sizeof(cache_header) + h.names_bytes + h.rows * sizeof(int64_t) +
+                          h.nvariables * h.rows * sizeof(double);
+        if (map.size() != expected)
+            return false;
+
+        if (h.source_size > 0)
+        {
+            boost::iostreams::mapped_file_source source(path);
+            if (hash_source(source.data(), source.size()) != h.source_hash)
+                return false;
+        }
+
+        const char* ptr = map.data() + sizeof(cache_header);
+
+        std::vector<std::string> names;
+        const char* names_end = ptr + h.names_bytes;
+        for (uint64_t i = 0; i < h.nvariables; i++)
+        {
+            auto len = strnlen(ptr, names_end - ptr);
+            if (ptr + len == names_end)
+                return false;
+            names.emplace_back(ptr, len);
+            ptr += len + 1;
+        }
+        ptr = names_end;
+
+        std::vector<int64_t> seconds(h.rows);
+        std::memcpy(seconds.data(), ptr, h.rows * sizeof(int64_t));
+        ptr += h.rows * sizeof(int64_t);
+
+        _variables.clear();
+        _date_vec.resize(h.rows);
+        for (size_t i = 0; i < h.rows; i++)
+            _date_vec[i] = cache_epoch + boost::posix_time::seconds(seconds[i]);
+
+        for (auto& name : names)
+        {
+            auto& col = _variables[name];
+            col.resize(h.rows);
+            std::memcpy(col.data(), ptr, h.rows * sizeof(double));
+            ptr += h.rows * sizeof(double);
+        }
+
+        _cols = h.cols;
+        _rows = h.rows;
+        _timeseries_length = h.lines;
+    }
+    catch (std::exception& e)
+    {
+        SPDLOG_DEBUG("Unable to read forcing cache {}: {}", cache, e.what());
+        _variables.clear();
+        _date_vec.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void timeseries::write_cache(const std::string& path, uint64_t source_size, int64_t source_mtime, uint64_t source_hash)
+{
+    auto cache = cache_path(path);
+
+    std::vector<std::string> names;
+    for (auto& itr : _variables)
+        names.push_back(itr.first);
+
+    uint64_t names_bytes = 0;
+    for (auto& n : names)
+        names_bytes += n.size() + 1;
+    names_bytes = (names_bytes + 7) / 8 * 8;
+
+    cache_header h;
+    std::memcpy(h.magic, cache_magic, sizeof(cache_magic));
+    h.byte_order = cache_byte_order;
+    h.source_size = source_size;
+    h.source_mtime = source_mtime;
+    h.source_hash = source_hash;
+    h.rows = _date_vec.size();
+    h.cols = _cols;
+    h.lines = _timeseries_length;
+    h.nvariables = names.size();
+    h.names_bytes = names_bytes;
+
+    std::vector<int64_t> seconds(_date_vec.size());
+    for (size_t i = 0; i < _date_vec.size(); i++)
+        seconds[i] = (_date_vec[i] - cache_epoch).total_seconds();
+
+    // write to a unique file and rename it into place so that concurrent readers, e.g., other MPI ranks, never see a partial cache
+    auto tmp = boost::filesystem::path(cache).parent_path() /
+               boost::filesystem::unique_path(boost::filesystem::path(cache).filename().string() + ".%%%%-%%%%");
+
+    std::ofstream out(tmp.string(), std::ios::binary);
+    if (!out.is_open())
+    {
+        SPDLOG_DEBUG("Unable to write forcing cache {}", cache);
+        return;
+    }
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    std::vector<char> name_block(names_bytes, '\0');
+    size_t pos = 0;
+    for (auto& n : names)
+    {
+        std::memcpy(name_block.data() + pos, n.c_str(), n.size());
+        pos += n.size() + 1;
+    }
+    out.write(name_block.data(), name_block.size());
+    out.write(reinterpret_cast<const char*>(seconds.data()), seconds.size() * sizeof(int64_t));
+
+    for (auto& n : names)
+    {
+        auto& col = _variables[n];
+        out.write(reinterpret_cast<const char*>(col.data()), col.size() * sizeof(double));
+    }
+    out.close();
+
+    boost::system::error_code ec;
+    if (!out)
+        boost::filesystem::remove(tmp, ec);
+    else
+        boost::filesystem::rename(tmp, cache, ec);
+
+    if (ec || !out)
+    {
+        SPDLOG_DEBUG("Unable to write forcing cache {}", cache);
+        boost::filesystem::remove(tmp, ec);
+    }
+}
+
+void timeseries::open(std::string path, bool use_cache)
+{
+    if (use_cache && load_cache(path))
+    {
+        SPDLOG_DEBUG("Loaded {} from cache", path);
+        _isOpen = true;
+        _file = path;
+        return;
+    }
+
+    std::ifstream file(path.c_str(), std::ios::binary);
 
     if (!file.is_open())
     {
-//        std::stringstream ss;
-//        ss << "" << boost::errinfo_errno(errno) << boost::errinfo_file_name(path);
         CHM_THROW_EXCEPTION(file_read_error, boost::to_string(boost::errinfo_errno(errno)));
     };
 
     SPDLOG_DEBUG("Parsing file {}", path);
-    bool done = false;
-    token.set_regex("[^,\\r\\n\\s]+"); //anything but whitespace or ,
-    //read in the file, skip any blank lines at the top of the file
-    while (!done)
-    {
-        getline(file, line);
-        header = token.tokenize<std::string>(line);
 
-        //skip any line that is a blank, or that has text in it
-        if (header.size() != 0)
-            done = true;
+    // the whole file is read at once and then tokenized in place
+    std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string_view text(buffer);
 
-    }
+    size_t pos = 0;
+    auto next_line = [&](std::string_view& line) -> bool
+    {
+        if (pos >= text.size())
+            return false;
 
-    //take that the number of headers is how many columns there should be
-    _cols = header.size();
+        auto end = text.find('\n', pos);
+        if (end == std::string_view::npos)
+            end = text.size();
 
-//    for (std::vector<std::string>::const_iterator itr = header.begin();
-//            itr != header.end();
-//            itr++)
-//    {
-//        if (!_variables.insert(*itr))
-//        {
-//            BOOST_THROW_EXCEPTION(forcing_insertion_error()
-//                    << errstr_info(std::string("Failed to insert ") + *itr)
-//                    << boost::errinfo_file_name(path)
-//                    );
-//
-//        }
-//    }
+        line = text.substr(pos, end - pos);
+        pos = end + 1;
+        return true;
+    };
+
+    std::string_view line;
+    std::vector<std::string_view> tokens;
 
+    //read in the file, skip any blank lines at the top of the file
+    while (tokens.empty())
+    {
+        if (!next_line(line))
+        {
+            CHM_THROW_EXCEPTION(forcing_error, "No header found. " + path);
+        }
+        tokenize(line, tokens);
+    }
 
+    //contains the column headers
+    std::vector<std::string> header(tokens.begin(), tokens.end());
 
-    //a string defined as anything with a letter in it or that has a special character in this list
-    //~`!@#$%^&*(){[}]|\:;"'<>.?/
-    regex_tokenizer floating("^[-+]?(?:[0-9]+\\.?(?:[0-9]*)?|\\.[0-9]+)(?:[eE][-+]?[0-9]+)?$");
-    regex_tokenizer dateTime("[0-9]{8}T[0-9]{6}"); //iso standard time
+    //take that the number of headers is how many columns there should be
+    _cols = header.size();
 
-    std::vector<std::string> values; //values on a line
+    // reserve for the remaining lines
+    size_t expected_rows = std::count(text.begin() + std::min(pos, text.size()), text.end(), '\n') + 1;
 
+    std::vector<variable_vec> columns(_cols);
+    for (auto& c : columns)
+        c.reserve(expected_rows);
+    _date_vec.reserve(expected_rows);
 
-    token.set_regex("[^,\\r\\n\\s]+"); //anything but whitespace or ,
+    // the datetime column is removed from the variables
+    std::vector<bool> is_date(_cols, false);
 
     int lines = 0;
 
-    //this is used to save the name of the date header so we can find it to check the timestep later
-    std::string dateHeader = "";
-
-    while (getline(file, line))
+    while (next_line(line))
     {
         lines++;
-        
 
-        values = token.tokenize<std::string>(line);
+        tokenize(line, tokens);
 
         //make sure it isn't a blank line
-        if (values.size() != 0)
+        if (tokens.empty())
+            continue;
+
+        if (tokens.size() != _cols)
         {
-            //get the col name
-            std::vector<std::string>::const_iterator headerItr = header.begin();
-
-            //how many cols, make sure that equals the number of headers read in.
-            size_t cols_so_far = 0;
-            //for each column
-            for (std::vector<std::string>::const_iterator itr = values.begin();
-                    itr != values.end();
-                    itr++)
-            {
-                std::vector<std::string> doubles;
-                std::vector<std::string> dates;
-
-                if ((doubles = floating.tokenize<std::string>(*itr)).size() == 1)
-                {
-//                    auto res = _variables.find(*headerItr);
-//                    if (res == _variables.end())
-//                        BOOST_THROW_EXCEPTION(forcing_lookup_error()
-//                            << errstr_info(std::string("Failed to find ") + *headerItr)
-//                            << boost::errinfo_file_name(path)
-//                            );
-                    try
-                    {
-                        //LOG_VERBOSE << "Found " << *headerItr << ": " << doubles[0];
-                        _variables[*headerItr].push_back(boost::lexical_cast<double>(doubles[0]));
-                    } catch (...)
-                    {
-                        CHM_THROW_EXCEPTION(forcing_badcast, "Failed to cast " + doubles[0] + " to a double. " + path);
-                    }
-                } else if ((dates = dateTime.tokenize<std::string>(*itr)).size() == 1)
-                {
-
-                    //LOG_VERBOSE << "Found " << *headerItr << ": " << dates[0];
-                    _date_vec.push_back(boost::posix_time::from_iso_string(dates[0])); //from_iso_string
-                    
-                    //now we know where the date colum is, we remove it from the hashmap if we haven't already
-                    _variables.erase(*headerItr);
-                  
-                }
-                else
-                {
-                    //something has gone horribly wrong
-                    CHM_THROW_EXCEPTION(forcing_no_regexmatch,"Unable to match any regex for " + *itr + ". Line: " + std::to_string(lines) + path);
-
-                }
-
-                //next header
-                headerItr++;
-                cols_so_far++;
+            CHM_THROW_EXCEPTION(forcing_badcast,"Expected " + std::to_string(_cols) + " columns on line " + std::to_string(_rows) + path);
+        }
+
+        for (size_t j = 0; j < tokens.size(); j++)
+        {
+            double value;
+            boost::posix_time::ptime time;
 
+            if (parse_double(tokens[j], value))
+            {
+                columns[j].push_back(value);
+            }
+            else if (parse_iso_datetime(tokens[j], time))
+            {
+                _date_vec.push_back(time);
+                is_date[j] = true;
             }
-            if (cols_so_far != _cols)
+            else
             {
-                CHM_THROW_EXCEPTION(forcing_badcast,"Expected " + std::to_string(_cols) + " columns on line " + std::to_string(_rows) + path);
+                //something has gone horribly wrong
+                CHM_THROW_EXCEPTION(forcing_no_regexmatch,"Unable to parse " + std::string(tokens[j]) + ". Line: " + std::to_string(lines) + path);
             }
-            _rows++;
         }
 
+        _rows++;
+
     } //end of file read
 
+    for (size_t j = 0; j < _cols; j++)
+    {
+        if (!is_date[j])
+            _variables[header[j]] = std::move(columns[j]);
+    }
+
     _isOpen = true;
     _file = path;
     _timeseries_length = lines;
@@ -480,6 +732,11 @@ void timeseries::open(std::string path)
             }
         }
     }
+
+    if (use_cache)
+    {
+        write_cache(path, buffer.size(), boost::filesystem::last_write_time(path), hash_source(buffer.data(), buffer.size()));
+    }
 }
 
 int timeseries::get_timeseries_length()
@@ -748,4 +1005,4 @@ void timeseries::iterator::advance(timeseries::iterator::difference_type N)
 {
     for (int i = 0;i<N;i++)
         this->increment();
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -187,9 +187,13 @@ public:
     Time:
         - Must be in one column in the following ISO 8601 date time form:
         - YYYYMMDDThhmmss   e.g., 20080131T235959
+    If use_cache is set, the parsed file is saved to a binary sidecar file (path + ".chmcache") keyed by the
+    source's size, modification time, and a hash of its contents. Later opens of an unchanged file load from the cache
+    instead of parsing. Failing to write the cache is not an error.
     \param path Fully qualified path
+    \param use_cache Load from, and save to, the binary cache
     */
-    void open(std::string path);
+    void open(std::string path, bool use_cache = false);
 
     /**
     *  Writes the timeseries to file. Order of variable output not deterministic.
@@ -266,6 +270,11 @@ private:
     //pushes variables back, only useful for reading from a file
     void push_back(double data, std::string variable);
 
+    // binary cache of a parsed file, see open
+    static std::string cache_path(const std::string& path);
+    bool load_cache(const std::string& path);
+    void write_cache(const std::string& path, uint64_t source_size, int64_t source_mtime, uint64_t source_hash);
+
 
 };
 
@@ -303,4 +312,4 @@ private:
  };
 
 
-    
\ No newline at end of file
+    
\ No newline at end of file
@@ -0,0 +1,150 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "async_writer.hpp"
+#include "timer.hpp"
+
+async_writer::async_writer()
+{
+    _depth = 0;
+    _busy = false;
+    _stop = false;
+    _error = nullptr;
+    _stall = 0;
+}
+
+async_writer::~async_writer()
+{
+    if(_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        _thread.join(); // the worker drains the queue before it exits
+    }
+}
+
+void async_writer::set_depth(size_t depth)
+{
+    flush();
+    _depth = depth;
+
+    if(_depth > 0 && !_thread.joinable())
+        _thread = std::thread(&async_writer::worker, this);
+}
+
+size_t async_writer::depth() const
+{
+    return _depth;
+}
+
+void async_writer::submit(std::function<void()> job)
+{
+    if(_depth == 0)
+    {
+        job();
+        return;
+    }
+
+    timer c;
+    c.tic();
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this] { return _queue.size() < _depth || _error; });
+
+        _stall += c.toc<ms>();
+
+        rethrow();
+
+        _queue.push_back(std::move(job));
+    }
+    _cv.notify_all();
+}
+
+void async_writer::flush()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return (_queue.empty() && !_busy) || _error; });
+
+    rethrow();
+}
+
+double async_writer::stall_time() const
+{
+    return _stall / 1000.0;
+}
+
+void async_writer::rethrow()
+{
+    // called with the lock held
+    if(_error)
+    {
+        auto e = _error;
+        _error = nullptr;
+        _queue.clear();
+        std::rethrow_exception(e);
+    }
+}
+
+void async_writer::worker()
+{
+    while(true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this] { return _stop || !_queue.empty(); });
+
+            if(_queue.empty()) // only once stopped and drained
+                return;
+
+            job = std::move(_queue.front());
+            _queue.pop_front();
+            _busy = true;
+        }
+        _cv.notify_all();
+
+        // the write is done without holding the lock so that the next snapshot can be queued in the meantime
+        std::exception_ptr error = nullptr;
+        try
+        {
+            job();
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _busy = false;
+            if(error)
+                _error = error;
+        }
+        _cv.notify_all();
+    }
+}
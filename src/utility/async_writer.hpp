@@ -0,0 +1,81 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * Runs output writes on a background thread so that slow I/O is off the timestep loop.
+ *
+ * The caller snapshots whatever it needs to write and submits a job that writes the snapshot. Jobs run in
+ * submission order. At most depth() jobs wait in the queue; submit() blocks until there is room, which bounds the
+ * memory held by snapshots. A depth of 0 runs each job inline in submit().
+ *
+ * An exception thrown by a job is rethrown from the next call to submit() or flush().
+ */
+class async_writer
+{
+  public:
+    async_writer();
+    ~async_writer();
+
+    /// Sets the maximum number of queued jobs. Flushes any queued jobs first.
+    /// @param depth 0 runs jobs synchronously
+    void set_depth(size_t depth);
+
+    /// Maximum number of queued jobs
+    /// @return
+    size_t depth() const;
+
+    /// Queues a job, blocking while the queue is full
+    /// @param job
+    void submit(std::function<void()> job);
+
+    /// Blocks until every queued job has finished
+    void flush();
+
+    /// Total time, in seconds, that submit() has spent waiting for room in the queue
+    /// @return
+    double stall_time() const;
+
+  private:
+    void worker();
+    void rethrow();
+
+    size_t _depth;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cv; // signals a job was queued or finished, or a stop request
+    std::deque<std::function<void()>> _queue;
+    bool _busy; // the worker is running a job
+    bool _stop;
+    std::exception_ptr _error;
+    double _stall; // ms
+};
@@ -0,0 +1,137 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "face_scheduler.hpp"
+
+#include <numeric>
+
+face_scheduler::face_scheduler()
+{
+    _nfaces = 0;
+    _nblocks = 0;
+    _imbalance = 0;
+    _sum_imbalance = 0;
+    _runs = 0;
+    _block_start.assign(1, 0);
+}
+
+void face_scheduler::init(size_t nfaces, size_t blocks_per_thread)
+{
+    size_t nthreads = omp_get_max_threads();
+
+    _nfaces = nfaces;
+    _nblocks = std::max<size_t>(1, std::min(nfaces, nthreads * blocks_per_thread));
+
+    _cost.assign(nfaces, 1.);
+    _thread_time.assign(nthreads, 0.);
+
+    _imbalance = 0;
+    _sum_imbalance = 0;
+    _runs = 0;
+
+    partition();
+}
+
+void face_scheduler::partition()
+{
+    _block_start.clear();
+    _block_start.push_back(0);
+
+    if (_nfaces == 0)
+    {
+        _block_time.clear();
+        return;
+    }
+
+    double total = std::accumulate(_cost.begin(), _cost.end(), 0.);
+    double target = total / _nblocks;
+
+    // walk the faces, closing a block each time its cost reaches the target. Keep enough faces in reserve that
+    // every remaining block gets at least one
+    double sum = 0;
+    for (size_t i = 0; i < _nfaces && _block_start.size() < _nblocks; i++)
+    {
+        sum += _cost[i];
+
+        size_t remaining_faces = _nfaces - (i + 1);
+        size_t remaining_blocks = _nblocks - _block_start.size();
+
+        if ((sum >= target * _block_start.size() && remaining_faces >= remaining_blocks) ||
+            remaining_faces == remaining_blocks)
+        {
+            _block_start.push_back(i + 1);
+        }
+    }
+    _block_start.push_back(_nfaces);
+
+    _block_time.assign(_block_start.size() - 1, 0.);
+}
+
+void face_scheduler::update()
+{
+    size_t nblocks = _block_start.size() - 1;
+
+    // smooth the estimate so one noisy timestep doesn't move everything around. The initial uniform cost is not a
+    // time, so the first run replaces it entirely
+    const double alpha = _runs == 0 ? 1. : 0.5;
+
+    #pragma omp parallel for
+    for (size_t b = 0; b < nblocks; b++)
+    {
+        size_t n = _block_start[b + 1] - _block_start[b];
+        double c = _block_time[b] / n;
+
+        for (size_t i = _block_start[b]; i < _block_start[b + 1]; i++)
+            _cost[i] = alpha * c + (1. - alpha) * _cost[i];
+    }
+
+    double max_time = *std::max_element(_thread_time.begin(), _thread_time.end());
+    double mean_time = std::accumulate(_thread_time.begin(), _thread_time.end(), 0.) / _thread_time.size();
+
+    _imbalance = mean_time > 0 ? max_time / mean_time - 1. : 0.;
+    _sum_imbalance += _imbalance;
+    _runs++;
+
+    partition();
+}
+
+size_t face_scheduler::size() const
+{
+    return _nfaces;
+}
+
+double face_scheduler::imbalance() const
+{
+    return _imbalance;
+}
+
+double face_scheduler::mean_imbalance() const
+{
+    return _runs > 0 ? _sum_imbalance / _runs : 0.;
+}
+
+const std::vector<size_t>& face_scheduler::blocks() const
+{
+    return _block_start;
+}
@@ -0,0 +1,125 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <omp.h>
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Cost-aware scheduling of a loop over the mesh faces.
+ *
+ * Per-face cost varies a lot, e.g., snowpack models only do real work on snow covered faces, so a static split of
+ * the faces leaves threads idle. Here the faces are split into contiguous blocks, so neighbouring faces stay together,
+ * that each have roughly the same estimated cost. Threads take blocks dynamically. The time each block takes
+ * is spread evenly over its faces to update a per-face cost estimate, and the blocks are re-partitioned after every
+ * run. Blocks become smaller where the expensive faces are, and the partition follows changes such as snow cover.
+ */
+class face_scheduler
+{
+  public:
+    face_scheduler();
+
+    /// Reset the scheduler for a loop over nfaces faces. Costs start uniform.
+    /// @param nfaces
+    /// @param blocks_per_thread Number of blocks per thread to leave room for dynamic balancing
+    void init(size_t nfaces, size_t blocks_per_thread = 8);
+
+    /// Run fn(i) for every face index in [0, size()). Must be called from outside a parallel region.
+    /// @param fn
+    template<typename F>
+    void run(F&& fn);
+
+    /// Number of faces being scheduled
+    /// @return
+    size_t size() const;
+
+    /// Load imbalance of the last run: the busiest thread's time over the mean thread time, less 1.
+    /// 0 is perfectly balanced.
+    /// @return
+    double imbalance() const;
+
+    /// Mean load imbalance over all the runs so far
+    /// @return
+    double mean_imbalance() const;
+
+    /// Start of each block, with the end of the last block appended
+    /// @return
+    const std::vector<size_t>& blocks() const;
+
+  private:
+
+    // update the face costs from the block times and re-partition
+    void update();
+
+    // split the faces into _nblocks blocks of roughly equal cost
+    void partition();
+
+    size_t _nfaces;
+    size_t _nblocks;
+
+    // per-face cost estimate [s]
+    std::vector<double> _cost;
+
+    // _block_start[b] to _block_start[b+1] is block b
+    std::vector<size_t> _block_start;
+    std::vector<double> _block_time;
+
+    // per-thread busy time during the last run
+    std::vector<double> _thread_time;
+
+    double _imbalance;
+    double _sum_imbalance;
+    size_t _runs;
+};
+
+template<typename F>
+void face_scheduler::run(F&& fn)
+{
+    size_t nblocks = _block_start.size() - 1;
+    std::fill(_thread_time.begin(), _thread_time.end(), 0.);
+
+    #pragma omp parallel
+    {
+        size_t tid = omp_get_thread_num();
+
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t b = 0; b < nblocks; b++)
+        {
+            double start = omp_get_wtime();
+
+            for (size_t i = _block_start[b]; i < _block_start[b + 1]; i++)
+                fn(i);
+
+            double t = omp_get_wtime() - start;
+            _block_time[b] = t;
+
+            if (tid < _thread_time.size())
+                _thread_time[tid] += t;
+        }
+    }
+
+    update();
+}